@@ -0,0 +1,237 @@
+/**
+ * @file AStarSolver.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for an A* maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "AStarSolver.h"
+#include <algorithm>
+#include <limits.h>
+#include <stdlib.h>
+
+/**
+ * @brief Heap ordering for the open list: lowest `f` first, and among
+ * equal `f` the deepest entry, which keeps the search heading for the
+ * goal instead of fanning out across ties.
+ */
+static bool astar_later(const astar_entry &a, const astar_entry &b)
+{
+    if (a.f != b.f)
+        return a.f > b.f;
+
+    return a.g < b.g;
+}
+
+
+/**
+ * @brief Initializes the solver.
+ */
+AStarSolver::AStarSolver()
+{
+    width = 0;
+    height = 0;
+}
+
+
+/**
+ * @brief Deinitializes the solver.
+ */
+AStarSolver::~AStarSolver()
+{
+
+}
+
+
+/**
+ * @brief Solves the maze given by `maze` from the top-left to the
+ * bottom-right corner.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be
+ * solved.
+ */
+void AStarSolver::solve(MazeGrid *maze)
+{
+    solve(maze, 0, 0, maze->get_width() - 1, maze->get_height() - 1);
+}
+
+
+/**
+ * @brief Finds a shortest path between two cells.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be solved.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return True if the goal is reachable; false also if the maze has
+ * too many cells to index or either cell is off the maze.
+ */
+bool AStarSolver::solve(MazeGrid *maze, int sx, int sy, int gx, int gy)
+{
+    double start_time = wall_seconds();
+
+    if (!indexable(maze) || !contains(maze, sx, sy) ||
+        !contains(maze, gx, gy))
+    {
+        path.clear();
+        nodes_expanded = 0;
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    width = maze->get_width();
+    height = maze->get_height();
+
+    size_t cells = (size_t) width * height;
+
+    cost.assign(cells, UINT_MAX);
+    closed.assign((cells + 31) / 32, 0);
+    if (entered.size() < cells)
+        entered.resize(cells);
+    open.clear();
+    path.clear();
+    nodes_expanded = 0;
+
+    long step[W + 1];
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    static const int dirs[] = {N, S, E, W};
+    unsigned int start = (unsigned int) sy * width + sx;
+    unsigned int goal = (unsigned int) gy * width + gx;
+    bool found = false;
+
+    astar_entry first;
+    first.g = 0;
+    first.f = abs(gx - sx) + abs(gy - sy);
+    first.cell = start;
+    cost[start] = 0;
+    open.push_back(first);
+
+    while (!open.empty())
+    {
+        astar_entry cur = open.front();
+        pop_heap(open.begin(), open.end(), astar_later);
+        open.pop_back();
+
+        if (closed[cur.cell >> 5] & (1u << (cur.cell & 31)) ||
+            cur.g != cost[cur.cell])
+            continue;
+
+        closed[cur.cell >> 5] |= 1u << (cur.cell & 31);
+        nodes_expanded++;
+
+        if (cur.cell == goal)
+        {
+            found = true;
+            break;
+        }
+
+        int x = cur.cell % width, y = cur.cell / width;
+        int moves = maze->get_possible_moves(x, y);
+
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(moves & dirs[d]))
+                continue;
+
+            unsigned int next = cur.cell + step[dirs[d]];
+
+            if (cur.g + 1 >= cost[next])
+                continue;
+
+            int nx = next % width, ny = next / width;
+            astar_entry e;
+            e.g = cur.g + 1;
+            e.f = e.g + abs(gx - nx) + abs(gy - ny);
+            e.cell = next;
+
+            cost[next] = e.g;
+            entered[next] = dirs[d];
+            open.push_back(e);
+            push_heap(open.begin(), open.end(), astar_later);
+        }
+    }
+
+    if (found)
+    {
+        /* Walk back from the goal against the recorded directions. */
+        for (unsigned int cur = goal; ; cur -= step[entered[cur]])
+        {
+            path.push_back(cur);
+
+            if (cur == start)
+                break;
+        }
+    }
+
+    solve_time = wall_seconds() - start_time;
+    return found;
+}
+
+
+/**
+ * @brief Retrieves the path found by the last solve, from the goal
+ * back to the start.
+ *
+ * @return Vector storing the path through the maze.
+ */
+vector<coordinate> AStarSolver::get_path()
+{
+    vector<coordinate> list;
+
+    list.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        coordinate c;
+        c.x = path[i] % width;
+        c.y = path[i] / width;
+
+        list.push_back(c);
+    }
+
+    return list;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file AStarSolver.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Definitions for an A* maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __ASTARSOLVER_H__
+#define __ASTARSOLVER_H__
+
+#include "MazeSolverBase.h"
+#include <stdio.h>
+#include <vector>
+
+/**
+ * @brief Entry on the A* open list. Entries are never updated in
+ * place; a stale entry is skipped when its `g` no longer matches the
+ * cell's best known cost.
+ */
+struct astar_entry
+{
+    unsigned int f;
+    unsigned int g;
+    unsigned int cell;
+};
+
+/**
+ * @brief Encapsulates an A* maze solver using the Manhattan distance
+ * to the goal as its heuristic. Works on flat per-cell arrays like
+ * FlatBreadthFirstSolver, and needs no display.
+ */
+class AStarSolver : public MazeSolverBase
+{
+public:
+    AStarSolver();
+    virtual ~AStarSolver();
+
+    void solve(MazeGrid *maze);
+    bool solve(MazeGrid *maze, int sx, int sy, int gx, int gy);
+    vector<coordinate> get_path();
+    size_t get_path_length() { return path.size(); };
+
+private:
+    int width, height;
+    vector<astar_entry> open;
+    vector<unsigned int> cost;
+    vector<unsigned int> closed;
+    vector<unsigned char> entered;
+    vector<unsigned int> path;
+};
+
+#endif
@@ -0,0 +1,338 @@
+/**
+ * @file BatchSolver.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Batch maze solver on a work-stealing pool.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+
+#include "BatchSolver.h"
+#include "FlatBreadthFirstSolver.h"
+#include "AStarSolver.h"
+#include "BidirectionalSolver.h"
+
+/**
+ * @brief Initializes the batch solver and starts its worker pool.
+ *
+ * @param[in] nthreads Number of worker threads to start; the calling
+ * thread also works, and 0 runs every job on it alone.
+ * @param[in] kind Solver each thread runs.
+ */
+BatchSolver::BatchSolver(int nthreads, batch_solver_kind kind)
+{
+    jobs = NULL;
+
+    this->nthreads = nthreads;
+    stopping = false;
+    workers = new Thread[nthreads];
+    scratch = new batch_worker[nthreads + 1];
+
+    for (int i = 0; i <= nthreads; i++)
+    {
+        scratch[i].batch = this;
+        scratch[i].id = i;
+        scratch[i].next = 0;
+        scratch[i].end = 0;
+        scratch[i].generator = new RecursiveBacktracker();
+        scratch[i].solved = 0;
+        scratch[i].steals = 0;
+
+        switch (kind)
+        {
+            case BATCH_ASTAR:
+                scratch[i].solver = new AStarSolver();
+                break;
+
+            case BATCH_BIDIRECTIONAL:
+                scratch[i].solver = new BidirectionalSolver();
+                break;
+
+            default:
+                scratch[i].solver = new FlatBreadthFirstSolver();
+                break;
+        }
+    }
+
+    for (int i = 0; i < nthreads; i++)
+        workers[i].run(batch_solver_worker, (void *) &scratch[i + 1]);
+}
+
+
+/**
+ * @brief Stops the worker pool and frees the per-thread solvers.
+ */
+BatchSolver::~BatchSolver()
+{
+    stopping = true;
+
+    for (int i = 0; i < nthreads; i++)
+        start.inc();
+
+    for (int i = 0; i < nthreads; i++)
+        workers[i].join();
+
+    for (int i = 0; i <= nthreads; i++)
+    {
+        delete scratch[i].generator;
+        delete scratch[i].solver;
+    }
+
+    delete[] workers;
+    delete[] scratch;
+}
+
+
+/**
+ * @brief Runs every job of a batch and returns once all are done.
+ *
+ * @param[in,out] jobs The batch; each job's result fields are set.
+ */
+void BatchSolver::run(vector<batch_job> &jobs)
+{
+    size_t count = jobs.size(), share = count / (nthreads + 1);
+    size_t extra = count % (nthreads + 1), first = 0;
+
+    this->jobs = &jobs;
+
+    /* Contiguous ranges, the first `extra` one job longer. */
+    for (int i = 0; i <= nthreads; i++)
+    {
+        size_t n = share + ((size_t) i < extra ? 1 : 0);
+
+        scratch[i].next = first;
+        scratch[i].end = first + n;
+        first += n;
+    }
+
+    __sync_synchronize();
+
+    for (int i = 0; i < nthreads; i++)
+        start.inc();
+
+    WorkJobs(&scratch[0]);
+
+    for (int i = 0; i < nthreads; i++)
+        done.dec();
+
+    this->jobs = NULL;
+}
+
+
+/**
+ * @brief Returns how many times a thread stole jobs from another one,
+ * over the life of the pool.
+ */
+unsigned long BatchSolver::get_steals()
+{
+    unsigned long steals = 0;
+
+    for (int i = 0; i <= nthreads; i++)
+        steals += scratch[i].steals;
+
+    return steals;
+}
+
+
+/**
+ * @brief Runs jobs, stealing when out of them, until no thread has
+ * any left.
+ *
+ * @param[in] self The calling thread's scratch state.
+ */
+void BatchSolver::WorkJobs(batch_worker *self)
+{
+    size_t job;
+
+    while (TakeJob(self, job))
+    {
+        RunJob(self, (*jobs)[job]);
+        self->solved++;
+    }
+}
+
+
+/**
+ * @brief Takes the next job of the thread's own range, refilling the
+ * range by stealing when it is empty.
+ *
+ * @param[in] self The calling thread's scratch state.
+ * @param[out] job Index of the job to run.
+ *
+ * @return False once no thread has any jobs left.
+ */
+bool BatchSolver::TakeJob(batch_worker *self, size_t &job)
+{
+    do
+    {
+        self->lock.lock();
+
+        if (self->next < self->end)
+        {
+            job = self->next++;
+            self->lock.unlock();
+            return true;
+        }
+
+        self->lock.unlock();
+    }
+    while (StealJobs(self));
+
+    return false;
+}
+
+
+/**
+ * @brief Moves the back half of the fullest other range into this
+ * thread's (empty) range. Only one lock is held at a time, so
+ * threads stealing from each other cannot deadlock; jobs in transit
+ * belong to the thief, which will run them.
+ *
+ * @param[in] self The calling thread's scratch state.
+ *
+ * @return False if every other range was empty.
+ */
+bool BatchSolver::StealJobs(batch_worker *self)
+{
+    while (true)
+    {
+        batch_worker *victim = NULL;
+        size_t most = 0;
+
+        /* Unlocked peek; the steal itself rechecks under the lock. */
+        for (int i = 0; i <= nthreads; i++)
+        {
+            batch_worker *other = &scratch[(self->id + i) % (nthreads + 1)];
+            size_t left = *(volatile size_t *) &other->end -
+                *(volatile size_t *) &other->next;
+
+            if (other != self && left <= jobs->size() && left > most)
+            {
+                victim = other;
+                most = left;
+            }
+        }
+
+        if (victim == NULL)
+            return false;
+
+        size_t first, last;
+
+        victim->lock.lock();
+        last = victim->end;
+        first = victim->end - (victim->end - victim->next) / 2;
+        if (victim->next < victim->end && first == last)
+            first--;
+        victim->end = first;
+        victim->lock.unlock();
+
+        if (first == last)
+            continue;
+
+        self->lock.lock();
+        self->next = first;
+        self->end = last;
+        self->lock.unlock();
+
+        self->steals++;
+        return true;
+    }
+}
+
+
+/**
+ * @brief Generates a job's maze and solves it, both in the thread's
+ * own scratch.
+ *
+ * @param[in] self The calling thread's scratch state.
+ * @param[in,out] job The job to run.
+ */
+void BatchSolver::RunJob(batch_worker *self, batch_job &job)
+{
+    job.length = -1;
+    job.expanded = 0;
+    job.seconds = 0;
+
+    if (job.width <= 0 || job.height <= 0 ||
+        (size_t) job.width * job.height > BATCH_MAX_CELLS ||
+        job.sx < 0 || job.sx >= job.width || job.sy < 0 ||
+        job.sy >= job.height || job.gx < 0 || job.gx >= job.width ||
+        job.gy < 0 || job.gy >= job.height)
+        return;
+
+    self->generator->create_maze(job.seed, job.width, job.height);
+
+    MazeGrid *maze = self->generator->get_maze();
+    MazeSolverBase *solver = self->solver;
+
+    if (solver->solve(maze, job.sx, job.sy, job.gx, job.gy))
+        job.length = solver->get_path_length();
+    else
+        job.length = 0;
+
+    job.expanded = solver->get_nodes_expanded();
+    job.seconds = solver->get_solve_time();
+}
+
+
+/**
+ * @brief Worker thread body: runs batches until the pool is
+ * destroyed.
+ *
+ * @param arg The thread's `batch_worker` scratch state.
+ */
+void *batch_solver_worker(void *arg)
+{
+    batch_worker *self = (batch_worker *) arg;
+    BatchSolver *batch = self->batch;
+
+    while (true)
+    {
+        batch->start.dec();
+
+        if (batch->stopping)
+            break;
+
+        batch->WorkJobs(self);
+        batch->done.inc();
+    }
+
+    return NULL;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file BatchSolver.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Batch maze solver on a work-stealing pool.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+
+#ifndef __BATCHSOLVER_H__
+#define __BATCHSOLVER_H__
+
+#include "MazeSolverBase.h"
+#include "RecursiveBacktracker.h"
+#include "Thread.h"
+#include <stdio.h>
+#include <vector>
+
+/* Jobs whose maze has more cells than this are rejected. */
+#define BATCH_MAX_CELLS     (1 << 26)
+
+/**
+ * @brief Solvers a batch can run. All of them take arbitrary
+ * endpoints and keep their buffers between solves.
+ */
+enum batch_solver_kind
+{
+    BATCH_FLAT_BFS,
+    BATCH_ASTAR,
+    BATCH_BIDIRECTIONAL
+};
+
+/**
+ * @brief One request of a batch: the maze to generate and the cells to
+ * connect, plus the result, which `BatchSolver::run` fills in.
+ */
+struct batch_job
+{
+    unsigned int seed;
+    int width, height;
+    int sx, sy, gx, gy;
+
+    /* Cells on the path; 0 if unreachable, -1 if the job is invalid. */
+    long length;
+    unsigned long expanded;
+    double seconds;
+};
+
+class BatchSolver;
+
+/**
+ * @brief Per-thread state. Each thread owns a generator and a solver
+ * that it reuses for every job it runs, so their buffers act as a
+ * scratch arena: after the largest maze a thread has seen, it solves
+ * without touching the allocator. `next` and `end` bound the thread's
+ * remaining jobs and are guarded by `lock`.
+ */
+struct batch_worker
+{
+    BatchSolver *batch;
+    int id;
+    Mutex lock;
+    size_t next, end;
+    RecursiveBacktracker *generator;
+    MazeSolverBase *solver;
+    unsigned long solved, steals;
+};
+
+/**
+ * @brief Generates and solves batches of mazes on a pool of threads.
+ * A batch is split into one contiguous range of jobs per thread; a
+ * thread runs its range front to back and, once it is empty, steals
+ * the back half of the fullest range it can find. Needs no display.
+ */
+class BatchSolver
+{
+public:
+    BatchSolver(int nthreads, batch_solver_kind kind);
+    ~BatchSolver();
+
+    void run(vector<batch_job> &jobs);
+    unsigned long get_steals();
+
+private:
+    friend void *batch_solver_worker(void *arg);
+
+    vector<batch_job> *jobs;
+
+    /* Worker pool. */
+    int nthreads;
+    bool stopping;
+    Thread *workers;
+    batch_worker *scratch;
+    Semaphore start, done;
+
+    void WorkJobs(batch_worker *self);
+    bool TakeJob(batch_worker *self, size_t &job);
+    bool StealJobs(batch_worker *self);
+    void RunJob(batch_worker *self, batch_job &job);
+};
+
+void *batch_solver_worker(void *arg);
+
+#endif
@@ -0,0 +1,249 @@
+/**
+ * @file BidirectionalSolver.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a bidirectional breadth-first maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "BidirectionalSolver.h"
+#include <algorithm>
+#include <limits.h>
+
+/* Values of `side` for each cell. */
+#define UNSEEN      (0)
+#define FROM_START  (1)
+#define FROM_GOAL   (2)
+
+/**
+ * @brief Initializes the solver.
+ */
+BidirectionalSolver::BidirectionalSolver()
+{
+    width = 0;
+    height = 0;
+}
+
+
+/**
+ * @brief Deinitializes the solver.
+ */
+BidirectionalSolver::~BidirectionalSolver()
+{
+
+}
+
+
+/**
+ * @brief Solves the maze given by `maze` from the top-left to the
+ * bottom-right corner.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be
+ * solved.
+ */
+void BidirectionalSolver::solve(MazeGrid *maze)
+{
+    solve(maze, 0, 0, maze->get_width() - 1, maze->get_height() - 1);
+}
+
+
+/**
+ * @brief Finds a shortest path between two cells.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be solved.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return True if the goal is reachable; false also if the maze has
+ * too many cells to index or either cell is off the maze.
+ */
+bool BidirectionalSolver::solve(MazeGrid *maze, int sx, int sy, int gx,
+    int gy)
+{
+    double start_time = wall_seconds();
+
+    if (!indexable(maze) || !contains(maze, sx, sy) ||
+        !contains(maze, gx, gy))
+    {
+        path.clear();
+        nodes_expanded = 0;
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    width = maze->get_width();
+    height = maze->get_height();
+
+    size_t cells = (size_t) width * height;
+
+    side.assign(cells, UNSEEN);
+    if (entered.size() < cells)
+    {
+        entered.resize(cells);
+        depth.resize(cells);
+    }
+    path.clear();
+    nodes_expanded = 0;
+
+    long step[W + 1];
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    static const int dirs[] = {N, S, E, W};
+    unsigned int start = (unsigned int) sy * width + sx;
+    unsigned int goal = (unsigned int) gy * width + gx;
+    unsigned int best = UINT_MAX, meet_start = 0, meet_goal = 0;
+
+    if (start == goal)
+    {
+        path.push_back(start);
+        solve_time = wall_seconds() - start_time;
+        return true;
+    }
+
+    frontier[0].assign(1, start);
+    frontier[1].assign(1, goal);
+    side[start] = FROM_START;
+    side[goal] = FROM_GOAL;
+    depth[start] = 0;
+    depth[goal] = 0;
+
+    while (best == UINT_MAX && !frontier[0].empty() && !frontier[1].empty())
+    {
+        /* Advance whichever search has less work queued. */
+        int s = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        unsigned char mine = s == 0 ? FROM_START : FROM_GOAL;
+        vector<unsigned int> &level = frontier[s];
+
+        next_level.clear();
+
+        for (size_t i = 0; i < level.size(); i++)
+        {
+            unsigned int cur = level[i];
+            int moves = maze->get_possible_moves(cur % width, cur / width);
+
+            nodes_expanded++;
+
+            for (int d = 0; d < 4; d++)
+            {
+                if (!(moves & dirs[d]))
+                    continue;
+
+                unsigned int next = cur + step[dirs[d]];
+
+                if (side[next] == UNSEEN)
+                {
+                    side[next] = mine;
+                    entered[next] = dirs[d];
+                    depth[next] = depth[cur] + 1;
+                    next_level.push_back(next);
+                }
+                else if (side[next] != mine &&
+                    depth[cur] + 1 + depth[next] < best)
+                {
+                    /*
+                     * The searches touch. Finish the level so the
+                     * shortest of the joins found in it wins.
+                     */
+                    best = depth[cur] + 1 + depth[next];
+                    meet_start = s == 0 ? cur : next;
+                    meet_goal = s == 0 ? next : cur;
+                }
+            }
+        }
+
+        level.swap(next_level);
+    }
+
+    if (best != UINT_MAX)
+    {
+        /* Goal half, walked from the join out to the goal... */
+        for (unsigned int cur = meet_goal; ; cur -= step[entered[cur]])
+        {
+            path.push_back(cur);
+
+            if (cur == goal)
+                break;
+        }
+
+        /* ...reversed, then the start half back to the start. */
+        reverse(path.begin(), path.end());
+
+        for (unsigned int cur = meet_start; ; cur -= step[entered[cur]])
+        {
+            path.push_back(cur);
+
+            if (cur == start)
+                break;
+        }
+    }
+
+    solve_time = wall_seconds() - start_time;
+    return best != UINT_MAX;
+}
+
+
+/**
+ * @brief Retrieves the path found by the last solve, from the goal
+ * back to the start.
+ *
+ * @return Vector storing the path through the maze.
+ */
+vector<coordinate> BidirectionalSolver::get_path()
+{
+    vector<coordinate> list;
+
+    list.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        coordinate c;
+        c.x = path[i] % width;
+        c.y = path[i] / width;
+
+        list.push_back(c);
+    }
+
+    return list;
+}
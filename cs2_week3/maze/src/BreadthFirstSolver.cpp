@@ -50,9 +50,10 @@
  *
  * @param[in] app Pointer to the main MazeSolverApp class.
  */
-BreadthFirstSolver::BreadthFirstSolver(class MazeSolverApp *app)
+template <class Queue>
+BasicBreadthFirstSolver<Queue>::BasicBreadthFirstSolver(class MazeSolverApp *app)
 {
-    queue = new CoordinateQueue(app);
+    queue = new Queue(app);
     init();
 }
 
@@ -60,31 +61,20 @@ BreadthFirstSolver::BreadthFirstSolver(class MazeSolverApp *app)
 /**
  * @brief Initializes the solver (student-implemented).
  */
-void BreadthFirstSolver::init()
+template <class Queue>
+void BasicBreadthFirstSolver<Queue>::init()
 {
     // Enqueue the (0, 0) queueitem
-    queueitem *item = new queueitem();
-    coordinate *coord = new coordinate();
-    coord->x = 0;
-    coord->y = 0;
-    item->c = coord;
+    queueitem *item = queue->new_item(0, 0);
     queue->enqueue(item);
-
-    // Initalize the visited array
-    for (int i = 0; i < WIDTH; i++)
-    {
-        for (int j = 0; j < HEIGHT; j++)
-        {
-            visited[i][j] = false;
-        }
-    }
 }
 
 
 /**
  * @brief Deinitializes the solver.
  */
-BreadthFirstSolver::~BreadthFirstSolver()
+template <class Queue>
+BasicBreadthFirstSolver<Queue>::~BasicBreadthFirstSolver()
 {
     deinit();
 }
@@ -93,7 +83,8 @@ BreadthFirstSolver::~BreadthFirstSolver()
 /**
  * @brief Deinitializes the solver (student-implemented).
  */
-void BreadthFirstSolver::deinit()
+template <class Queue>
+void BasicBreadthFirstSolver<Queue>::deinit()
 {
     delete queue;
 }
@@ -105,10 +96,18 @@ void BreadthFirstSolver::deinit()
  * @param[in] maze MazeGrid object that stores the maze to be
  * solved.
  */
-void BreadthFirstSolver::solve(MazeGrid *maze)
+template <class Queue>
+void BasicBreadthFirstSolver<Queue>::solve(MazeGrid *maze)
 {
+    width = maze->get_width();
+    height = maze->get_height();
+    visited.assign((size_t) width * height, false);
+    nodes_expanded = 0;
+
+    double start = wall_seconds();
+
     // Used to mark the queueitem that ends up at the end of the maze
-    queueitem *finish;
+    queueitem *finish = NULL;
 
     while(!queue->is_empty())
     {
@@ -118,9 +117,10 @@ void BreadthFirstSolver::solve(MazeGrid *maze)
         int x = current->c->x;
         int y = current->c->y;
 
-        visited[x][y] = true;
+        visited[(size_t) y * width + x] = true;
+        nodes_expanded++;
 
-        if (x == WIDTH - 1 && y == HEIGHT - 1)
+        if (x == width - 1 && y == height - 1)
         {
             finish = current;
             break;
@@ -131,40 +131,28 @@ void BreadthFirstSolver::solve(MazeGrid *maze)
         /*
          * Enqueue all possible moves on the stack
          */
-        if (poss_moves & N && !visited[x][y - 1])
+        if (poss_moves & N && !visited[(size_t) (y - 1) * width + x])
         {
-            next = new queueitem();
-            next->c = new coordinate();
-            next->c->x = x;
-            next->c->y = y - 1;
+            next = queue->new_item(x, y - 1);
             // Set the adder pointer to current (b/c it added this item)
             next->adder = current;
             queue->enqueue(next);
         }
-        if (poss_moves & E && !visited[x + 1][y])
+        if (poss_moves & E && !visited[(size_t) y * width + x + 1])
         {
-            next = new queueitem();
-            next->c = new coordinate();
-            next->c->x = x + 1;
-            next->c->y = y;
+            next = queue->new_item(x + 1, y);
             next->adder = current;
             queue->enqueue(next);
         }
-        if (poss_moves & S && !visited[x][y + 1])
+        if (poss_moves & S && !visited[(size_t) (y + 1) * width + x])
         {
-            next = new queueitem();
-            next->c = new coordinate();
-            next->c->x = x;
-            next->c->y = y + 1;
+            next = queue->new_item(x, y + 1);
             next->adder = current;
             queue->enqueue(next);
         }
-        if (poss_moves & W && !visited[x - 1][y])
+        if (poss_moves & W && !visited[(size_t) y * width + x - 1])
         {
-            next = new queueitem();
-            next->c = new coordinate();
-            next->c->x = x - 1;
-            next->c->y = y;
+            next = queue->new_item(x - 1, y);
             next->adder = current;
             queue->enqueue(next);
         }
@@ -181,6 +169,8 @@ void BreadthFirstSolver::solve(MazeGrid *maze)
         queueitem *add = queue->peek_last()->adder;
         queue->enqueue(add);
     }
+
+    solve_time = wall_seconds() - start;
     return;
 }
 
@@ -190,7 +180,8 @@ void BreadthFirstSolver::solve(MazeGrid *maze)
  *
  * @return Vector storing the current path through the maze.
  */
-vector<coordinate> BreadthFirstSolver::get_path()
+template <class Queue>
+vector<coordinate> BasicBreadthFirstSolver<Queue>::get_path()
 {
     vector<coordinate> list;
     queueitem *cur = queue->peek_last();
@@ -208,3 +199,8 @@ vector<coordinate> BreadthFirstSolver::get_path()
 
     return list;
 }
+
+
+/* The two queues the solver is built with. */
+template class BasicBreadthFirstSolver<VectorCoordinateQueue>;
+template class BasicBreadthFirstSolver<CoordinateQueue>;
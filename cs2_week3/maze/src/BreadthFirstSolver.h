@@ -48,27 +48,41 @@
 
 #include "MazeSolverBase.h"
 #include "CoordinateQueue.h"
+#include "VectorCoordinateQueue.h"
 #include <stdio.h>
 #include <vector>
 
 /**
- * @brief Encapsulates a breadth-first maze solver.
+ * @brief Encapsulates a breadth-first maze solver, built on either
+ * CoordinateQueue or VectorCoordinateQueue.
  */
-class BreadthFirstSolver : MazeSolverBase
+template <class Queue>
+class BasicBreadthFirstSolver : MazeSolverBase
 {
 public:
-    BreadthFirstSolver(class MazeSolverApp *app);
-    virtual ~BreadthFirstSolver();
+    BasicBreadthFirstSolver(class MazeSolverApp *app);
+    virtual ~BasicBreadthFirstSolver();
 
     void solve(MazeGrid *maze);
     vector<coordinate> get_path();
 
 private:
-    class CoordinateQueue *queue;
-    bool visited[WIDTH][HEIGHT];
+    Queue *queue;
+    vector<bool> visited;
+    int width, height;
 
 	void init();
 	void deinit();
 };
 
+/*
+ * The pooled queue is the default; the linked one is kept to compare.
+ * Declared here too since the app header can pull this one in first.
+ */
+class CoordinateQueue;
+class VectorCoordinateQueue;
+
+typedef BasicBreadthFirstSolver<VectorCoordinateQueue> BreadthFirstSolver;
+typedef BasicBreadthFirstSolver<CoordinateQueue> LinkedBreadthFirstSolver;
+
 #endif
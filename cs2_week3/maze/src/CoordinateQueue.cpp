@@ -61,8 +61,9 @@ CoordinateQueue::CoordinateQueue(class MazeSolverApp *app)
     init();
 }
 #else
-CoordinateQueue::CoordinateQueue()
+CoordinateQueue::CoordinateQueue(class MazeSolverApp *)
 {
+    /* Headless builds draw nothing, so the app is not kept. */
     init();
 }
 #endif
@@ -232,3 +233,33 @@ bool CoordinateQueue::is_empty()
     }
     return false;
 }
+
+
+/**
+ * @brief Allocates an item holding (`x`, `y`) on the heap.
+ *
+ * @param[in] x x-coordinate.
+ * @param[in] y y-coordinate.
+ *
+ * @return Pointer to the item.
+ */
+queueitem *CoordinateQueue::new_item(int x, int y)
+{
+    queueitem *q = new queueitem();
+    q->c = new coordinate();
+    q->c->x = x;
+    q->c->y = y;
+    return q;
+}
+
+
+/**
+ * @brief Frees an item from `new_item`.
+ *
+ * @param[in] q Pointer to the item.
+ */
+void CoordinateQueue::recycle(queueitem *q)
+{
+    delete q->c;
+    delete q;
+}
@@ -75,7 +75,7 @@ public:
 #ifndef TESTSUITE
     CoordinateQueue(class MazeSolverApp *app);
 #else
-    CoordinateQueue();
+    CoordinateQueue(class MazeSolverApp *app = NULL);
 #endif
     ~CoordinateQueue();
 
@@ -86,6 +86,9 @@ public:
     void dequeue_all();
     bool is_empty();
 
+    queueitem *new_item(int x, int y);
+    void recycle(queueitem *q);
+
 private:
     queueitem *front, *rear;
 
@@ -60,8 +60,9 @@ CoordinateStack::CoordinateStack(class MazeSolverApp *app)
     init();
 }
 #else
-CoordinateStack::CoordinateStack()
+CoordinateStack::CoordinateStack(class MazeSolverApp *)
 {
+    /* Headless builds draw nothing, so the app is not kept. */
     init();
 }
 #endif
@@ -192,3 +193,33 @@ bool CoordinateStack::is_empty()
     }
     return false;
 }
+
+
+/**
+ * @brief Allocates an item holding (`x`, `y`) on the heap.
+ *
+ * @param[in] x x-coordinate.
+ * @param[in] y y-coordinate.
+ *
+ * @return Pointer to the item.
+ */
+stackitem *CoordinateStack::new_item(int x, int y)
+{
+    stackitem *s = new stackitem();
+    s->c = new coordinate();
+    s->c->x = x;
+    s->c->y = y;
+    return s;
+}
+
+
+/**
+ * @brief Frees an item from `new_item`.
+ *
+ * @param[in] s Pointer to the item.
+ */
+void CoordinateStack::recycle(stackitem *s)
+{
+    delete s->c;
+    delete s;
+}
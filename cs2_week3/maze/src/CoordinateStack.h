@@ -74,7 +74,7 @@ public:
 #ifndef TESTSUITE
     CoordinateStack(class MazeSolverApp *app);
 #else
-    CoordinateStack();
+    CoordinateStack(class MazeSolverApp *app = NULL);
 #endif
     ~CoordinateStack();
 
@@ -83,6 +83,9 @@ public:
     stackitem *peek();
     bool is_empty();
 
+    stackitem *new_item(int x, int y);
+    void recycle(stackitem *s);
+
 private:
     stackitem *top;
 
@@ -0,0 +1,616 @@
+/**
+ * @file CorridorSolver.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Dijkstra solver on a corridor-compressed maze.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+
+#include "CorridorSolver.h"
+#include <algorithm>
+#include <limits.h>
+
+/* Direction bits, and the direction that undoes each one. */
+static const int dirs[] = {N, S, E, W};
+static const int opposite[W + 1] = {0, S, N, 0, W, 0, 0, 0, E};
+
+/* Passages out of a cell, indexed by its 4-bit mask. */
+static const unsigned char degree[16] =
+    {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+/**
+ * @brief Heap ordering: shortest distance first.
+ */
+static bool corridor_later(const corridor_entry &a, const corridor_entry &b)
+{
+    return a.dist > b.dist;
+}
+
+
+/**
+ * @brief Initializes an empty solver, with pruning off.
+ */
+CorridorSolver::CorridorSolver()
+{
+    source = NULL;
+    source_generation = 0;
+    width = 0;
+    height = 0;
+    prune = false;
+    pruned = false;
+}
+
+
+/**
+ * @brief Deinitializes the solver.
+ */
+CorridorSolver::~CorridorSolver()
+{
+}
+
+
+/**
+ * @brief Chooses whether `solve` fills dead ends before compressing.
+ * A pruned graph only serves the endpoints it was built for, so each
+ * such solve rebuilds it.
+ *
+ * @param[in] prune True to fill dead ends.
+ */
+void CorridorSolver::set_pruning(bool prune)
+{
+    this->prune = prune;
+}
+
+
+/**
+ * @brief Builds the compact graph of a whole maze, good for queries
+ * between any two cells.
+ *
+ * @param[in] maze MazeGrid object that stores the maze.
+ *
+ * @return False if the maze has too many cells to index.
+ */
+bool CorridorSolver::build(MazeGrid *maze)
+{
+    if ((size_t) maze->get_width() * maze->get_height() >= NO_NODE)
+        return false;
+
+    load_cells(maze);
+    pruned = false;
+    compress(NO_NODE, NO_NODE);
+
+    return true;
+}
+
+
+/**
+ * @brief Fills every dead end except the two endpoints, then builds
+ * the compact graph of what is left. Only the given endpoints can be
+ * searched afterwards.
+ *
+ * @param[in] maze MazeGrid object that stores the maze.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return False if the maze has too many cells to index.
+ */
+bool CorridorSolver::build(MazeGrid *maze, int sx, int sy, int gx, int gy)
+{
+    if ((size_t) maze->get_width() * maze->get_height() >= NO_NODE)
+        return false;
+
+    unsigned int start = (unsigned int) sy * maze->get_width() + sx;
+    unsigned int goal = (unsigned int) gy * maze->get_width() + gx;
+
+    load_cells(maze);
+    prune_dead_ends(start, goal);
+    pruned = true;
+    compress(start, goal);
+
+    return true;
+}
+
+
+/**
+ * @brief Copies the maze's open walls into `open`, one byte per cell,
+ * so pruning can close them without touching the maze.
+ */
+void CorridorSolver::load_cells(MazeGrid *maze)
+{
+    source = maze;
+    source_generation = maze->get_generation();
+    width = maze->get_width();
+    height = maze->get_height();
+
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    open.resize((size_t) width * height);
+
+    for (int y = 0, c = 0; y < height; y++)
+        for (int x = 0; x < width; x++, c++)
+            open[c] = maze->get_possible_moves(x, y);
+}
+
+
+/**
+ * @brief Dead-end filling: removes cells with at most one open wall,
+ * closing the wall on the neighbor's side, until none are left. The
+ * two kept cells are never removed.
+ */
+void CorridorSolver::prune_dead_ends(unsigned int keep1,
+    unsigned int keep2)
+{
+    size_t cells = open.size();
+
+    pending.clear();
+
+    for (size_t c = 0; c < cells; c++)
+    {
+        if (degree[open[c]] <= 1 && c != keep1 && c != keep2)
+            pending.push_back(c);
+    }
+
+    while (!pending.empty())
+    {
+        unsigned int c = pending.back();
+        pending.pop_back();
+
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(open[c] & dirs[d]))
+                continue;
+
+            unsigned int next = c + step[dirs[d]];
+
+            open[next] &= ~opposite[dirs[d]];
+
+            if (degree[open[next]] == 1 && next != keep1 && next != keep2)
+                pending.push_back(next);
+        }
+
+        open[c] = 0;
+    }
+}
+
+
+/**
+ * @brief Numbers the nodes and links each to its neighbors by walking
+ * every corridor out of it. A cell is a node if it is still in the
+ * maze and does not have exactly two open walls, or is one of the kept
+ * cells; an unpruned graph also keeps the top-left cell, so a maze
+ * that is one big loop still has a node.
+ */
+void CorridorSolver::compress(unsigned int keep1, unsigned int keep2)
+{
+    size_t cells = open.size();
+
+    node_of.assign(cells, NO_NODE);
+    node_cell.clear();
+
+    for (size_t c = 0; c < cells; c++)
+    {
+        bool live = !pruned || open[c] != 0 || c == keep1 || c == keep2;
+
+        if (live && (degree[open[c]] != 2 || c == keep1 || c == keep2 ||
+            (!pruned && c == 0)))
+        {
+            node_of[c] = node_cell.size();
+            node_cell.push_back(c);
+        }
+    }
+
+    first_edge.resize(node_cell.size() + 1);
+    edge_to.clear();
+    edge_length.clear();
+    edge_dir.clear();
+
+    for (size_t u = 0; u < node_cell.size(); u++)
+    {
+        unsigned int cell = node_cell[u], length;
+
+        first_edge[u] = edge_to.size();
+
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(open[cell] & dirs[d]))
+                continue;
+
+            unsigned int end = walk(cell, dirs[d], length, NO_NODE);
+
+            edge_to.push_back(node_of[end]);
+            edge_length.push_back(length);
+            edge_dir.push_back(dirs[d]);
+        }
+    }
+
+    first_edge[node_cell.size()] = edge_to.size();
+}
+
+
+/**
+ * @brief Follows a corridor from `cell` in direction `dir` until it
+ * reaches a node or the `stop` cell.
+ *
+ * @param[in] cell Cell to leave.
+ * @param[in] dir First direction to move in.
+ * @param[out] length Number of moves made.
+ * @param[in] stop Extra cell to stop at, or NO_NODE.
+ *
+ * @return The cell reached, or NO_NODE if the corridor is a loop
+ * without nodes.
+ */
+unsigned int CorridorSolver::walk(unsigned int cell, int dir,
+    unsigned int &length, unsigned int stop)
+{
+    size_t cells = open.size();
+
+    for (length = 1; length <= cells; length++)
+    {
+        cell += step[dir];
+
+        if (node_of[cell] != NO_NODE || cell == stop)
+            return cell;
+
+        dir = open[cell] & ~opposite[dir];
+    }
+
+    return NO_NODE;
+}
+
+
+/**
+ * @brief Appends to `path` the cells of a corridor walk: every cell
+ * after `cell`, up to and including the last.
+ */
+void CorridorSolver::trace(unsigned int cell, int dir, unsigned int length)
+{
+    for (unsigned int i = 0; i < length; i++)
+    {
+        cell += step[dir];
+        path.push_back(cell);
+        dir = open[cell] & ~opposite[dir];
+    }
+}
+
+
+/**
+ * @brief Lowers a node's distance if `d` beats it.
+ */
+void CorridorSolver::relax(unsigned int node, unsigned int d,
+    const corridor_link &l)
+{
+    if (d >= dist[node])
+        return;
+
+    dist[node] = d;
+    link[node] = l;
+
+    corridor_entry e = {d, node};
+    heap.push_back(e);
+    push_heap(heap.begin(), heap.end(), corridor_later);
+}
+
+
+/**
+ * @brief Finds a shortest path on the built graph. An endpoint that is
+ * not a node enters the graph through both ends of its corridor, and
+ * endpoints on the same corridor may also be joined directly.
+ *
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return True if the goal is reachable; false if either cell is off
+ * the maze.
+ */
+bool CorridorSolver::search(int sx, int sy, int gx, int gy)
+{
+    double start_time = wall_seconds();
+    unsigned int start = (unsigned int) sy * width + sx;
+    unsigned int goal = (unsigned int) gy * width + gx;
+
+    path.clear();
+    nodes_expanded = 0;
+
+    /* Cells off the maze, or that pruning removed, are in no corridor. */
+    if (open.empty() || sx < 0 || sy < 0 || gx < 0 || gy < 0 ||
+        sx >= width || sy >= height || gx >= width || gy >= height ||
+        (node_of[start] == NO_NODE && open[start] == 0) ||
+        (node_of[goal] == NO_NODE && open[goal] == 0))
+    {
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    unsigned int best = UINT_MAX, best_node = NO_NODE, length, end;
+    unsigned int goal_node[2], goal_length[2];
+    int goal_dir[2], goal_ends = 0, best_end = 0;
+    corridor_link direct = {NO_NODE, start, 0, 0};
+
+    dist.assign(node_cell.size(), UINT_MAX);
+    link.resize(node_cell.size());
+    heap.clear();
+
+    if (start == goal)
+        best = 0;
+
+    /* Seed the ends of the start's corridor. */
+    if (node_of[start] != NO_NODE)
+    {
+        relax(node_of[start], 0, direct);
+    }
+    else
+    {
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(open[start] & dirs[d]))
+                continue;
+
+            end = walk(start, dirs[d], length, goal);
+
+            if (end == goal && length < best)
+            {
+                best = length;
+                direct.length = length;
+                direct.dir = dirs[d];
+            }
+            else if (end != NO_NODE && end != goal)
+            {
+                corridor_link l = {NO_NODE, start, length,
+                    (unsigned char) dirs[d]};
+                relax(node_of[end], length, l);
+            }
+        }
+    }
+
+    /* Find the ends of the goal's corridor, walking away from it. */
+    if (node_of[goal] != NO_NODE)
+    {
+        goal_node[0] = node_of[goal];
+        goal_length[0] = 0;
+        goal_dir[0] = 0;
+        goal_ends = 1;
+    }
+    else
+    {
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(open[goal] & dirs[d]))
+                continue;
+
+            end = walk(goal, dirs[d], length, NO_NODE);
+
+            if (end != NO_NODE)
+            {
+                goal_node[goal_ends] = node_of[end];
+                goal_length[goal_ends] = length;
+                goal_dir[goal_ends] = dirs[d];
+                goal_ends++;
+            }
+        }
+    }
+
+    while (!heap.empty())
+    {
+        corridor_entry top = heap.front();
+        pop_heap(heap.begin(), heap.end(), corridor_later);
+        heap.pop_back();
+
+        if (top.dist != dist[top.node])
+            continue;
+        if (top.dist >= best)
+            break;
+
+        unsigned int u = top.node;
+        nodes_expanded++;
+
+        for (int k = 0; k < goal_ends; k++)
+        {
+            if (goal_node[k] == u && top.dist + goal_length[k] < best)
+            {
+                best = top.dist + goal_length[k];
+                best_node = u;
+                best_end = k;
+            }
+        }
+
+        for (unsigned int e = first_edge[u]; e < first_edge[u + 1]; e++)
+        {
+            corridor_link l = {u, node_cell[u], edge_length[e],
+                edge_dir[e]};
+            relax(edge_to[e], top.dist + edge_length[e], l);
+        }
+    }
+
+    if (best == UINT_MAX)
+    {
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    /* Lay the path out start first, then flip it to goal first. */
+    path.push_back(start);
+
+    if (best_node == NO_NODE)
+    {
+        trace(start, direct.dir, direct.length);
+    }
+    else
+    {
+        /* Collect the chain of nodes, goal end first. */
+        pending.clear();
+        for (unsigned int v = best_node; v != NO_NODE; v = link[v].from)
+            pending.push_back(v);
+
+        for (size_t i = pending.size(); i-- > 0; )
+        {
+            const corridor_link &l = link[pending[i]];
+            trace(l.cell, l.dir, l.length);
+        }
+
+        /* The goal's corridor was walked from the goal; reverse it. */
+        if (goal_length[best_end] > 0)
+        {
+            size_t mark = path.size();
+
+            trace(goal, goal_dir[best_end], goal_length[best_end]);
+            path.pop_back();
+            reverse(path.begin() + mark, path.end());
+            path.push_back(goal);
+        }
+    }
+
+    reverse(path.begin(), path.end());
+
+    solve_time = wall_seconds() - start_time;
+    return true;
+}
+
+
+/**
+ * @brief Solves the maze given by `maze` from the top-left to the
+ * bottom-right corner.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be
+ * solved.
+ */
+void CorridorSolver::solve(MazeGrid *maze)
+{
+    solve(maze, 0, 0, maze->get_width() - 1, maze->get_height() - 1);
+}
+
+
+/**
+ * @brief Finds a shortest path between two cells, building the graph
+ * first unless an unpruned one of this maze, as it is now, already
+ * exists. The solve time includes the build.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be solved.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return True if the goal is reachable.
+ */
+bool CorridorSolver::solve(MazeGrid *maze, int sx, int sy, int gx, int gy)
+{
+    double start_time = wall_seconds();
+    bool ok;
+
+    if (prune)
+        ok = build(maze, sx, sy, gx, gy);
+    else if (maze != source || maze->get_generation() != source_generation ||
+        pruned)
+        ok = build(maze);
+    else
+        ok = true;
+
+    ok = ok && search(sx, sy, gx, gy);
+
+    solve_time = wall_seconds() - start_time;
+    return ok;
+}
+
+
+/**
+ * @brief Returns the path found by the last search, from goal to
+ * start.
+ *
+ * @return The path as a vector of coordinates.
+ */
+vector<coordinate> CorridorSolver::get_path()
+{
+    vector<coordinate> list;
+
+    list.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        coordinate c;
+        c.x = path[i] % width;
+        c.y = path[i] / width;
+
+        list.push_back(c);
+    }
+
+    return list;
+}
+
+
+/**
+ * @brief Returns the number of nodes in the compact graph.
+ */
+size_t CorridorSolver::get_node_count()
+{
+    return node_cell.size();
+}
+
+
+/**
+ * @brief Returns the number of edges in the compact graph, counting
+ * each corridor once.
+ */
+size_t CorridorSolver::get_edge_count()
+{
+    return edge_to.size() / 2;
+}
+
+
+/**
+ * @brief Returns the bytes held by the graph and the search scratch.
+ */
+size_t CorridorSolver::get_memory_usage()
+{
+    return open.capacity() + node_of.capacity() * 4 +
+        node_cell.capacity() * 4 + first_edge.capacity() * 4 +
+        edge_to.capacity() * 4 + edge_length.capacity() * 4 +
+        edge_dir.capacity() + dist.capacity() * 4 +
+        link.capacity() * sizeof(corridor_link) +
+        heap.capacity() * sizeof(corridor_entry) + pending.capacity() * 4 +
+        path.capacity() * 4;
+}
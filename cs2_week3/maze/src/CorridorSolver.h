@@ -0,0 +1,146 @@
+/**
+ * @file CorridorSolver.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Dijkstra solver on a corridor-compressed maze.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+
+#ifndef __CORRIDORSOLVER_H__
+#define __CORRIDORSOLVER_H__
+
+#include "MazeSolverBase.h"
+#include <stdio.h>
+#include <vector>
+
+/* Marks a cell that is not a node of the compact graph. */
+#define NO_NODE     (0xFFFFFFFFu)
+
+/**
+ * @brief Entry on the Dijkstra heap; stale entries are skipped, as in
+ * AStarSolver.
+ */
+struct corridor_entry
+{
+    unsigned int dist;
+    unsigned int node;
+};
+
+/**
+ * @brief How the search reached a node: the corridor walked, given by
+ * the cell it starts at, its first direction and its length, and the
+ * node it came from (NO_NODE for the start's own corridor).
+ */
+struct corridor_link
+{
+    unsigned int from;
+    unsigned int cell;
+    unsigned int length;
+    unsigned char dir;
+};
+
+/**
+ * @brief Encapsulates a maze solver that searches a compact graph
+ * instead of the grid. `build` keeps only junctions, dead ends and
+ * the top-left cell as nodes, and turns each corridor of two-way cells
+ * between them into one edge weighted by its length; Dijkstra's
+ * algorithm then runs on the nodes, and endpoints inside a corridor
+ * are joined to its two ends at query time. With pruning on, `solve`
+ * first fills every dead end that is not an endpoint, which leaves
+ * just the solution in a perfect maze and only the loops around it in
+ * a braided one. The class doubles as a solver whose `solve` calls
+ * reuse an unpruned graph while the maze is unchanged. Needs no
+ * display.
+ */
+class CorridorSolver : public MazeSolverBase
+{
+public:
+    CorridorSolver();
+    virtual ~CorridorSolver();
+
+    bool build(MazeGrid *maze);
+    bool build(MazeGrid *maze, int sx, int sy, int gx, int gy);
+    bool search(int sx, int sy, int gx, int gy);
+    void set_pruning(bool prune);
+    size_t get_node_count();
+    size_t get_edge_count();
+
+    void solve(MazeGrid *maze);
+    bool solve(MazeGrid *maze, int sx, int sy, int gx, int gy);
+    vector<coordinate> get_path();
+    size_t get_path_length() { return path.size(); };
+    size_t get_memory_usage();
+
+private:
+    MazeGrid *source;
+    unsigned long source_generation;
+    int width, height;
+    long step[W + 1];
+    bool prune, pruned;
+
+    /* Per cell. */
+    vector<unsigned char> open;
+    vector<unsigned int> node_of;
+
+    /* Per node, with edges in compressed rows. */
+    vector<unsigned int> node_cell;
+    vector<unsigned int> first_edge;
+    vector<unsigned int> edge_to;
+    vector<unsigned int> edge_length;
+    vector<unsigned char> edge_dir;
+
+    /* Search scratch. */
+    vector<unsigned int> dist;
+    vector<corridor_link> link;
+    vector<corridor_entry> heap;
+    vector<unsigned int> pending;
+    vector<unsigned int> path;
+
+    void load_cells(MazeGrid *maze);
+    void prune_dead_ends(unsigned int keep1, unsigned int keep2);
+    void compress(unsigned int keep1, unsigned int keep2);
+    unsigned int walk(unsigned int cell, int dir, unsigned int &length,
+        unsigned int stop);
+    void trace(unsigned int cell, int dir, unsigned int length);
+    void relax(unsigned int node, unsigned int d, const corridor_link &l);
+};
+
+#endif
@@ -50,9 +50,10 @@
  *
  * @param[in] app Pointer to the main MazeSolverApp class.
  */
-DepthFirstSolver::DepthFirstSolver(class MazeSolverApp *app)
+template <class Stack>
+BasicDepthFirstSolver<Stack>::BasicDepthFirstSolver(class MazeSolverApp *app)
 {
-    stack = new CoordinateStack(app);
+    stack = new Stack(app);
     init();
 }
 
@@ -60,31 +61,19 @@ DepthFirstSolver::DepthFirstSolver(class MazeSolverApp *app)
 /**
  * @brief Initializes the solver (student-implemented).
  */
-void DepthFirstSolver::init()
+template <class Stack>
+void BasicDepthFirstSolver<Stack>::init()
 {
     // Add (0, 0) item to stack
-    stackitem *item = new stackitem();
-    coordinate *coord = new coordinate();
-    coord->x = 0;
-    coord->y = 0;
-    item->c = coord;
-    stack->push(item);
-
-    // Initalize all values of visited to false
-    for (int i = 0; i < WIDTH; i++)
-    {
-        for (int j = 0; j < HEIGHT; j++)
-        {
-            visited[i][j] = false;
-        }
-    }
+    stack->push(stack->new_item(0, 0));
 }
 
 
 /**
  * @brief Deinitializes the solver.
  */
-DepthFirstSolver::~DepthFirstSolver()
+template <class Stack>
+BasicDepthFirstSolver<Stack>::~BasicDepthFirstSolver()
 {
     deinit();
 }
@@ -93,7 +82,8 @@ DepthFirstSolver::~DepthFirstSolver()
 /**
  * @brief Deinitializes the solver (student-implemented).
  */
-void DepthFirstSolver::deinit()
+template <class Stack>
+void BasicDepthFirstSolver<Stack>::deinit()
 {
     delete stack;
 }
@@ -105,8 +95,16 @@ void DepthFirstSolver::deinit()
  * @param[in] maze MazeGrid object that stores the maze to be
  * solved.
  */
-void DepthFirstSolver::solve(MazeGrid *maze)
+template <class Stack>
+void BasicDepthFirstSolver<Stack>::solve(MazeGrid *maze)
 {
+    width = maze->get_width();
+    height = maze->get_height();
+    visited.assign((size_t) width * height, false);
+    nodes_expanded = 0;
+
+    double start = wall_seconds();
+
     while (!stack->is_empty())
     {
         /*
@@ -114,20 +112,21 @@ void DepthFirstSolver::solve(MazeGrid *maze)
          * with the same coordinates as the current stackitem.
          */
         stackitem *current = stack->peek();
-        stackitem *next = new stackitem();
-        coordinate *coord = new coordinate();
         int x = current->c->x;
         int y = current->c->y;
-        coord->x = x;
-        coord->y = y;
-        next->c = coord;
+        stackitem *next = stack->new_item(x, y);
 
-        visited[x][y] = true;
+        if (!visited[(size_t) y * width + x])
+        {
+            visited[(size_t) y * width + x] = true;
+            nodes_expanded++;
+        }
 
         // Return is end coordinate found
-        if (x == WIDTH - 1 && y == HEIGHT - 1)
+        if (x == width - 1 && y == height - 1)
         {
-            return;
+            stack->recycle(next);
+            break;
         }
 
         /*
@@ -137,37 +136,36 @@ void DepthFirstSolver::solve(MazeGrid *maze)
          * tranverse one path at a time.
          */
         int poss_moves = maze->get_possible_moves(x, y);
-        if (poss_moves & N && !visited[x][y - 1])
+        if (poss_moves & N && !visited[(size_t) (y - 1) * width + x])
         {
             next->c->y--;
             stack->push(next);
         }
-        else if (poss_moves & E && !visited[x + 1][y])
+        else if (poss_moves & E && !visited[(size_t) y * width + x + 1])
         {
             next->c->x++;
             stack->push(next);
         }
-        else if (poss_moves & S && !visited[x][y + 1])
+        else if (poss_moves & S && !visited[(size_t) (y + 1) * width + x])
         {
             next->c->y++;
             stack->push(next);
         }
-        else if (poss_moves & W && !visited[x - 1][y])
+        else if (poss_moves & W && !visited[(size_t) y * width + x - 1])
         {
             next->c->x--;
             stack->push(next);
         }
         else
         {
-            // If no possible moves, pop the stack and delete some pointers.
+            // If no possible moves, pop the stack and recycle the items.
             // This backtracks through the maze.
-            delete next;
-            delete coord;
-            stackitem * item = stack->pop();
-            delete item->c;
-            delete item;
+            stack->recycle(next);
+            stack->recycle(stack->pop());
         }
     }
+
+    solve_time = wall_seconds() - start;
 }
 
 
@@ -176,7 +174,8 @@ void DepthFirstSolver::solve(MazeGrid *maze)
  *
  * @return Vector storing the current path through the maze.
  */
-vector<coordinate> DepthFirstSolver::get_path()
+template <class Stack>
+vector<coordinate> BasicDepthFirstSolver<Stack>::get_path()
 {
     vector<coordinate> list;
     stackitem *cur = stack->peek();
@@ -194,3 +193,8 @@ vector<coordinate> DepthFirstSolver::get_path()
 
     return list;
 }
+
+
+/* The two stacks the solver is built with. */
+template class BasicDepthFirstSolver<VectorCoordinateStack>;
+template class BasicDepthFirstSolver<CoordinateStack>;
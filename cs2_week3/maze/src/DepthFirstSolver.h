@@ -48,27 +48,41 @@
 
 #include "MazeSolverBase.h"
 #include "CoordinateStack.h"
+#include "VectorCoordinateStack.h"
 #include <stdio.h>
 #include <vector>
 
 /**
- * @brief Encapsulates a depth-first maze solver.
+ * @brief Encapsulates a depth-first maze solver, built on either
+ * CoordinateStack or VectorCoordinateStack.
  */
-class DepthFirstSolver : MazeSolverBase
+template <class Stack>
+class BasicDepthFirstSolver : MazeSolverBase
 {
 public:
-    DepthFirstSolver(class MazeSolverApp *app);
-    virtual ~DepthFirstSolver();
+    BasicDepthFirstSolver(class MazeSolverApp *app);
+    virtual ~BasicDepthFirstSolver();
 
     void solve(MazeGrid *maze);
     vector<coordinate> get_path();
 
 private:
-    class CoordinateStack *stack;
-    bool visited[WIDTH][HEIGHT];
+    Stack *stack;
+    vector<bool> visited;
+    int width, height;
 
     void init();
     void deinit();
 };
 
+/*
+ * The pooled stack is the default; the linked one is kept to compare.
+ * Declared here too since the app header can pull this one in first.
+ */
+class CoordinateStack;
+class VectorCoordinateStack;
+
+typedef BasicDepthFirstSolver<VectorCoordinateStack> DepthFirstSolver;
+typedef BasicDepthFirstSolver<CoordinateStack> LinkedDepthFirstSolver;
+
 #endif
@@ -0,0 +1,249 @@
+/**
+ * @file EllerGenerator.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a streaming maze generator.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "EllerGenerator.h"
+
+/**
+ * @brief Initializes the generator.
+ *
+ * @param[in] width Number of columns.
+ * @param[in] height Number of rows.
+ * @param[in] seed Seed for the random number generator.
+ */
+EllerGenerator::EllerGenerator(int width, int height, unsigned int seed)
+    : rng(seed)
+{
+    this->width = width;
+    this->height = height;
+
+    parent.resize(width);
+    above.assign(width, -1);
+    first.assign(width, -1);
+    count.assign(width, 0);
+    last.resize(width);
+    row.resize(width);
+    pending = -1;
+}
+
+
+/**
+ * @brief Deinitializes the generator.
+ */
+EllerGenerator::~EllerGenerator()
+{
+
+}
+
+
+/**
+ * @brief Returns the representative cell of the set containing
+ * column `x`, compressing paths as it goes.
+ */
+int EllerGenerator::find(int x)
+{
+    while (parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+
+    return x;
+}
+
+
+/**
+ * @brief Merges the sets containing columns `a` and `b`.
+ */
+void EllerGenerator::join(int a, int b)
+{
+    parent[find(a)] = find(b);
+}
+
+
+/**
+ * @brief Builds row `y` from the passages left open below row `y - 1`.
+ *
+ * @param[in] y The row to build.
+ */
+void EllerGenerator::make_row(int y)
+{
+    int x, r;
+    bool final = (y == height - 1);
+
+    /* Cells joined from above stay in one set; the rest start alone. */
+    for (x = 0; x < width; x++)
+    {
+        parent[x] = x;
+        row[x] = 0;
+    }
+
+    for (x = 0; x < width; x++)
+    {
+        if (above[x] < 0)
+            continue;
+
+        row[x] = N;
+
+        if (first[above[x]] < 0)
+            first[above[x]] = x;
+        else
+            join(x, first[above[x]]);
+    }
+
+    for (x = 0; x < width; x++)
+    {
+        if (above[x] >= 0)
+            first[above[x]] = -1;
+    }
+
+    /* Randomly open walls between different sets. On the last row
+     * every remaining pair must be joined. */
+    for (x = 0; x < width - 1; x++)
+    {
+        if (find(x) != find(x + 1) && (final || (rng.next() & 1)))
+        {
+            join(x, x + 1);
+            row[x] |= E;
+            row[x + 1] |= W;
+        }
+    }
+
+    if (final)
+        return;
+
+    /* Open at least one passage down from every set. */
+    for (x = 0; x < width; x++)
+    {
+        r = find(x);
+        above[x] = (rng.next() & 1) ? r : -1;
+        count[r] += (above[x] >= 0);
+        last[r] = x;
+    }
+
+    for (x = 0; x < width; x++)
+    {
+        r = find(x);
+
+        if (count[r] == 0)
+        {
+            above[last[r]] = r;
+            count[r] = 1;
+        }
+    }
+
+    for (x = 0; x < width; x++)
+    {
+        count[find(x)] = 0;
+
+        if (above[x] >= 0)
+            row[x] |= S;
+    }
+}
+
+
+/**
+ * @brief Packs the current row two cells to a byte and writes it. A
+ * cell left over from an odd-length row is carried into the next one,
+ * so the file matches the `MazeGrid` buffer exactly.
+ *
+ * @param[in] f File to write to.
+ * @param[in] final True for the last row, which flushes the carry.
+ *
+ * @return True if successful, false otherwise.
+ */
+bool EllerGenerator::emit_row(FILE *f, bool final)
+{
+    out.clear();
+
+    for (int x = 0; x < width; x++)
+    {
+        if (pending < 0)
+        {
+            pending = row[x];
+        }
+        else
+        {
+            out.push_back(pending | (row[x] << 4));
+            pending = -1;
+        }
+    }
+
+    if (final && pending >= 0)
+    {
+        out.push_back(pending);
+        pending = -1;
+    }
+
+    return out.empty() || fwrite(&out[0], 1, out.size(), f) == out.size();
+}
+
+
+/**
+ * @brief Generates the maze and writes it to a file.
+ *
+ * @param[in] filename Path of the file to write.
+ *
+ * @return True if successful, false otherwise.
+ */
+bool EllerGenerator::write(const char *filename)
+{
+    FILE *f = fopen(filename, "wb");
+    bool ok = true;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fprintf(f, "MAZE %d %d\n", width, height);
+
+    for (int y = 0; y < height && ok; y++)
+    {
+        make_row(y);
+        ok = emit_row(f, y == height - 1);
+    }
+
+    return (fclose(f) == 0) && ok;
+}
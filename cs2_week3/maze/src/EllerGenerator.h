@@ -0,0 +1,91 @@
+/**
+ * @file EllerGenerator.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Definitions for a streaming maze generator.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __ELLERGENERATOR_H__
+#define __ELLERGENERATOR_H__
+
+#include <stdio.h>
+#include <vector>
+#include "MazeGrid.h"
+#include "Xorshift.h"
+
+using namespace std;
+
+/**
+ * @brief Generates a perfect maze one row at a time with Eller's
+ * algorithm and streams it to a file in the `MazeGrid::save` format.
+ * Memory use is proportional to the width only, so the maze may be
+ * far larger than memory.
+ */
+class EllerGenerator
+{
+public:
+    EllerGenerator(int width, int height, unsigned int seed);
+    ~EllerGenerator();
+
+    bool write(const char *filename);
+
+private:
+    int width, height;
+    Xorshift rng;
+
+    /* Per-row state, all indexed by column. */
+    vector<int> parent;         /* disjoint sets of this row's cells */
+    vector<int> above;          /* set of the cell above, if joined */
+    vector<int> first;          /* first cell seen per set above */
+    vector<int> count, last;    /* per set: cells going down, last cell */
+    vector<unsigned char> row;  /* open-wall masks */
+
+    /* Nibble packing carried across rows. */
+    vector<unsigned char> out;
+    int pending;
+
+    int find(int x);
+    void join(int a, int b);
+    void make_row(int y);
+    bool emit_row(FILE *f, bool final);
+};
+
+#endif
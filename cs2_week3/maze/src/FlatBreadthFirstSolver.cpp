@@ -0,0 +1,248 @@
+/**
+ * @file FlatBreadthFirstSolver.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for an allocation-free breadth-first maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "FlatBreadthFirstSolver.h"
+
+/* Initial ring-buffer capacity; a power of two. */
+#define INITIAL_FRONTIER    (1 << 12)
+
+/**
+ * @brief Initializes the solver.
+ */
+FlatBreadthFirstSolver::FlatBreadthFirstSolver()
+{
+    width = 0;
+    height = 0;
+    frontier.resize(INITIAL_FRONTIER);
+}
+
+
+/**
+ * @brief Deinitializes the solver.
+ */
+FlatBreadthFirstSolver::~FlatBreadthFirstSolver()
+{
+
+}
+
+
+/**
+ * @brief Sizes the per-cell arrays for `maze` and clears them.
+ */
+void FlatBreadthFirstSolver::reset(MazeGrid *maze)
+{
+    width = maze->get_width();
+    height = maze->get_height();
+
+    size_t cells = (size_t) width * height;
+
+    visited.assign((cells + 31) / 32, 0);
+    if (entered.size() < cells)
+        entered.resize(cells);
+    path.clear();
+}
+
+
+/**
+ * @brief Doubles the ring buffer, unwrapping its contents so they
+ * start at index 0.
+ *
+ * @param[in] head Index of the first queued item.
+ * @param[in] count Number of queued items (equal to the capacity).
+ */
+void FlatBreadthFirstSolver::grow_frontier(size_t head, size_t count)
+{
+    vector<unsigned int> bigger(frontier.size() * 2);
+    size_t mask = frontier.size() - 1;
+
+    for (size_t i = 0; i < count; i++)
+        bigger[i] = frontier[(head + i) & mask];
+
+    frontier.swap(bigger);
+}
+
+
+/**
+ * @brief Solves the maze given by `maze` from the top-left to the
+ * bottom-right corner.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be
+ * solved.
+ */
+void FlatBreadthFirstSolver::solve(MazeGrid *maze)
+{
+    solve(maze, 0, 0, maze->get_width() - 1, maze->get_height() - 1);
+}
+
+
+/**
+ * @brief Finds a shortest path between two cells.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be solved.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return True if the goal is reachable; false also if the maze has
+ * too many cells to index or either cell is off the maze.
+ */
+bool FlatBreadthFirstSolver::solve(MazeGrid *maze, int sx, int sy, int gx,
+    int gy)
+{
+    double start_time = wall_seconds();
+
+    if (!indexable(maze) || !contains(maze, sx, sy) ||
+        !contains(maze, gx, gy))
+    {
+        path.clear();
+        nodes_expanded = 0;
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    reset(maze);
+    nodes_expanded = 0;
+
+    /* Index offset for a move in each direction, by direction bit. */
+    long step[W + 1];
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    static const int dirs[] = {N, S, E, W};
+    unsigned int start = (unsigned int) sy * width + sx;
+    unsigned int goal = (unsigned int) gy * width + gx;
+    size_t head = 0, count = 0, mask = frontier.size() - 1;
+    bool found = false;
+
+    visited[start >> 5] |= 1u << (start & 31);
+    frontier[0] = start;
+    count = 1;
+
+    while (count > 0)
+    {
+        unsigned int cur = frontier[head];
+        head = (head + 1) & mask;
+        count--;
+        nodes_expanded++;
+
+        if (cur == goal)
+        {
+            found = true;
+            break;
+        }
+
+        int moves = maze->get_possible_moves(cur % width, cur / width);
+
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(moves & dirs[d]))
+                continue;
+
+            unsigned int next = cur + step[dirs[d]];
+
+            if (visited[next >> 5] & (1u << (next & 31)))
+                continue;
+
+            visited[next >> 5] |= 1u << (next & 31);
+            entered[next] = dirs[d];
+
+            if (count == frontier.size())
+            {
+                grow_frontier(head, count);
+                head = 0;
+                mask = frontier.size() - 1;
+            }
+
+            frontier[(head + count) & mask] = next;
+            count++;
+        }
+    }
+
+    if (!found)
+    {
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    /* Walk back from the goal against the recorded directions. */
+    for (unsigned int cur = goal; ; cur -= step[entered[cur]])
+    {
+        path.push_back(cur);
+
+        if (cur == start)
+            break;
+    }
+
+    solve_time = wall_seconds() - start_time;
+    return true;
+}
+
+
+/**
+ * @brief Retrieves the path found by the last solve, from the goal
+ * back to the start.
+ *
+ * @return Vector storing the path through the maze.
+ */
+vector<coordinate> FlatBreadthFirstSolver::get_path()
+{
+    vector<coordinate> list;
+
+    list.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        coordinate c;
+        c.x = path[i] % width;
+        c.y = path[i] / width;
+
+        list.push_back(c);
+    }
+
+    return list;
+}
@@ -46,11 +46,33 @@
 #include "MazeGrid.h"
 
 /**
- * @brief Initializes the maze.
+ * @brief Initializes a maze of the default size.
  */
 MazeGrid::MazeGrid()
 {
+    width = WIDTH;
+    height = HEIGHT;
+    capacity = get_memory_usage();
+    cells = new unsigned char[capacity];
+    generation = 0;
+    init();
+}
+
 
+/**
+ * @brief Initializes a maze of the given size.
+ *
+ * @param[in] width Number of columns.
+ * @param[in] height Number of rows.
+ */
+MazeGrid::MazeGrid(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    capacity = get_memory_usage();
+    cells = new unsigned char[capacity];
+    generation = 0;
+    init();
 }
 
 
@@ -59,20 +81,86 @@ MazeGrid::MazeGrid()
  */
 MazeGrid::~MazeGrid()
 {
+    delete[] cells;
+}
+
+
+/**
+ * @brief Returns the number of columns in the maze.
+ */
+int MazeGrid::get_width()
+{
+    return width;
+}
+
+
+/**
+ * @brief Returns the number of rows in the maze.
+ */
+int MazeGrid::get_height()
+{
+    return height;
+}
+
+
+/**
+ * @brief Returns a count that changes whenever the cells do: on
+ * `init`, `resize`, `load` and `carve`.
+ */
+unsigned long MazeGrid::get_generation()
+{
+    return generation;
+}
+
 
+/**
+ * @brief Returns the number of bytes used to store the cells.
+ */
+size_t MazeGrid::get_memory_usage()
+{
+    return ((size_t) width * height + 1) / 2;
 }
 
 
 /**
- * @brief Returns the (x, y) cell of the maze grid, which contains
- * information about the moves possible from that cell.
+ * @brief Changes the size of the maze and clears every cell. The cell
+ * buffer is only reallocated when it has to grow, so a grid reused
+ * for many small mazes stops allocating after the largest one.
  *
- * @param[in] x x-coordinate of the requested cell
- * @param[in] y y-coordinate of the requested cell
+ * @param[in] width Number of columns.
+ * @param[in] height Number of rows.
  */
-int MazeGrid::get_possible_moves(int x, int y)
+void MazeGrid::resize(int width, int height)
 {
-    return grid[x][y];
+    size_t n = ((size_t) width * height + 1) / 2;
+
+    if (n > capacity)
+    {
+        delete[] cells;
+        cells = new unsigned char[n];
+        capacity = n;
+    }
+
+    this->width = width;
+    this->height = height;
+    init();
+}
+
+
+/**
+ * @brief Opens the wall in direction `d` of cell (x, y). Only this
+ * cell is changed; the caller opens the matching wall of the
+ * neighbor.
+ *
+ * @param[in] x x-coordinate of the cell
+ * @param[in] y y-coordinate of the cell
+ * @param[in] d A direction in {N, S, E, W}
+ */
+void MazeGrid::carve(int x, int y, int d)
+{
+    size_t i = (size_t) y * width + x;
+    cells[i >> 1] |= d << ((i & 1) << 2);
+    generation++;
 }
 
 
@@ -81,14 +169,140 @@ int MazeGrid::get_possible_moves(int x, int y)
  */
 void MazeGrid::init()
 {
-    int x, y;
+    size_t i, n = get_memory_usage();
+
+    generation++;
 
     /* Initialize all cells to 0. */
-    for (x = 0; x < WIDTH; x++)
+    for (i = 0; i < n; i++)
+    {
+        cells[i] = 0;
+    }
+}
+
+
+/**
+ * @brief Writes the maze to a file.
+ *
+ * @param[in] filename Path of the file to write.
+ *
+ * @return True if successful, false otherwise.
+ */
+bool MazeGrid::save(const char *filename)
+{
+    FILE *f = fopen(filename, "wb");
+    bool ok;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fprintf(f, "MAZE %d %d\n", width, height);
+    ok = fwrite(cells, 1, get_memory_usage(), f) == get_memory_usage();
+
+    return (fclose(f) == 0) && ok;
+}
+
+
+/**
+ * @brief Replaces this maze with one read from a file written by
+ * `save` or by `EllerGenerator`.
+ *
+ * @param[in] filename Path of the file to read.
+ *
+ * @return True if successful, false otherwise (the maze is left
+ * unchanged). A file whose walls open off the grid, or whose
+ * neighboring cells disagree about the wall between them, is
+ * rejected, since the solvers trust every open wall.
+ */
+bool MazeGrid::load(const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+    int w, h;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    if (fscanf(f, "MAZE %d %d", &w, &h) != 2 || fgetc(f) != '\n' ||
+        w <= 0 || h <= 0)
+    {
+        fclose(f);
+        return false;
+    }
+
+    size_t n = ((size_t) w * h + 1) / 2;
+    unsigned char *buf = new unsigned char[n];
+
+    if (fread(buf, 1, n, f) != n)
+    {
+        delete[] buf;
+        fclose(f);
+        return false;
+    }
+
+    fclose(f);
+
+    if (!walls_agree(buf, w, h))
     {
-        for (y = 0; y < HEIGHT; y++)
+        delete[] buf;
+        return false;
+    }
+
+    delete[] cells;
+    cells = buf;
+    capacity = n;
+    width = w;
+    height = h;
+    generation++;
+
+    return true;
+}
+
+
+/**
+ * @brief Checks a packed cell buffer: no cell opens a wall on the
+ * border of the grid, and every wall is open from both sides or
+ * from neither.
+ *
+ * @param[in] buf Cells, packed as in `cells`.
+ * @param[in] w Number of columns.
+ * @param[in] h Number of rows.
+ *
+ * @return True if the walls are consistent.
+ */
+bool MazeGrid::walls_agree(const unsigned char *buf, int w, int h)
+{
+    size_t i = 0;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++, i++)
         {
-            grid[x][y] = 0;
+            int moves = (buf[i >> 1] >> ((i & 1) << 2)) & 0xF;
+
+            if (((moves & N) && y == 0) || ((moves & S) && y == h - 1) ||
+                ((moves & W) && x == 0) || ((moves & E) && x == w - 1))
+            {
+                return false;
+            }
+
+            /* Compare with the neighbors to the east and south. */
+            size_t j = i + 1, k = i + w;
+            if (x < w - 1 && !(moves & E) !=
+                !((buf[j >> 1] >> ((j & 1) << 2)) & W))
+            {
+                return false;
+            }
+            if (y < h - 1 && !(moves & S) !=
+                !((buf[k >> 1] >> ((k & 1) << 2)) & N))
+            {
+                return false;
+            }
         }
     }
+
+    return true;
 }
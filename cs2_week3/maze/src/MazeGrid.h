@@ -46,6 +46,10 @@
 #ifndef __MAZEGRID_H__
 #define __MAZEGRID_H__
 
+#include <stdlib.h>
+#include <stdio.h>
+
+/* Default maze size, used by the SDL front end. */
 #define WIDTH       (35)
 #define HEIGHT      (25)
 
@@ -58,23 +62,61 @@ using namespace std;
 
 /**
  * @brief Encapsulates a maze.
+ *
+ * Each cell stores its open walls as a 4-bit mask of {N, S, E, W};
+ * two cells are packed into every byte of one contiguous buffer,
+ * in row-major order. `save` writes that buffer after a one-line
+ * "MAZE <width> <height>" header. Every change to the cells bumps a
+ * generation count, so indexes built from the maze can tell when
+ * they are out of date.
  */
 class MazeGrid
 {
 public:
     MazeGrid();
+    MazeGrid(int width, int height);
     ~MazeGrid();
-    
-    int get_possible_moves(int x, int y);
-    
+
+    int get_width();
+    int get_height();
+    unsigned long get_generation();
+    size_t get_memory_usage();
+    bool save(const char *filename);
+    bool load(const char *filename);
+    void resize(int width, int height);
+
+    /**
+     * @brief Returns the (x, y) cell of the maze grid, which contains
+     * information about the moves possible from that cell. Inlined and
+     * branch-free: the nibble is picked out with a computed shift.
+     *
+     * @param[in] x x-coordinate of the requested cell
+     * @param[in] y y-coordinate of the requested cell
+     */
+    int get_possible_moves(int x, int y)
+    {
+        size_t i = (size_t) y * width + x;
+        return (cells[i >> 1] >> ((i & 1) << 2)) & 0xF;
+    }
+
     friend class RecursiveBacktracker;
     friend class MazeSolverApp;
-    
+
 protected:
-    int grid[WIDTH][HEIGHT];
-    
-private:    
+    int width, height;
+    unsigned char *cells;
+    size_t capacity;
+    unsigned long generation;
+
+    void carve(int x, int y, int d);
+
+private:
     void init();
+    static bool walls_agree(const unsigned char *buf, int w, int h);
+
+    /* The grid owns its cell buffer; copying it is not supported. */
+    MazeGrid(const MazeGrid &);
+    MazeGrid &operator=(const MazeGrid &);
 };
 
 #endif
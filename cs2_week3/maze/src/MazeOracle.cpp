@@ -0,0 +1,625 @@
+/**
+ * @file MazeOracle.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a distance and path index over a perfect maze.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "MazeOracle.h"
+#include <algorithm>
+#include <limits.h>
+
+/* Direction bits, and the direction that undoes each one. */
+static const int dirs[] = {N, S, E, W};
+static const int opposite[W + 1] = {0, S, N, 0, W, 0, 0, 0, E};
+
+/**
+ * @brief Initializes an empty index.
+ */
+MazeOracle::MazeOracle()
+{
+    source = NULL;
+    source_generation = 0;
+    width = 0;
+    height = 0;
+    blocks = 0;
+    levels = 0;
+}
+
+
+/**
+ * @brief Deinitializes the index.
+ */
+MazeOracle::~MazeOracle()
+{
+
+}
+
+
+/**
+ * @brief Indexes `maze`. Walks the maze depth-first from (0, 0) with an
+ * explicit stack, writing the Euler tour as it goes.
+ *
+ * @param[in] maze A perfect maze.
+ *
+ * @return False if the maze has a loop or an unreachable cell, or is
+ * too large for tour positions to fit in an `unsigned int`, in which
+ * case the index is left empty.
+ */
+bool MazeOracle::build(MazeGrid *maze)
+{
+    width = maze->get_width();
+    height = maze->get_height();
+
+    size_t cells = (size_t) width * height;
+    size_t tour = 2 * cells - 1, k = 0;
+
+    source = NULL;
+    if (cells >= UINT_MAX / 2)
+    {
+        euler.clear();
+        return false;
+    }
+
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    entered.assign(cells, 0);
+    depth.assign(cells, 0);
+    first.assign(cells, UINT_MAX);
+    euler.resize(tour);
+
+    /* Next direction to try from each cell on the stack. */
+    vector<unsigned char> tried(cells, 0);
+    vector<unsigned int> stack;
+
+    stack.push_back(0);
+    first[0] = 0;
+    euler[k++] = 0;
+
+    while (!stack.empty())
+    {
+        unsigned int cur = stack.back();
+        int moves = maze->get_possible_moves(cur % width, cur / width);
+        int d;
+
+        /* Skip walls and the way back to the parent. */
+        for (d = tried[cur]; d < 4; d++)
+        {
+            if ((moves & dirs[d]) && dirs[d] != opposite[entered[cur]])
+                break;
+        }
+
+        if (d < 4)
+        {
+            unsigned int next = cur + step[dirs[d]];
+
+            tried[cur] = d + 1;
+
+            if (first[next] != UINT_MAX || k >= tour)
+            {
+                /* Reached twice: the maze has a loop. */
+                euler.clear();
+                return false;
+            }
+
+            entered[next] = dirs[d];
+            depth[next] = depth[cur] + 1;
+            first[next] = k;
+            euler[k++] = next;
+            stack.push_back(next);
+        }
+        else
+        {
+            stack.pop_back();
+
+            if (!stack.empty())
+            {
+                if (k >= tour)
+                {
+                    euler.clear();
+                    return false;
+                }
+
+                euler[k++] = stack.back();
+            }
+        }
+    }
+
+    if (k != tour)
+    {
+        /* Some cells were never reached. */
+        euler.clear();
+        return false;
+    }
+
+    index_blocks();
+    source = maze;
+    source_generation = maze->get_generation();
+
+    return true;
+}
+
+
+/**
+ * @brief Whether the index was built (or loaded) for `maze` as it is
+ * now, rather than for an earlier maze at the same address or for
+ * cells that have since been regenerated.
+ */
+bool MazeOracle::indexes(MazeGrid *maze)
+{
+    return !euler.empty() && maze == source &&
+        maze->get_generation() == source_generation;
+}
+
+
+/**
+ * @brief Whether (x, y) is a cell of the indexed maze.
+ */
+bool MazeOracle::contains(int x, int y)
+{
+    return x >= 0 && y >= 0 && x < width && y < height;
+}
+
+
+/**
+ * @brief Builds the in-block bitmasks and the sparse table over block
+ * minima for the Euler tour.
+ */
+void MazeOracle::index_blocks()
+{
+    size_t tour = euler.size();
+
+    blocks = (tour + RMQ_BLOCK - 1) / RMQ_BLOCK;
+    mask.resize(tour);
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        size_t start = b * RMQ_BLOCK;
+        size_t end = std::min(start + RMQ_BLOCK, tour);
+        unsigned int stack = 0;
+
+        /*
+         * Entry i's mask marks the entries of a stack of increasing
+         * depths ending at i; the lowest marked entry at or after l is
+         * the minimum over [l, i].
+         */
+        for (size_t i = start; i < end; i++)
+        {
+            while (stack != 0)
+            {
+                int top = 31 - __builtin_clz(stack);
+
+                if (depth[euler[start + top]] <= depth[euler[i]])
+                    break;
+
+                stack &= ~(1u << top);
+            }
+
+            stack |= 1u << (i - start);
+            mask[i] = stack;
+        }
+    }
+
+    levels = 1;
+    while (((size_t) 1 << levels) <= blocks)
+        levels++;
+
+    sparse.assign(levels * blocks, 0);
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        size_t end = std::min((b + 1) * RMQ_BLOCK, tour) - 1;
+        sparse[b] = block_min(b * RMQ_BLOCK, end);
+    }
+
+    for (size_t j = 1; j < levels; j++)
+    {
+        size_t half = (size_t) 1 << (j - 1);
+
+        for (size_t b = 0; b + 2 * half <= blocks; b++)
+        {
+            sparse[j * blocks + b] = shallower(sparse[(j - 1) * blocks + b],
+                sparse[(j - 1) * blocks + b + half]);
+        }
+    }
+}
+
+
+/**
+ * @brief Of two Euler tour positions, returns the one whose cell is
+ * shallower.
+ */
+unsigned int MazeOracle::shallower(unsigned int a, unsigned int b)
+{
+    return depth[euler[b]] < depth[euler[a]] ? b : a;
+}
+
+
+/**
+ * @brief Position of the shallowest Euler tour entry in [l, r], both
+ * inside one block.
+ */
+unsigned int MazeOracle::block_min(size_t l, size_t r)
+{
+    unsigned int m = mask[r] >> (l % RMQ_BLOCK);
+    return l + __builtin_ctz(m);
+}
+
+
+/**
+ * @brief Lowest common ancestor of cells `u` and `v`.
+ */
+unsigned int MazeOracle::lca(unsigned int u, unsigned int v)
+{
+    size_t l = first[u], r = first[v];
+
+    if (l > r)
+        std::swap(l, r);
+
+    size_t bl = l / RMQ_BLOCK, br = r / RMQ_BLOCK;
+
+    if (bl == br)
+        return euler[block_min(l, r)];
+
+    unsigned int best = shallower(block_min(l, bl * RMQ_BLOCK + RMQ_BLOCK - 1),
+        block_min(br * RMQ_BLOCK, r));
+
+    if (br - bl > 1)
+    {
+        size_t n = br - bl - 1, j = 0;
+
+        while (((size_t) 2 << j) <= n)
+            j++;
+
+        best = shallower(best, sparse[j * blocks + bl + 1]);
+        best = shallower(best,
+            sparse[j * blocks + br - ((size_t) 1 << j)]);
+    }
+
+    return euler[best];
+}
+
+
+/**
+ * @brief Returns the number of steps between two cells.
+ *
+ * @param[in] sx x-coordinate of the first cell.
+ * @param[in] sy y-coordinate of the first cell.
+ * @param[in] gx x-coordinate of the second cell.
+ * @param[in] gy y-coordinate of the second cell.
+ *
+ * @return Length of the path between the cells, in moves, or UINT_MAX
+ * if there is no index or either cell is outside it.
+ */
+unsigned int MazeOracle::distance(int sx, int sy, int gx, int gy)
+{
+    if (euler.empty() || !contains(sx, sy) || !contains(gx, gy))
+        return UINT_MAX;
+
+    unsigned int u = (unsigned int) sy * width + sx;
+    unsigned int v = (unsigned int) gy * width + gx;
+
+    return depth[u] + depth[v] - 2 * depth[lca(u, v)];
+}
+
+
+/**
+ * @brief Finds the path between two cells by climbing from both to
+ * their common ancestor. Read the result with `get_path`.
+ *
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return False if there is no index or either cell is outside it.
+ */
+bool MazeOracle::find_path(int sx, int sy, int gx, int gy)
+{
+    double start_time = wall_seconds();
+
+    path.clear();
+
+    if (euler.empty() || !contains(sx, sy) || !contains(gx, gy))
+        return false;
+
+    unsigned int start = (unsigned int) sy * width + sx;
+    unsigned int goal = (unsigned int) gy * width + gx;
+    unsigned int top = lca(start, goal);
+    size_t half;
+
+    /* Goal up to the ancestor's depth... */
+    unsigned int cur;
+    for (cur = goal; depth[cur] > depth[top]; cur -= step[entered[cur]])
+        path.push_back(cur);
+
+    path.push_back(top);
+    half = path.size();
+
+    /* ...then the start's climb to it, turned around. */
+    for (cur = start; depth[cur] > depth[top]; cur -= step[entered[cur]])
+        path.push_back(cur);
+
+    std::reverse(path.begin() + half, path.end());
+
+    nodes_expanded = path.size();
+    solve_time = wall_seconds() - start_time;
+
+    return true;
+}
+
+
+/**
+ * @brief Solves the maze given by `maze` from the top-left to the
+ * bottom-right corner.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be
+ * solved.
+ */
+void MazeOracle::solve(MazeGrid *maze)
+{
+    solve(maze, 0, 0, maze->get_width() - 1, maze->get_height() - 1);
+}
+
+
+/**
+ * @brief Finds the path between two cells, indexing `maze` first
+ * unless the index was built (or loaded) for it and the maze has not
+ * changed since.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be solved.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return False if `maze` is not a perfect maze.
+ */
+bool MazeOracle::solve(MazeGrid *maze, int sx, int sy, int gx, int gy)
+{
+    double start_time = wall_seconds();
+
+    if (!indexes(maze) && !build(maze))
+        return false;
+
+    bool found = find_path(sx, sy, gx, gy);
+
+    /* Report the build as part of the solve that needed it. */
+    solve_time = wall_seconds() - start_time;
+    return found;
+}
+
+
+/**
+ * @brief Retrieves the path found by the last query, from the goal
+ * back to the start.
+ *
+ * @return Vector storing the path through the maze.
+ */
+vector<coordinate> MazeOracle::get_path()
+{
+    vector<coordinate> list;
+
+    list.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        coordinate c;
+        c.x = path[i] % width;
+        c.y = path[i] / width;
+
+        list.push_back(c);
+    }
+
+    return list;
+}
+
+
+/**
+ * @brief Returns the size of the index in bytes.
+ */
+size_t MazeOracle::get_memory_usage()
+{
+    return entered.size() + 4 * (depth.size() + first.size() +
+        euler.size() + mask.size() + sparse.size());
+}
+
+
+/**
+ * @brief Writes the index to a file: an "ORACLE width height" line
+ * followed by the raw arrays.
+ *
+ * @param[in] filename Path of the file to write.
+ *
+ * @return True if successful, false otherwise.
+ */
+bool MazeOracle::save(const char *filename)
+{
+    if (euler.empty())
+        return false;
+
+    FILE *f = fopen(filename, "wb");
+    bool ok = true;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fprintf(f, "ORACLE %d %d\n", width, height);
+    ok = ok && fwrite(&entered[0], 1, entered.size(), f) == entered.size();
+    ok = ok && fwrite(&depth[0], 4, depth.size(), f) == depth.size();
+    ok = ok && fwrite(&first[0], 4, first.size(), f) == first.size();
+    ok = ok && fwrite(&euler[0], 4, euler.size(), f) == euler.size();
+    ok = ok && fwrite(&mask[0], 4, mask.size(), f) == mask.size();
+    ok = ok && fwrite(&sparse[0], 4, sparse.size(), f) == sparse.size();
+
+    return (fclose(f) == 0) && ok;
+}
+
+
+/**
+ * @brief Replaces the index with one written by `save`.
+ *
+ * @param[in] filename Path of the file to read.
+ * @param[in] maze Optionally, the maze the file was built from, so
+ * that `solve` on it uses the loaded index instead of rebuilding.
+ *
+ * @return True if successful, false otherwise (the index is left
+ * empty). A file whose arrays point outside the maze or the tour is
+ * rejected.
+ */
+bool MazeOracle::load(const char *filename, MazeGrid *maze)
+{
+    FILE *f = fopen(filename, "rb");
+    int w, h;
+
+    euler.clear();
+    source = NULL;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    if (fscanf(f, "ORACLE %d %d", &w, &h) != 2 || fgetc(f) != '\n' ||
+        w <= 0 || h <= 0 || (size_t) w * h >= UINT_MAX / 2 ||
+        (maze != NULL &&
+        (maze->get_width() != w || maze->get_height() != h)))
+    {
+        fclose(f);
+        return false;
+    }
+
+    width = w;
+    height = h;
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    size_t cells = (size_t) w * h, tour = 2 * cells - 1;
+
+    blocks = (tour + RMQ_BLOCK - 1) / RMQ_BLOCK;
+    levels = 1;
+    while (((size_t) 1 << levels) <= blocks)
+        levels++;
+
+    entered.resize(cells);
+    depth.resize(cells);
+    first.resize(cells);
+    euler.resize(tour);
+    mask.resize(tour);
+    sparse.resize(levels * blocks);
+
+    bool ok = fread(&entered[0], 1, cells, f) == cells &&
+        fread(&depth[0], 4, cells, f) == cells &&
+        fread(&first[0], 4, cells, f) == cells &&
+        fread(&euler[0], 4, tour, f) == tour &&
+        fread(&mask[0], 4, tour, f) == tour &&
+        fread(&sparse[0], 4, sparse.size(), f) == sparse.size();
+
+    fclose(f);
+
+    if (!ok || !check_index())
+    {
+        euler.clear();
+        return false;
+    }
+
+    source = maze;
+    source_generation = maze != NULL ? maze->get_generation() : 0;
+    return true;
+}
+
+
+/**
+ * @brief Checks a loaded index enough that queries stay inside its
+ * arrays: every cell but the root was entered from a neighbor one
+ * step shallower, and every tour entry, tour position and in-block
+ * mask is in range. It does not prove the index matches a maze.
+ *
+ * @return True if the index is safe to query.
+ */
+bool MazeOracle::check_index()
+{
+    size_t cells = entered.size(), tour = euler.size();
+
+    if (entered[0] != 0 || depth[0] != 0)
+        return false;
+
+    for (size_t i = 0; i < cells; i++)
+    {
+        int x = i % width, y = i / width, d = entered[i];
+
+        if (first[i] >= tour || euler[first[i]] != i)
+            return false;
+        if (i == 0)
+            continue;
+
+        /* The parent lies opposite the direction of entry. */
+        if (!((d == N && y < height - 1) || (d == S && y > 0) ||
+            (d == E && x > 0) || (d == W && x < width - 1)) ||
+            depth[i - step[d]] + 1 != depth[i])
+            return false;
+    }
+
+    for (size_t i = 0; i < tour; i++)
+    {
+        unsigned int own = 1u << (i % RMQ_BLOCK);
+
+        /* block_min needs entry i's own bit set and none above it. */
+        if (euler[i] >= cells || !(mask[i] & own) ||
+            (mask[i] & ~(2 * own - 1)))
+            return false;
+    }
+
+    for (size_t i = 0; i < sparse.size(); i++)
+    {
+        if (sparse[i] >= tour)
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file MazeOracle.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Definitions for a distance and path index over a perfect maze.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __MAZEORACLE_H__
+#define __MAZEORACLE_H__
+
+#include "MazeSolverBase.h"
+#include <stdio.h>
+#include <vector>
+
+/* Euler tour entries per in-block RMQ block; one bit per entry. */
+#define RMQ_BLOCK       (32)
+
+/**
+ * @brief Answers distance and path queries between any two cells of a
+ * perfect maze. A perfect maze is a tree, so `build` roots it at
+ * (0, 0), records each cell's depth and the direction it was entered
+ * from, and indexes an Euler tour for constant-time lowest common
+ * ancestor queries: a sparse table over per-block minima plus a
+ * monotonic-stack bitmask per entry for queries inside a block.
+ * Distances are then O(1) and paths O(length). The index can be
+ * saved and loaded, and the class doubles as a solver whose `solve`
+ * calls reuse it for as long as the maze is unchanged.
+ */
+class MazeOracle : public MazeSolverBase
+{
+public:
+    MazeOracle();
+    virtual ~MazeOracle();
+
+    bool build(MazeGrid *maze);
+    unsigned int distance(int sx, int sy, int gx, int gy);
+    bool find_path(int sx, int sy, int gx, int gy);
+
+    void solve(MazeGrid *maze);
+    bool solve(MazeGrid *maze, int sx, int sy, int gx, int gy);
+    vector<coordinate> get_path();
+    size_t get_path_length() { return path.size(); };
+
+    bool save(const char *filename);
+    bool load(const char *filename, MazeGrid *maze = NULL);
+    size_t get_memory_usage();
+
+private:
+    MazeGrid *source;
+    unsigned long source_generation;
+    int width, height;
+    long step[W + 1];
+
+    vector<unsigned char> entered;
+    vector<unsigned int> depth;
+    vector<unsigned int> first;
+    vector<unsigned int> euler;
+    vector<unsigned int> mask;
+    vector<unsigned int> sparse;
+    size_t blocks, levels;
+    vector<unsigned int> path;
+
+    void index_blocks();
+    bool check_index();
+    bool indexes(MazeGrid *maze);
+    bool contains(int x, int y);
+    unsigned int lca(unsigned int u, unsigned int v);
+    unsigned int block_min(size_t l, size_t r);
+    unsigned int shallower(unsigned int a, unsigned int b);
+};
+
+#endif
@@ -154,6 +154,8 @@ void MazeSolverApp::OnEvent(SDL_Event* event)
 
             solver = (MazeSolverBase *) new DepthFirstSolver(this);
             solver->solve(maze);
+            printf("%lu cells expanded in %.3f ms\n",
+                solver->get_nodes_expanded(), solver->get_solve_time() * 1e3);
             OnRender();
         }
         else if (event->key.keysym.unicode == 'b')
@@ -167,6 +169,75 @@ void MazeSolverApp::OnEvent(SDL_Event* event)
 
             solver = (MazeSolverBase *) new BreadthFirstSolver(this);
             solver->solve(maze);
+            printf("%lu cells expanded in %.3f ms\n",
+                solver->get_nodes_expanded(), solver->get_solve_time() * 1e3);
+            OnRender();
+        }
+        else if (event->key.keysym.unicode == 'f')
+        {
+            /* Solve the maze with the flat-array breadth-first search. */
+            if (solver)
+            {
+                delete solver;
+                solver = NULL;
+            }
+
+            solver = new FlatBreadthFirstSolver();
+            solver->solve(maze);
+            printf("%lu cells expanded in %.3f ms\n",
+                solver->get_nodes_expanded(), solver->get_solve_time() * 1e3);
+            OnRender();
+        }
+        else if (event->key.keysym.unicode == 'a')
+        {
+            /* Solve the maze with an A* search. */
+            if (solver)
+            {
+                delete solver;
+                solver = NULL;
+            }
+
+            solver = new AStarSolver();
+            solver->solve(maze);
+            printf("%lu cells expanded in %.3f ms\n",
+                solver->get_nodes_expanded(), solver->get_solve_time() * 1e3);
+            OnRender();
+        }
+        else if (event->key.keysym.unicode == 'm')
+        {
+            /* Solve the maze searching from both ends to meet in the middle. */
+            if (solver)
+            {
+                delete solver;
+                solver = NULL;
+            }
+
+            solver = new BidirectionalSolver();
+            solver->solve(maze);
+            printf("%lu cells expanded in %.3f ms\n",
+                solver->get_nodes_expanded(), solver->get_solve_time() * 1e3);
+            OnRender();
+        }
+        else if (event->key.keysym.unicode == 'c' ||
+            event->key.keysym.unicode == 'p')
+        {
+            /*
+             * Solve the maze with Dijkstra on its corridor graph; 'p'
+             * fills the dead ends first.
+             */
+            if (solver)
+            {
+                delete solver;
+                solver = NULL;
+            }
+
+            CorridorSolver *corridor = new CorridorSolver();
+            corridor->set_pruning(event->key.keysym.unicode == 'p');
+            solver = corridor;
+            solver->solve(maze);
+            printf("%lu nodes, %lu expanded in %.3f ms\n",
+                (unsigned long) corridor->get_node_count(),
+                solver->get_nodes_expanded(), solver->get_solve_time() * 1e3);
             OnRender();
         }
         else if (event->key.keysym.unicode == 'r')
@@ -216,8 +287,9 @@ void MazeSolverApp::draw_maze()
 {
     int x, y;
     int h = 0, w = 0;
+    int width = maze->get_width(), height = maze->get_height();
 
-    for (x = 0; x < WIDTH * 2; x++)
+    for (x = 0; x < width * 2; x++)
     {
         /* Horizontal line (top) */
         boxRGBA(surf, MAZE_X_OFFSET,
@@ -229,7 +301,7 @@ void MazeSolverApp::draw_maze()
 
     h++;
 
-    for (y = 0; y < HEIGHT; y++)
+    for (y = 0; y < height; y++)
     {
         /* Vertical line (left) */
         if (y != 0)
@@ -242,9 +314,11 @@ void MazeSolverApp::draw_maze()
 
         w++;
 
-        for (x = 0; x < WIDTH; x++)
+        for (x = 0; x < width; x++)
         {
-            if ((maze->grid[x][y] & S) != 0)
+            int moves = maze->get_possible_moves(x, y);
+
+            if ((moves & S) != 0)
             {
                 w++;
             }
@@ -259,10 +333,10 @@ void MazeSolverApp::draw_maze()
                 w++;
             }
 
-            if ((maze->grid[x][y] & E) != 0)
+            if ((moves & E) != 0)
             {
-                if (((maze->grid[x][y] |
-                    maze->grid[x+1][y]) & S) != 0)
+                if (((moves |
+                    maze->get_possible_moves(x + 1, y)) & S) != 0)
                 {
                     w++;
                 }
@@ -280,7 +354,7 @@ void MazeSolverApp::draw_maze()
             else
             {
                 /* Vertical line */
-                if ((x < WIDTH - 1) || (y < HEIGHT - 1))
+                if ((x < width - 1) || (y < height - 1))
                 {
                     boxRGBA(surf, w * MAZE_H_LENGTH + MAZE_X_OFFSET,
                         (h - 1) * MAZE_V_LENGTH + MAZE_Y_OFFSET,
@@ -54,6 +54,10 @@
 #include "MazeSolverBase.h"
 #include "DepthFirstSolver.h"
 #include "BreadthFirstSolver.h"
+#include "FlatBreadthFirstSolver.h"
+#include "AStarSolver.h"
+#include "BidirectionalSolver.h"
+#include "CorridorSolver.h"
 
 #define SCREEN_WIDTH    (800)
 #define SCREEN_HEIGHT   (600)
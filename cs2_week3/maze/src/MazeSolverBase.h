@@ -46,6 +46,8 @@
 #ifndef __MAZESOLVERBASE_H__
 #define __MAZESOLVERBASE_H__
 
+#include <limits.h>
+#include <sys/time.h>
 #include <vector>
 #include "MazeGrid.h"
 #include "structs.h"
@@ -60,7 +62,7 @@ public:
     /**
      * @brief Initializes the solver.
      */
-    MazeSolverBase() { };
+    MazeSolverBase() : nodes_expanded(0), solve_time(0) { };
     
     /**
      * @brief Deinitializes the solver.
@@ -69,6 +71,74 @@ public:
 
     virtual void solve(MazeGrid *maze) = 0;
     virtual vector<coordinate> get_path() = 0;
+
+    /**
+     * @brief Finds a path between two given cells. Solvers that only
+     * know the corner-to-corner search handle that case and report
+     * failure for any other pair.
+     *
+     * @return True if a path was found.
+     */
+    virtual bool solve(MazeGrid *maze, int sx, int sy, int gx, int gy)
+    {
+        if (sx != 0 || sy != 0 || gx != maze->get_width() - 1 ||
+            gy != maze->get_height() - 1)
+            return false;
+
+        solve(maze);
+        return !get_path().empty();
+    };
+
+    /**
+     * @brief Number of cells on the last path found, without building
+     * the coordinate list `get_path` returns.
+     */
+    virtual size_t get_path_length() { return get_path().size(); };
+
+    /**
+     * @brief Number of cells the last solve took off its open list.
+     */
+    unsigned long get_nodes_expanded() { return nodes_expanded; };
+
+    /**
+     * @brief Wall-clock duration of the last solve, in seconds.
+     */
+    double get_solve_time() { return solve_time; };
+
+    /**
+     * @brief Current wall-clock time in seconds, for timing solves;
+     * the benchmarks time their own runs with it too.
+     */
+    static double wall_seconds()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec * 1e-6;
+    };
+
+protected:
+    unsigned long nodes_expanded;
+    double solve_time;
+
+    /**
+     * @brief Whether every cell of the maze has an index that fits in
+     * an `unsigned int`, as the flat-array solvers store them. Larger
+     * mazes are rejected rather than left to wrap around.
+     */
+    static bool indexable(MazeGrid *maze)
+    {
+        return (size_t) maze->get_width() * maze->get_height() < UINT_MAX;
+    };
+
+    /**
+     * @brief Whether (x, y) is a cell of the maze. Solvers that turn
+     * the caller's coordinates into array indices check them first.
+     */
+    static bool contains(MazeGrid *maze, int x, int y)
+    {
+        return x >= 0 && y >= 0 && x < maze->get_width() &&
+            y < maze->get_height();
+    };
 };
 
 #endif
@@ -0,0 +1,475 @@
+/**
+ * @file ParallelBreadthFirstSolver.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a parallel breadth-first maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "ParallelBreadthFirstSolver.h"
+
+/* Direction bits, and the direction that undoes each one. */
+static const int dirs[] = {N, S, E, W};
+static const int opposite[W + 1] = {0, S, N, 0, W, 0, 0, 0, E};
+
+/**
+ * @brief Initializes the solver and starts its worker pool.
+ *
+ * @param[in] nthreads Number of worker threads to start; the calling
+ * thread also works, and 0 runs every level on it alone.
+ */
+ParallelBreadthFirstSolver::ParallelBreadthFirstSolver(int nthreads)
+{
+    maze = NULL;
+    width = 0;
+    height = 0;
+    cells = 0;
+    bottom_up_levels = 0;
+    alpha = BOTTOM_UP_ALPHA;
+    beta = BOTTOM_UP_BETA;
+    bottom_up = false;
+    shared = false;
+    next_chunk = 0;
+
+    this->nthreads = nthreads;
+    stopping = false;
+    workers = new Thread[nthreads];
+    scratch = new bfs_worker[nthreads + 1];
+
+    for (int i = 0; i <= nthreads; i++)
+    {
+        scratch[i].solver = this;
+        scratch[i].id = i;
+        scratch[i].count = 0;
+    }
+
+    for (int i = 0; i < nthreads; i++)
+        workers[i].run(parallel_bfs_worker, (void *) &scratch[i + 1]);
+}
+
+
+/**
+ * @brief Stops the worker pool.
+ */
+ParallelBreadthFirstSolver::~ParallelBreadthFirstSolver()
+{
+    stopping = true;
+
+    for (int i = 0; i < nthreads; i++)
+        start.inc();
+
+    for (int i = 0; i < nthreads; i++)
+        workers[i].join();
+
+    delete[] workers;
+    delete[] scratch;
+}
+
+
+/**
+ * @brief Solves the maze given by `maze` from the top-left to the
+ * bottom-right corner.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be
+ * solved.
+ */
+void ParallelBreadthFirstSolver::solve(MazeGrid *maze)
+{
+    solve(maze, 0, 0, maze->get_width() - 1, maze->get_height() - 1);
+}
+
+
+/**
+ * @brief Finds a shortest path between two cells.
+ *
+ * @param[in] maze MazeGrid object that stores the maze to be solved.
+ * @param[in] sx x-coordinate of the start cell.
+ * @param[in] sy y-coordinate of the start cell.
+ * @param[in] gx x-coordinate of the goal cell.
+ * @param[in] gy y-coordinate of the goal cell.
+ *
+ * @return True if the goal is reachable; false also if the maze has
+ * too many cells to index or either cell is off the maze.
+ */
+bool ParallelBreadthFirstSolver::solve(MazeGrid *maze, int sx, int sy,
+    int gx, int gy)
+{
+    double start_time = wall_seconds();
+
+    if (!indexable(maze) || !contains(maze, sx, sy) ||
+        !contains(maze, gx, gy))
+    {
+        path.clear();
+        nodes_expanded = 0;
+        solve_time = wall_seconds() - start_time;
+        return false;
+    }
+
+    this->maze = maze;
+    width = maze->get_width();
+    height = maze->get_height();
+    cells = (size_t) width * height;
+
+    size_t words = (cells + 31) / 32;
+
+    step[N] = -(long) width;
+    step[S] = width;
+    step[E] = 1;
+    step[W] = -1;
+
+    visited.assign(words, 0);
+    if (entered.size() < cells)
+        entered.resize(cells);
+    path.clear();
+    nodes_expanded = 0;
+    bottom_up_levels = 0;
+    bottom_up = false;
+
+    unsigned int start = (unsigned int) sy * width + sx;
+    unsigned int goal = (unsigned int) gy * width + gx;
+    size_t level_size = 1, seen = 1;
+
+    visited[start >> 5] |= 1u << (start & 31);
+    frontier.assign(1, start);
+
+    while (level_size > 0 && !(visited[goal >> 5] & (1u << (goal & 31))))
+    {
+        nodes_expanded += level_size;
+
+        if (!bottom_up && level_size > (cells - seen) / alpha &&
+            level_size >= cells / beta)
+        {
+            /* Frontier list to bitset. */
+            in_frontier.assign(words, 0);
+            in_next.resize(words);
+
+            for (size_t i = 0; i < frontier.size(); i++)
+                in_frontier[frontier[i] >> 5] |= 1u << (frontier[i] & 31);
+
+            bottom_up = true;
+        }
+        else if (bottom_up && level_size < cells / beta)
+        {
+            /* Frontier bitset to list. */
+            frontier.clear();
+
+            for (size_t w = 0; w < words; w++)
+            {
+                unsigned int bits = in_frontier[w];
+
+                for (; bits; bits &= bits - 1)
+                    frontier.push_back(w * 32 + __builtin_ctz(bits));
+            }
+
+            bottom_up = false;
+        }
+
+        RunLevel(nthreads > 0 &&
+            (bottom_up ? words : level_size) >= PARALLEL_MIN);
+
+        level_size = 0;
+
+        for (int i = 0; i <= nthreads; i++)
+            level_size += scratch[i].count;
+
+        seen += level_size;
+
+        if (bottom_up)
+        {
+            in_frontier.swap(in_next);
+            bottom_up_levels++;
+        }
+        else
+        {
+            frontier.clear();
+
+            for (int i = 0; i <= nthreads; i++)
+            {
+                frontier.insert(frontier.end(), scratch[i].claimed.begin(),
+                    scratch[i].claimed.end());
+            }
+        }
+    }
+
+    bool found = visited[goal >> 5] & (1u << (goal & 31));
+
+    if (found)
+    {
+        /* Walk back from the goal against the recorded directions. */
+        for (unsigned int cur = goal; ; cur -= step[entered[cur]])
+        {
+            path.push_back(cur);
+
+            if (cur == start)
+                break;
+        }
+    }
+
+    solve_time = wall_seconds() - start_time;
+    return found;
+}
+
+
+/**
+ * @brief Expands the current level, on the pool or on the calling
+ * thread alone, and returns once every thread is done with it.
+ *
+ * @param[in] parallel Whether to wake the worker threads.
+ */
+void ParallelBreadthFirstSolver::RunLevel(bool parallel)
+{
+    for (int i = 0; i <= nthreads; i++)
+    {
+        scratch[i].claimed.clear();
+        scratch[i].count = 0;
+    }
+
+    next_chunk = 0;
+    shared = parallel;
+    __sync_synchronize();
+
+    if (!parallel)
+    {
+        WorkLevel(&scratch[0]);
+        return;
+    }
+
+    for (int i = 0; i < nthreads; i++)
+        start.inc();
+
+    WorkLevel(&scratch[0]);
+
+    for (int i = 0; i < nthreads; i++)
+        done.dec();
+}
+
+
+/**
+ * @brief Claims chunks of the current level until none are left.
+ *
+ * @param[in] self The calling thread's scratch state.
+ */
+void ParallelBreadthFirstSolver::WorkLevel(bfs_worker *self)
+{
+    size_t total = bottom_up ? visited.size() : frontier.size();
+    int chunk = bottom_up ? BOTTOM_UP_CHUNK : TOP_DOWN_CHUNK;
+
+    while (true)
+    {
+        size_t first = __sync_fetch_and_add(&next_chunk, chunk);
+
+        if (first >= total)
+            break;
+
+        size_t last = first + chunk < total ? first + chunk : total;
+
+        if (bottom_up)
+            BottomUp(self, first, last);
+        else
+            TopDown(self, first, last);
+    }
+}
+
+
+/**
+ * @brief Top-down step: visits the unclaimed neighbors of a range of
+ * frontier cells. A neighbor belongs to whichever thread sets its
+ * visited bit first.
+ *
+ * @param[in] self The calling thread's scratch state.
+ * @param[in] first Index of the first frontier cell.
+ * @param[in] last One past the last frontier cell.
+ */
+void ParallelBreadthFirstSolver::TopDown(bfs_worker *self, size_t first,
+    size_t last)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        unsigned int cur = frontier[i];
+        int moves = maze->get_possible_moves(cur % width, cur / width);
+
+        for (int d = 0; d < 4; d++)
+        {
+            if (!(moves & dirs[d]))
+                continue;
+
+            unsigned int next = cur + step[dirs[d]];
+            unsigned int *word = &visited[next >> 5];
+            unsigned int bit = 1u << (next & 31);
+
+            if (*word & bit)
+                continue;
+
+            if (!shared)
+                *word |= bit;
+            else if (__sync_fetch_and_or(word, bit) & bit)
+                continue;
+
+            entered[next] = dirs[d];
+            self->claimed.push_back(next);
+            self->count++;
+        }
+    }
+}
+
+
+/**
+ * @brief Bottom-up step: each unvisited cell in a range of bitset
+ * words looks for a neighbor in the frontier. Ranges are whole words,
+ * so no other thread touches the visited and next-frontier words
+ * written here.
+ *
+ * @param[in] self The calling thread's scratch state.
+ * @param[in] first Index of the first bitset word.
+ * @param[in] last One past the last bitset word.
+ */
+void ParallelBreadthFirstSolver::BottomUp(bfs_worker *self, size_t first,
+    size_t last)
+{
+    for (size_t w = first; w < last; w++)
+    {
+        unsigned int todo = ~visited[w], found = 0;
+
+        if (w == visited.size() - 1 && cells % 32 != 0)
+            todo &= (1u << (cells % 32)) - 1;
+
+        for (; todo; todo &= todo - 1)
+        {
+            int b = __builtin_ctz(todo);
+            unsigned int cur = w * 32 + b;
+            int moves = maze->get_possible_moves(cur % width, cur / width);
+
+            for (int d = 0; d < 4; d++)
+            {
+                if (!(moves & dirs[d]))
+                    continue;
+
+                unsigned int parent = cur + step[dirs[d]];
+
+                if (in_frontier[parent >> 5] & (1u << (parent & 31)))
+                {
+                    entered[cur] = opposite[dirs[d]];
+                    found |= 1u << b;
+                    break;
+                }
+            }
+        }
+
+        in_next[w] = found;
+        visited[w] |= found;
+        self->count += __builtin_popcount(found);
+    }
+}
+
+
+/**
+ * @brief Retrieves the path found by the last solve, from the goal
+ * back to the start.
+ *
+ * @return Vector storing the path through the maze.
+ */
+vector<coordinate> ParallelBreadthFirstSolver::get_path()
+{
+    vector<coordinate> list;
+
+    list.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        coordinate c;
+        c.x = path[i] % width;
+        c.y = path[i] / width;
+
+        list.push_back(c);
+    }
+
+    return list;
+}
+
+
+/**
+ * @brief Number of levels the last solve expanded bottom-up.
+ */
+unsigned long ParallelBreadthFirstSolver::get_bottom_up_levels()
+{
+    return bottom_up_levels;
+}
+
+
+/**
+ * @brief Sets when the solver changes direction: it goes bottom-up
+ * once the frontier holds over 1/`alpha` of the unvisited cells and
+ * at least 1/`beta` of all cells, and top-down again once it falls
+ * below 1/`beta` of all cells.
+ *
+ * @param[in] alpha Unvisited-cell ratio; 0 is taken as 1.
+ * @param[in] beta Total-cell ratio; 0 is taken as 1.
+ */
+void ParallelBreadthFirstSolver::set_switch_ratios(size_t alpha, size_t beta)
+{
+    this->alpha = alpha > 0 ? alpha : 1;
+    this->beta = beta > 0 ? beta : 1;
+}
+
+
+/**
+ * @brief Worker thread body: expands levels until the solver is
+ * destroyed.
+ *
+ * @param arg The thread's `bfs_worker` scratch state.
+ */
+void *parallel_bfs_worker(void *arg)
+{
+    bfs_worker *self = (bfs_worker *) arg;
+    ParallelBreadthFirstSolver *solver = self->solver;
+
+    while (true)
+    {
+        solver->start.dec();
+
+        if (solver->stopping)
+            break;
+
+        solver->WorkLevel(self);
+        solver->done.inc();
+    }
+
+    return NULL;
+}
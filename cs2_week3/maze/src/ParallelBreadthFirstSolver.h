@@ -0,0 +1,142 @@
+/**
+ * @file ParallelBreadthFirstSolver.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Definitions for a parallel breadth-first maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __PARALLELBREADTHFIRSTSOLVER_H__
+#define __PARALLELBREADTHFIRSTSOLVER_H__
+
+#include "MazeSolverBase.h"
+#include "Thread.h"
+#include <stdio.h>
+#include <vector>
+
+/* Frontier cells a thread claims at a time in a top-down level. */
+#define TOP_DOWN_CHUNK      (256)
+
+/* Bitset words (32 cells each) a thread claims in a bottom-up level. */
+#define BOTTOM_UP_CHUNK     (64)
+
+/* Levels with less work than this run on the calling thread alone. */
+#define PARALLEL_MIN        (2048)
+
+/*
+ * Go bottom-up once the frontier exceeds 1/ALPHA of the unvisited
+ * cells and 1/BETA of all cells; go back top-down once it drops below
+ * 1/BETA of all cells.
+ */
+#define BOTTOM_UP_ALPHA     (14)
+#define BOTTOM_UP_BETA      (24)
+
+class ParallelBreadthFirstSolver;
+
+/**
+ * @brief Per-thread state: the thread's id and the cells it claimed
+ * during the current level.
+ */
+struct bfs_worker
+{
+    ParallelBreadthFirstSolver *solver;
+    int id;
+    vector<unsigned int> claimed;
+    unsigned long count;
+};
+
+/**
+ * @brief Encapsulates a breadth-first maze solver that expands one
+ * level at a time across a pool of threads. Threads claim chunks of
+ * the frontier and mark visited cells with atomic bit operations. When
+ * the frontier grows large the solver switches to bottom-up levels, in
+ * which each unvisited cell looks for a parent in the frontier instead.
+ * Needs no display.
+ */
+class ParallelBreadthFirstSolver : public MazeSolverBase
+{
+public:
+    ParallelBreadthFirstSolver(int nthreads);
+    virtual ~ParallelBreadthFirstSolver();
+
+    void solve(MazeGrid *maze);
+    bool solve(MazeGrid *maze, int sx, int sy, int gx, int gy);
+    vector<coordinate> get_path();
+    size_t get_path_length() { return path.size(); };
+    unsigned long get_bottom_up_levels();
+    void set_switch_ratios(size_t alpha, size_t beta);
+
+private:
+    friend void *parallel_bfs_worker(void *arg);
+
+    MazeGrid *maze;
+    int width, height;
+    size_t cells;
+    long step[W + 1];
+
+    vector<unsigned int> visited;
+    vector<unsigned int> in_frontier, in_next;
+    vector<unsigned char> entered;
+    vector<unsigned int> frontier;
+    vector<unsigned int> path;
+    unsigned long bottom_up_levels;
+    size_t alpha, beta;
+
+    /* Current level. */
+    bool bottom_up;
+    bool shared;
+    int next_chunk;
+
+    /* Worker pool. */
+    int nthreads;
+    bool stopping;
+    Thread *workers;
+    bfs_worker *scratch;
+    Semaphore start, done;
+
+    void RunLevel(bool parallel);
+    void WorkLevel(bfs_worker *self);
+    void TopDown(bfs_worker *self, size_t first, size_t last);
+    void BottomUp(bfs_worker *self, size_t first, size_t last);
+};
+
+void *parallel_bfs_worker(void *arg);
+
+#endif
@@ -59,6 +59,18 @@ RecursiveBacktracker::RecursiveBacktracker()
     srand(time(0));
 }
 
+/**
+ * @brief Initializes a generator for mazes of the given size.
+ *
+ * @param[in] width Number of columns.
+ * @param[in] height Number of rows.
+ */
+RecursiveBacktracker::RecursiveBacktracker(int width, int height)
+{
+    maze = new MazeGrid(width, height);
+    srand(time(0));
+}
+
 /**
  * @brief Deinitializes the maze generator.
  */
@@ -73,21 +85,24 @@ RecursiveBacktracker::~RecursiveBacktracker()
 void RecursiveBacktracker::ascii_print()
 {
     int x, y;
-    
-    for (x = 0; x < WIDTH * 2; x++)
+    int width = maze->get_width(), height = maze->get_height();
+
+    for (x = 0; x < width * 2; x++)
     {
         printf("_");
     }
 
     printf("\n");
 
-    for (y = 0; y < HEIGHT; y++)
+    for (y = 0; y < height; y++)
     {
         printf("|");
 
-        for (x = 0; x < WIDTH; x++)
+        for (x = 0; x < width; x++)
         {
-            if ((maze->grid[x][y] & S) != 0)
+            int moves = maze->get_possible_moves(x, y);
+
+            if ((moves & S) != 0)
             {
                 printf(" ");
             }
@@ -96,10 +111,10 @@ void RecursiveBacktracker::ascii_print()
                 printf("_");
             }
             
-            if ((maze->grid[x][y] & E) != 0)
+            if ((moves & E) != 0)
             {
-                if (((maze->grid[x][y] | 
-                    maze->grid[x+1][y]) & S) != 0)
+                if (((moves |
+                    maze->get_possible_moves(x + 1, y)) & S) != 0)
                 {
                     printf(" ");
                 }
@@ -134,21 +149,162 @@ void RecursiveBacktracker::carve_passages_from(int cx, int cy)
         nx = cx + get_dx(directions[i]);
         ny = cy + get_dy(directions[i]);
         
-        if ((nx >= 0 && nx < WIDTH) && (ny >= 0 && ny < HEIGHT) 
-            && maze->grid[nx][ny] == 0)
+        if ((nx >= 0 && nx < maze->width) && (ny >= 0 && ny < maze->height)
+            && maze->get_possible_moves(nx, ny) == 0)
         {
-            maze->grid[cx][cy] |= directions[i];
-            maze->grid[nx][ny] |= get_opposite(directions[i]);
+            maze->carve(cx, cy, directions[i]);
+            maze->carve(nx, ny, get_opposite(directions[i]));
             
             carve_passages_from(nx, ny);
         }
     }
 }
 
+/**
+ * @brief Same algorithm as `carve_passages_from`, but with an explicit
+ * stack, so maze size is not limited by the call stack. Each stack
+ * entry is the 2-bit index of the direction that led to a cell;
+ * backtracking walks the opposite way, so no coordinates are stored.
+ * The stack is a member, so repeated generation reuses its storage.
+ *
+ * @param[in] cx Starting x-coordinate.
+ * @param[in] cy Starting y-coordinate.
+ * @param[in] rng Random number generator to draw moves from.
+ */
+void RecursiveBacktracker::carve_passages_iteratively(int cx, int cy,
+    Xorshift &rng)
+{
+    static const int directions[] = {N, S, E, W};
+    vector<unsigned char> &stack = carve_stack;
+    size_t depth = 0;
+    int i, n, nx, ny, candidates[NUM_DIRECTIONS];
+
+    stack.clear();
+
+    while (true)
+    {
+        /* Collect the unvisited neighbors of the current cell. */
+        n = 0;
+        for (i = 0; i < NUM_DIRECTIONS; i++)
+        {
+            nx = cx + get_dx(directions[i]);
+            ny = cy + get_dy(directions[i]);
+
+            if ((nx >= 0 && nx < maze->width) &&
+                (ny >= 0 && ny < maze->height) &&
+                maze->get_possible_moves(nx, ny) == 0)
+            {
+                candidates[n++] = i;
+            }
+        }
+
+        if (n > 0)
+        {
+            i = candidates[rng.below(n)];
+            maze->carve(cx, cy, directions[i]);
+            cx += get_dx(directions[i]);
+            cy += get_dy(directions[i]);
+            maze->carve(cx, cy, get_opposite(directions[i]));
+
+            /* Push, four entries to a byte. */
+            if ((depth & 3) == 0)
+                stack.push_back(0);
+            stack[depth >> 2] |= i << ((depth & 3) << 1);
+            depth++;
+        }
+        else
+        {
+            if (depth == 0)
+                break;
+
+            /* Pop, and step back the way we came. */
+            depth--;
+            i = (stack[depth >> 2] >> ((depth & 3) << 1)) & 3;
+            stack[depth >> 2] &= ~(3 << ((depth & 3) << 1));
+            if ((depth & 3) == 0)
+                stack.pop_back();
+
+            cx -= get_dx(directions[i]);
+            cy -= get_dy(directions[i]);
+        }
+    }
+}
+
 /**
  * @brief Creates a maze beginning at the default starting cell.
  */
 void RecursiveBacktracker::create_maze()
+{
+    create_maze(rand());
+}
+
+/**
+ * @brief Creates a reproducible maze beginning at the default starting
+ * cell, without recursion.
+ *
+ * @param[in] seed Seed for the random number generator.
+ */
+void RecursiveBacktracker::create_maze(unsigned int seed)
+{
+    Xorshift rng(seed);
+
+    /* Reset the maze. */
+    maze->init();
+
+    carve_passages_iteratively(START_X, START_Y, rng);
+}
+
+/**
+ * @brief Resizes the maze and creates a reproducible one of the new
+ * size. The grid and the carving stack keep their storage, so a
+ * generator reused for many small mazes does not allocate.
+ *
+ * @param[in] seed Seed for the random number generator.
+ * @param[in] width Number of columns.
+ * @param[in] height Number of rows.
+ */
+void RecursiveBacktracker::create_maze(unsigned int seed, int width,
+    int height)
+{
+    Xorshift rng(seed);
+
+    maze->resize(width, height);
+
+    carve_passages_iteratively(START_X, START_Y, rng);
+}
+
+/**
+ * @brief Knocks down random interior walls of the current maze so it
+ * has loops and more than one route between cells.
+ *
+ * @param[in] count Number of walls to try removing.
+ * @param[in] seed Seed for the random number generator.
+ */
+void RecursiveBacktracker::open_walls(int count, unsigned int seed)
+{
+    static const int dirs[] = {S, E};
+    Xorshift rng(seed);
+    int width = maze->get_width(), height = maze->get_height();
+
+    for (int i = 0; i < count; i++)
+    {
+        int x = rng.below(width), y = rng.below(height);
+        int d = dirs[rng.below(2)];
+        int nx = x + get_dx(d), ny = y + get_dy(d);
+
+        if (nx >= width || ny >= height)
+            continue;
+
+        maze->carve(x, y, d);
+        maze->carve(nx, ny, get_opposite(d));
+    }
+}
+
+/**
+ * @brief Creates a maze with the original recursive algorithm. Only
+ * suitable for small mazes: it recurses once per cell.
+ */
+void RecursiveBacktracker::create_maze_recursive()
 {
     /* Reset the maze. */
     maze->init();
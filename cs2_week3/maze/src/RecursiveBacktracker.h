@@ -49,7 +49,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <vector>
 #include "MazeGrid.h"
+#include "Xorshift.h"
 
 using namespace std;
 
@@ -61,9 +63,14 @@ class RecursiveBacktracker
 {
 public:
     RecursiveBacktracker();
+    RecursiveBacktracker(int width, int height);
     ~RecursiveBacktracker();    
     
     void create_maze();
+    void create_maze(unsigned int seed);
+    void create_maze(unsigned int seed, int width, int height);
+    void create_maze_recursive();
+    void open_walls(int count, unsigned int seed);
     MazeGrid *get_maze();
     
 protected:
@@ -71,8 +78,10 @@ protected:
     
 private:
     MazeGrid *maze;
+    vector<unsigned char> carve_stack;
 
     void carve_passages_from(int cx, int cy);
+    void carve_passages_iteratively(int cx, int cy, Xorshift &rng);
     int get_dx(int d);
     int get_dy(int d);
     int get_opposite(int d);
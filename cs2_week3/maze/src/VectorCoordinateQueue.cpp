@@ -0,0 +1,229 @@
+/**
+ * @file VectorCoordinateQueue.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a vector-backed coordinate queue.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "VectorCoordinateQueue.h"
+
+/**
+ * @brief Initializes the queue.
+ *
+ * @param[in] app Accepted for compatibility with CoordinateQueue;
+ * this queue draws nothing.
+ */
+VectorCoordinateQueue::VectorCoordinateQueue(class MazeSolverApp *)
+{
+    head = 0;
+    chunk_used = QUEUE_ITEM_CHUNK;
+}
+
+
+/**
+ * @brief Deinitializes the queue, freeing every item it handed out.
+ */
+VectorCoordinateQueue::~VectorCoordinateQueue()
+{
+    for (size_t i = 0; i < item_chunks.size(); i++)
+    {
+        delete[] item_chunks[i];
+        delete[] coord_chunks[i];
+    }
+}
+
+
+/**
+ * @brief Enqueues an item by adding it to the bottom of the
+ * queue.
+ *
+ * @param[in] q Pointer to the item to be added.
+ */
+void VectorCoordinateQueue::enqueue(queueitem *q)
+{
+    q->next = NULL;
+    q->parent = NULL;
+
+    if (!is_empty())
+    {
+        q->parent = slots.back();
+        slots.back()->next = q;
+    }
+
+    slots.push_back(q);
+}
+
+
+/**
+ * @brief Dequeues and item by removing it from the top.
+ *
+ * @return Pointer to the dequeued item.
+ */
+queueitem *VectorCoordinateQueue::dequeue()
+{
+    if (is_empty())
+    {
+        printf("Invalid dequeue\n");
+        return NULL;
+    }
+
+    queueitem *q = slots[head++];
+
+    if (head == slots.size())
+    {
+        slots.clear();
+        head = 0;
+    }
+    else
+    {
+        slots[head]->parent = NULL;
+
+        /* Drop the dequeued prefix once it is half the array. */
+        if (head >= QUEUE_COMPACT_MIN && head * 2 >= slots.size())
+        {
+            slots.erase(slots.begin(), slots.begin() + head);
+            head = 0;
+        }
+    }
+
+    return q;
+}
+
+
+/**
+ * @brief Dequeues every item, recycling them.
+ */
+void VectorCoordinateQueue::dequeue_all()
+{
+    while (!is_empty())
+    {
+        recycle(dequeue());
+    }
+}
+
+
+/**
+ * @brief Returns the item at the front of the queue without
+ * removing it.
+ *
+ * @return Pointer to the first queue item.
+ */
+queueitem *VectorCoordinateQueue::peek()
+{
+    return is_empty() ? NULL : slots[head];
+}
+
+
+/**
+ * @brief Returns the item at the rear of the queue without
+ * removing it.
+ *
+ * @return Pointer to the last queue item.
+ */
+queueitem *VectorCoordinateQueue::peek_last()
+{
+    return is_empty() ? NULL : slots.back();
+}
+
+
+/**
+ * @brief Returns true is the queue is empty, false otherwise.
+ *
+ * @return Boolean indicating whether the queue is empty.
+ */
+bool VectorCoordinateQueue::is_empty()
+{
+    return head == slots.size();
+}
+
+
+/**
+ * @brief Returns an item holding (`x`, `y`) with no links, reusing a
+ * recycled one when possible. The item belongs to the queue: hand it
+ * back with `recycle` rather than deleting it.
+ *
+ * @param[in] x x-coordinate.
+ * @param[in] y y-coordinate.
+ *
+ * @return Pointer to the item.
+ */
+queueitem *VectorCoordinateQueue::new_item(int x, int y)
+{
+    queueitem *q;
+
+    if (!free_items.empty())
+    {
+        q = free_items.back();
+        free_items.pop_back();
+    }
+    else
+    {
+        if (chunk_used == QUEUE_ITEM_CHUNK)
+        {
+            item_chunks.push_back(new queueitem[QUEUE_ITEM_CHUNK]);
+            coord_chunks.push_back(new coordinate[QUEUE_ITEM_CHUNK]);
+            chunk_used = 0;
+        }
+
+        q = &item_chunks.back()[chunk_used];
+        q->c = &coord_chunks.back()[chunk_used];
+        chunk_used++;
+    }
+
+    q->c->x = x;
+    q->c->y = y;
+    q->next = NULL;
+    q->parent = NULL;
+    q->adder = NULL;
+
+    return q;
+}
+
+
+/**
+ * @brief Returns an item from `new_item` to the free list.
+ *
+ * @param[in] q Pointer to the item.
+ */
+void VectorCoordinateQueue::recycle(queueitem *q)
+{
+    free_items.push_back(q);
+}
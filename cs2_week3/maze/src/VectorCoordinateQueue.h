@@ -0,0 +1,94 @@
+/**
+ * @file VectorCoordinateQueue.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Definitions for a vector-backed coordinate queue.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __VECTORCOORDINATEQUEUE_H__
+#define __VECTORCOORDINATEQUEUE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include "structs.h"
+#include "CoordinateQueue.h"
+
+/* Items (and coordinates) carved out of the pool at a time. */
+#define QUEUE_ITEM_CHUNK    (4096)
+
+/* Dequeued slots tolerated at the front before they are compacted. */
+#define QUEUE_COMPACT_MIN   (4096)
+
+using namespace std;
+
+/**
+ * @brief Drop-in replacement for CoordinateQueue that keeps its item
+ * pointers in a growable array, and hands out items from a pooled free
+ * list instead of the heap. Items are still chained through `next`
+ * and `parent` as CoordinateQueue chains them.
+ */
+class VectorCoordinateQueue
+{
+public:
+    VectorCoordinateQueue(class MazeSolverApp *app = NULL);
+    ~VectorCoordinateQueue();
+
+    void enqueue(queueitem *q);
+    queueitem *dequeue();
+    queueitem *peek();
+    queueitem *peek_last();
+    void dequeue_all();
+    bool is_empty();
+
+    queueitem *new_item(int x, int y);
+    void recycle(queueitem *q);
+
+private:
+    vector<queueitem *> slots;
+    size_t head;
+    vector<queueitem *> free_items;
+    vector<queueitem *> item_chunks;
+    vector<coordinate *> coord_chunks;
+    int chunk_used;
+};
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ * @file VectorCoordinateStack.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a vector-backed coordinate stack.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include "VectorCoordinateStack.h"
+
+/**
+ * @brief Initializes the stack.
+ *
+ * @param[in] app Accepted for compatibility with CoordinateStack;
+ * this stack draws nothing.
+ */
+VectorCoordinateStack::VectorCoordinateStack(class MazeSolverApp *)
+{
+    chunk_used = STACK_ITEM_CHUNK;
+}
+
+
+/**
+ * @brief Deinitializes the stack, freeing every item it handed out.
+ */
+VectorCoordinateStack::~VectorCoordinateStack()
+{
+    for (size_t i = 0; i < item_chunks.size(); i++)
+    {
+        delete[] item_chunks[i];
+        delete[] coord_chunks[i];
+    }
+}
+
+
+/**
+ * @brief Pushes an item onto the stack.
+ *
+ * @param[in] s Pointer to the item to be added.
+ */
+void VectorCoordinateStack::push(stackitem *s)
+{
+    s->next = items.empty() ? NULL : items.back();
+    items.push_back(s);
+}
+
+
+/**
+ * @brief Pops an item off the stack.
+ *
+ * @return Pointer to the popped item.
+ */
+stackitem *VectorCoordinateStack::pop()
+{
+    if (items.empty())
+    {
+        printf("invalid pop\n");
+        return NULL;
+    }
+
+    stackitem *s = items.back();
+    items.pop_back();
+
+    return s;
+}
+
+
+/**
+ * @brief Returns the top item of the stack without removing it.
+ *
+ * @return Pointer to the first stack item.
+ */
+stackitem *VectorCoordinateStack::peek()
+{
+    return items.empty() ? NULL : items.back();
+}
+
+
+/**
+ * @brief Returns true if stack is empty, false otherwise.
+ *
+ * @return Boolean indicating whether the stack is empty.
+ */
+bool VectorCoordinateStack::is_empty()
+{
+    return items.empty();
+}
+
+
+/**
+ * @brief Returns an item holding (`x`, `y`), reusing a recycled one
+ * when possible. The item belongs to the stack: hand it back with
+ * `recycle` rather than deleting it.
+ *
+ * @param[in] x x-coordinate.
+ * @param[in] y y-coordinate.
+ *
+ * @return Pointer to the item.
+ */
+stackitem *VectorCoordinateStack::new_item(int x, int y)
+{
+    stackitem *s;
+
+    if (!free_items.empty())
+    {
+        s = free_items.back();
+        free_items.pop_back();
+    }
+    else
+    {
+        if (chunk_used == STACK_ITEM_CHUNK)
+        {
+            item_chunks.push_back(new stackitem[STACK_ITEM_CHUNK]);
+            coord_chunks.push_back(new coordinate[STACK_ITEM_CHUNK]);
+            chunk_used = 0;
+        }
+
+        s = &item_chunks.back()[chunk_used];
+        s->c = &coord_chunks.back()[chunk_used];
+        chunk_used++;
+    }
+
+    s->c->x = x;
+    s->c->y = y;
+    s->next = NULL;
+
+    return s;
+}
+
+
+/**
+ * @brief Returns an item from `new_item` to the free list.
+ *
+ * @param[in] s Pointer to the item.
+ */
+void VectorCoordinateStack::recycle(stackitem *s)
+{
+    free_items.push_back(s);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file Xorshift.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Small, fast, seedable pseudo-random number generator.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __XORSHIFT_H__
+#define __XORSHIFT_H__
+
+/**
+ * @brief Marsaglia's xorshift128 generator. Much faster than `rand()`,
+ * reproducible from a seed, and each instance has its own state, so
+ * separate generators never interfere.
+ */
+class Xorshift
+{
+public:
+    /**
+     * @brief Initializes the generator.
+     *
+     * @param[in] seed Any value; equal seeds give equal sequences.
+     */
+    Xorshift(unsigned int seed)
+    {
+        /* Spread the seed over the state with a multiplicative hash;
+         * the state must not be all zero. */
+        x = seed * 2654435761u + 1;
+        y = x * 2654435761u + 362436069;
+        z = y * 2654435761u + 521288629;
+        w = z * 2654435761u + 88675123;
+
+        for (int i = 0; i < 8; i++)
+            next();
+    }
+
+    /**
+     * @brief Returns the next 32-bit value.
+     */
+    unsigned int next()
+    {
+        unsigned int t = x ^ (x << 11);
+
+        x = y;
+        y = z;
+        z = w;
+        w = w ^ (w >> 19) ^ t ^ (t >> 8);
+
+        return w;
+    }
+
+    /**
+     * @brief Returns a value in [0, n).
+     */
+    unsigned int below(unsigned int n)
+    {
+        return next() % n;
+    }
+
+private:
+    unsigned int x, y, z, w;
+};
+
+#endif
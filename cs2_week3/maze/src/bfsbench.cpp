@@ -0,0 +1,113 @@
+/**
+ * @file bfsbench.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Thread scaling benchmark for the parallel breadth-first solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "RecursiveBacktracker.h"
+#include "FlatBreadthFirstSolver.h"
+#include "ParallelBreadthFirstSolver.h"
+
+
+/**
+ * @brief Solves `maze` corner to corner with the serial flat BFS and
+ * with the parallel BFS on 0..max worker threads.
+ */
+void bench(MazeGrid *maze, const char *name, int max)
+{
+    FlatBreadthFirstSolver flat;
+    size_t length;
+    double base;
+
+    flat.solve(maze);
+    length = flat.get_path().size();
+
+    printf("%s, %d x %d, path %lu cells\n", name, maze->get_width(),
+        maze->get_height(), (unsigned long) length);
+    printf("  %-12s %10.1f ms %10lu expanded\n", "flat bfs",
+        flat.get_solve_time() * 1e3, flat.get_nodes_expanded());
+
+    base = 0;
+
+    for (int t = 0; t <= max; t = t == 0 ? 1 : t * 2)
+    {
+        ParallelBreadthFirstSolver par(t);
+
+        par.solve(maze);
+
+        if (par.get_path().size() != length)
+            printf("ERROR: %d threads found a path of %lu cells\n", t,
+                (unsigned long) par.get_path().size());
+
+        if (t == 0)
+            base = par.get_solve_time();
+
+        printf("  %2d workers   %10.1f ms %10lu expanded %6lu bottom-up"
+            " levels %5.2fx\n", t, par.get_solve_time() * 1e3,
+            par.get_nodes_expanded(), par.get_bottom_up_levels(),
+            base / par.get_solve_time());
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int side = 4000, max = 8;
+
+    if (argc > 1)
+        side = atoi(argv[1]);
+    if (argc > 2)
+        max = atoi(argv[2]);
+
+    RecursiveBacktracker rb(side, side);
+
+    rb.create_maze(1u);
+    bench(rb.get_maze(), "perfect maze", max);
+
+    /* Opening walls gives the wide frontiers bottom-up levels target. */
+    rb.open_walls(side * side / 2, 2u);
+    bench(rb.get_maze(), "open maze", max);
+
+    return 0;
+}
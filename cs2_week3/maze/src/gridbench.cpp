@@ -0,0 +1,153 @@
+/**
+ * @file gridbench.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Memory and throughput comparison of maze grid layouts.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "MazeGrid.h"
+#include "MazeSolverBase.h"
+
+/* Random lookups per size, on top of one full row-major scan. */
+#define RANDOM_LOOKUPS      (20000000)
+
+
+/**
+ * @brief Gives the grid test access to the protected `carve`.
+ */
+class GridFiller : public MazeGrid
+{
+public:
+    GridFiller(int width, int height) : MazeGrid(width, height) { }
+
+    void fill(int *legacy)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int d = rand() & 0xF;
+                carve(x, y, d);
+                legacy[(size_t) x * height + y] = d;
+            }
+        }
+    }
+};
+
+
+void bench(int width, int height)
+{
+    size_t cells = (size_t) width * height;
+    int reps = 1 + 10000000 / cells;   /* so small grids are measurable */
+    int *legacy = new int[cells];
+    GridFiller grid(width, height);
+    unsigned int sum = 0, lsum = 0;
+    double start, t_packed, t_legacy, r_packed, r_legacy;
+    int x, y, r;
+
+    grid.fill(legacy);
+
+    /* Full scans, row-major. */
+    start = MazeSolverBase::wall_seconds();
+    for (r = 0; r < reps; r++)
+        for (y = 0; y < height; y++)
+            for (x = 0; x < width; x++)
+                sum += grid.get_possible_moves(x, y);
+    t_packed = (MazeSolverBase::wall_seconds() - start) / reps;
+
+    start = MazeSolverBase::wall_seconds();
+    for (r = 0; r < reps; r++)
+        for (y = 0; y < height; y++)
+            for (x = 0; x < width; x++)
+                lsum += legacy[(size_t) x * height + y];
+    t_legacy = (MazeSolverBase::wall_seconds() - start) / reps;
+
+    if (sum != lsum)
+        printf("ERROR: layouts disagree\n");
+
+    /* Random lookups, as a solver wandering the maze would do. */
+    srand(2);
+    start = MazeSolverBase::wall_seconds();
+    for (int i = 0; i < RANDOM_LOOKUPS; i++)
+        sum += grid.get_possible_moves(rand() % width, rand() % height);
+    r_packed = MazeSolverBase::wall_seconds() - start;
+
+    srand(2);
+    start = MazeSolverBase::wall_seconds();
+    for (int i = 0; i < RANDOM_LOOKUPS; i++)
+    {
+        x = rand() % width;
+        y = rand() % height;
+        lsum += legacy[(size_t) x * height + y];
+    }
+    r_legacy = MazeSolverBase::wall_seconds() - start;
+
+    printf("%6d x %-6d  int[]: %10.1f MB %8.0f Mcells/s %6.0f Mrand/s"
+        "   packed: %9.1f MB %8.0f Mcells/s %6.0f Mrand/s\n",
+        width, height, cells * sizeof(int) / 1048576.,
+        cells / t_legacy / 1e6, RANDOM_LOOKUPS / r_legacy / 1e6,
+        grid.get_memory_usage() / 1048576.,
+        cells / t_packed / 1e6, RANDOM_LOOKUPS / r_packed / 1e6);
+
+    /* Keep the sums live so the loops are not optimized away. */
+    if (sum == 1 && lsum == 1)
+        printf("\n");
+
+    delete[] legacy;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int max = 8192;
+
+    if (argc > 1)
+        max = atoi(argv[1]);
+
+    srand(1);
+    bench(WIDTH, HEIGHT);
+    for (int side = 1024; side <= max; side *= 2)
+        bench(side, side);
+
+    return 0;
+}
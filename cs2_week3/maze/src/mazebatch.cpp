@@ -0,0 +1,219 @@
+/**
+ * @file mazebatch.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Generates and solves a file of maze jobs.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BatchSolver.h"
+#include "Xorshift.h"
+
+
+/**
+ * @brief Reads a job file: one "seed width height sx sy gx gy" job per
+ * line; blank lines and lines starting with '#' are skipped.
+ *
+ * @return False (after printing the offending line) on a parse error.
+ */
+bool read_jobs(const char *filename, vector<batch_job> &jobs)
+{
+    FILE *f = fopen(filename, "r");
+    char line[256];
+    int number = 0;
+
+    if (f == NULL)
+    {
+        printf("could not read %s\n", filename);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        batch_job job;
+        char *p = line;
+
+        number++;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0')
+            continue;
+
+        if (sscanf(p, "%u %d %d %d %d %d %d", &job.seed, &job.width,
+            &job.height, &job.sx, &job.sy, &job.gx, &job.gy) != 7)
+        {
+            printf("%s:%d: expected seed width height sx sy gx gy\n",
+                filename, number);
+            fclose(f);
+            return false;
+        }
+
+        jobs.push_back(job);
+    }
+
+    fclose(f);
+    return true;
+}
+
+
+/**
+ * @brief Writes one line per job: the job, then the path length in
+ * cells (0 if unreachable, -1 if invalid), the cells expanded and the
+ * solve time in microseconds.
+ */
+bool write_results(const char *filename, const vector<batch_job> &jobs)
+{
+    FILE *f = fopen(filename, "w");
+
+    if (f == NULL)
+        return false;
+
+    fprintf(f, "# seed width height sx sy gx gy length expanded us\n");
+
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        const batch_job &j = jobs[i];
+
+        fprintf(f, "%u %d %d %d %d %d %d %ld %lu %.1f\n", j.seed, j.width,
+            j.height, j.sx, j.sy, j.gx, j.gy, j.length, j.expanded,
+            j.seconds * 1e6);
+    }
+
+    return fclose(f) == 0;
+}
+
+
+/**
+ * @brief Writes `count` random jobs with sides up to `side`, for
+ * trying the batch out.
+ */
+bool make_jobs(const char *filename, int count, int side, unsigned seed)
+{
+    FILE *f = fopen(filename, "w");
+    Xorshift rng(seed);
+
+    if (f == NULL)
+        return false;
+
+    for (int i = 0; i < count; i++)
+    {
+        int w = 2 + rng.below(side - 1), h = 2 + rng.below(side - 1);
+
+        fprintf(f, "%u %d %d %d %d %d %d\n", (unsigned) rng.next(), w, h,
+            rng.below(w), rng.below(h), rng.below(w), rng.below(h));
+    }
+
+    return fclose(f) == 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "-g") == 0 && argc > 3)
+    {
+        int side = argc > 4 ? atoi(argv[4]) : 64;
+
+        if (side < 2 || !make_jobs(argv[3], atoi(argv[2]), side,
+            argc > 5 ? strtoul(argv[5], NULL, 10) : 1u))
+        {
+            printf("could not write %s\n", argv[3]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (argc < 3)
+    {
+        printf("usage: %s <jobs> <results> [threads] [bfs|astar|bidir]\n"
+            "       %s -g <count> <jobs> [max side] [seed]\n",
+            argv[0], argv[0]);
+        return 1;
+    }
+
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    batch_solver_kind kind = BATCH_FLAT_BFS;
+    vector<batch_job> jobs;
+
+    if (argc > 4 && strcmp(argv[4], "astar") == 0)
+        kind = BATCH_ASTAR;
+    else if (argc > 4 && strcmp(argv[4], "bidir") == 0)
+        kind = BATCH_BIDIRECTIONAL;
+    else if (argc > 4 && strcmp(argv[4], "bfs") != 0)
+    {
+        printf("unknown solver %s\n", argv[4]);
+        return 1;
+    }
+
+    if (threads < 1)
+        threads = 1;
+
+    if (!read_jobs(argv[1], jobs))
+        return 1;
+
+    BatchSolver batch(threads - 1, kind);
+    double start = MazeSolverBase::wall_seconds();
+
+    batch.run(jobs);
+
+    double elapsed = MazeSolverBase::wall_seconds() - start;
+    size_t invalid = 0;
+
+    for (size_t i = 0; i < jobs.size(); i++)
+        if (jobs[i].length < 0)
+            invalid++;
+
+    if (!write_results(argv[2], jobs))
+    {
+        printf("could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("%lu jobs (%lu invalid) on %d threads: %.3f s, %.0f jobs/s,"
+        " %lu steals\n", (unsigned long) jobs.size(), (unsigned long) invalid,
+        threads, elapsed, elapsed > 0 ? jobs.size() / elapsed : 0.0,
+        batch.get_steals());
+
+    return 0;
+}
@@ -0,0 +1,387 @@
+/**
+ * @file mazebench.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Headless benchmark and check of every maze solver.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "RecursiveBacktracker.h"
+#include "DepthFirstSolver.h"
+#include "BreadthFirstSolver.h"
+#include "FlatBreadthFirstSolver.h"
+#include "AStarSolver.h"
+#include "BidirectionalSolver.h"
+#include "ParallelBreadthFirstSolver.h"
+#include "MazeOracle.h"
+#include "CorridorSolver.h"
+
+/* Bytes kept in front of each allocation to remember its size. */
+#define ALLOC_HEADER    (16)
+
+/* Seed for every maze, so runs are comparable. */
+#define MAZE_SEED       (2014u)
+
+/* Random cell pairs the oracle answers after its build. */
+#define ORACLE_QUERIES  (1000000)
+
+/**
+ * @brief A solver under test and a rough upper bound on the memory it
+ * needs per maze cell, used to skip it where it cannot fit.
+ */
+struct bench_solver
+{
+    const char *name;
+    double bytes_per_cell;
+};
+
+static const bench_solver solvers[] =
+{
+    {"dfs (linked)", 96},
+    {"dfs (vector)", 48},
+    {"bfs (linked)", 96},
+    {"bfs (vector)", 56},
+    {"flat bfs", 3},
+    {"a*", 7},
+    {"bidirectional", 8},
+    {"parallel bfs", 3.5},
+    {"oracle", 34},
+    {"corridor", 18},
+    {"corridor pruned", 8}
+};
+
+#define NUM_SOLVERS     (int) (sizeof(solvers) / sizeof(solvers[0]))
+
+/* Square maze sides run after the default 35 x 25 maze. */
+static const int sides[] = {256, 1024, 4096, 8192, 16384, 32768};
+
+#define NUM_SIDES       (int) (sizeof(sides) / sizeof(sides[0]))
+
+static unsigned long allocations = 0;
+static size_t live_bytes = 0, peak_bytes = 0;
+
+
+/*
+ * Global allocation hooks: count every heap allocation and track the
+ * live and peak number of bytes, so each solve can report both.
+ */
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+    char *p = (char *) malloc(size + ALLOC_HEADER);
+
+    if (p == NULL)
+        throw std::bad_alloc();
+
+    *(size_t *) p = size;
+    __sync_fetch_and_add(&allocations, 1);
+
+    size_t live = __sync_add_and_fetch(&live_bytes, size);
+    size_t peak = peak_bytes;
+
+    while (live > peak &&
+        !__sync_bool_compare_and_swap(&peak_bytes, peak, live))
+        peak = peak_bytes;
+
+    return p + ALLOC_HEADER;
+}
+
+
+void operator delete(void *ptr) throw()
+{
+    if (ptr == NULL)
+        return;
+
+    char *p = (char *) ptr - ALLOC_HEADER;
+
+    __sync_fetch_and_sub(&live_bytes, *(size_t *) p);
+    free(p);
+}
+
+
+void *operator new[](size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+
+
+void operator delete[](void *ptr) throw()
+{
+    operator delete(ptr);
+}
+
+
+/**
+ * @brief Creates solver number `i` of `solvers`.
+ */
+MazeSolverBase *make_solver(int i, int workers)
+{
+    switch (i)
+    {
+        case 0:
+            return (MazeSolverBase *) new LinkedDepthFirstSolver(NULL);
+
+        case 1:
+            return (MazeSolverBase *) new DepthFirstSolver(NULL);
+
+        case 2:
+            return (MazeSolverBase *) new LinkedBreadthFirstSolver(NULL);
+
+        case 3:
+            return (MazeSolverBase *) new BreadthFirstSolver(NULL);
+
+        case 4:
+            return new FlatBreadthFirstSolver();
+
+        case 5:
+            return new AStarSolver();
+
+        case 6:
+            return new BidirectionalSolver();
+
+        case 7:
+            return new ParallelBreadthFirstSolver(workers);
+
+        case 8:
+            return new MazeOracle();
+
+        default:
+        {
+            CorridorSolver *corridor = new CorridorSolver();
+            corridor->set_pruning(i == 10);
+            return corridor;
+        }
+    }
+}
+
+
+/**
+ * @brief Checks that `path` joins the top-left and bottom-right
+ * corners, in either order, through open walls without revisiting a
+ * cell. (The linked BreadthFirstSolver lists its path start first.)
+ */
+bool valid_path(MazeGrid *maze, const vector<coordinate> &path)
+{
+    int w = maze->get_width(), h = maze->get_height();
+    vector<bool> seen((size_t) w * h, false);
+
+    if (path.empty())
+        return false;
+
+    const coordinate &a = path[0], &b = path.back();
+
+    if (!(a.x == w - 1 && a.y == h - 1 && b.x == 0 && b.y == 0) &&
+        !(a.x == 0 && a.y == 0 && b.x == w - 1 && b.y == h - 1))
+        return false;
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        size_t idx = (size_t) path[i].y * w + path[i].x;
+
+        if (seen[idx])
+            return false;
+        seen[idx] = true;
+
+        if (i == 0)
+            continue;
+
+        int dx = path[i - 1].x - path[i].x, dy = path[i - 1].y - path[i].y;
+        int d = dx == 1 && dy == 0 ? E : dx == -1 && dy == 0 ? W :
+            dx == 0 && dy == 1 ? S : dx == 0 && dy == -1 ? N : 0;
+
+        if (!(maze->get_possible_moves(path[i].x, path[i].y) & d))
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Times random distance queries against a built oracle.
+ */
+void oracle_queries(MazeOracle *oracle, int width, int height)
+{
+    Xorshift rng(MAZE_SEED);
+    unsigned long sum = 0;
+    double start = MazeSolverBase::wall_seconds();
+
+    for (int i = 0; i < ORACLE_QUERIES; i++)
+    {
+        sum += oracle->distance(rng.below(width), rng.below(height),
+            rng.below(width), rng.below(height));
+    }
+
+    double t = MazeSolverBase::wall_seconds() - start;
+
+    printf("  %-14s %10.1f ms for %d distance queries (mean %.0f moves)\n",
+        "", t * 1e3, ORACLE_QUERIES, (double) sum / ORACLE_QUERIES);
+}
+
+
+/**
+ * @brief Prints how far a corridor graph shrank the maze, and times a
+ * search on the graph it already built against the flat BFS solve.
+ */
+void corridor_report(CorridorSolver *corridor, int width, int height,
+    double flat_time)
+{
+    double cells = (double) width * height;
+
+    printf("  %-14s %10lu nodes (%.1fx fewer than cells) %lu edges\n", "",
+        (unsigned long) corridor->get_node_count(),
+        cells / corridor->get_node_count(),
+        (unsigned long) corridor->get_edge_count());
+
+    corridor->search(0, 0, width - 1, height - 1);
+    printf("  %-14s %10.1f ms search on the built graph, %.1fx flat bfs\n",
+        "", corridor->get_solve_time() * 1e3,
+        flat_time / corridor->get_solve_time());
+}
+
+
+/**
+ * @brief Generates one seeded maze and runs every solver that fits in
+ * `budget` bytes on it.
+ *
+ * @return Number of solvers that returned a bad path.
+ */
+int bench(int width, int height, double budget, int workers)
+{
+    RecursiveBacktracker rb(width, height);
+    MazeGrid *maze = rb.get_maze();
+    double cells = (double) width * height;
+    size_t length = 0;
+    double flat_time = 0;
+    int failures = 0;
+    struct rusage usage;
+
+    /* The maze itself comes out of the budget. */
+    budget -= maze->get_memory_usage();
+
+    double start = MazeSolverBase::wall_seconds();
+    rb.create_maze(MAZE_SEED);
+
+    printf("%d x %d: %.1f MB maze generated in %.1f ms\n", width, height,
+        maze->get_memory_usage() / 1048576.,
+        (MazeSolverBase::wall_seconds() - start) * 1e3);
+
+    for (int i = 0; i < NUM_SOLVERS; i++)
+    {
+        if (cells * solvers[i].bytes_per_cell > budget)
+        {
+            printf("  %-14s skipped, needs about %.0f MB\n", solvers[i].name,
+                cells * solvers[i].bytes_per_cell / 1048576.);
+            continue;
+        }
+
+        unsigned long allocs = allocations;
+        size_t base = live_bytes;
+        peak_bytes = base;
+
+        MazeSolverBase *solver = make_solver(i, workers);
+        solver->solve(maze);
+        vector<coordinate> path = solver->get_path();
+
+        allocs = allocations - allocs;
+        double peak = (peak_bytes - base) / 1048576.;
+        bool ok = valid_path(maze, path);
+
+        /* A perfect maze has exactly one path, so all must agree. */
+        if (ok && length != 0 && path.size() != length)
+            ok = false;
+        if (ok)
+            length = path.size();
+        else
+            failures++;
+
+        printf("  %-14s %10.1f ms %11lu expanded %11lu allocs %9.1f MB"
+            " peak  %s\n", solvers[i].name, solver->get_solve_time() * 1e3,
+            solver->get_nodes_expanded(), allocs, peak,
+            ok ? "ok" : "BAD PATH");
+
+        if (i == 4)
+            flat_time = solver->get_solve_time();
+        if (i == 8)
+            oracle_queries((MazeOracle *) solver, width, height);
+        if (i >= 9)
+            corridor_report((CorridorSolver *) solver, width, height,
+                flat_time);
+
+        delete solver;
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+    printf("  path %lu cells, process peak RSS %.1f MB\n",
+        (unsigned long) length, usage.ru_maxrss / 1024.);
+
+    return failures;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int max = 32768;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    double phys = (double) sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    double budget = phys * 3 / 4;
+    int failures;
+
+    if (argc > 1)
+        max = atoi(argv[1]);
+    if (argc > 2)
+        budget = atof(argv[2]) * 1048576.;
+
+    printf("solver memory budget %.0f MB, %ld cpu(s)\n", budget / 1048576.,
+        cpus);
+
+    failures = bench(WIDTH, HEIGHT, budget, cpus - 1);
+
+    for (int i = 0; i < NUM_SIDES && sides[i] <= max; i++)
+        failures += bench(sides[i], sides[i], budget, cpus - 1);
+
+    printf("%d failure(s)\n", failures);
+
+    return failures == 0 ? 0 : 1;
+}
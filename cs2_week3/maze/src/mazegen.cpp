@@ -0,0 +1,96 @@
+/**
+ * @file mazegen.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Command-line maze generator.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "RecursiveBacktracker.h"
+#include "EllerGenerator.h"
+
+/**
+ * @brief Writes a seeded maze to a file. By default the maze is built
+ * in memory with the iterative backtracker; with --stream, rows are
+ * generated and written one at a time, so the maze may exceed memory.
+ */
+int main(int argc, char *argv[])
+{
+    if (argc < 5)
+    {
+        printf("usage: %s <width> <height> <seed> <file> [--stream]\n",
+            argv[0]);
+        return 1;
+    }
+
+    int width = atoi(argv[1]);
+    int height = atoi(argv[2]);
+    unsigned int seed = strtoul(argv[3], NULL, 10);
+    bool ok;
+
+    if (width <= 0 || height <= 0)
+    {
+        printf("invalid maze size\n");
+        return 1;
+    }
+
+    if (argc > 5 && strcmp(argv[5], "--stream") == 0)
+    {
+        EllerGenerator gen(width, height, seed);
+        ok = gen.write(argv[4]);
+    }
+    else
+    {
+        RecursiveBacktracker rb(width, height);
+        rb.create_maze(seed);
+        ok = rb.get_maze()->save(argv[4]);
+    }
+
+    if (!ok)
+    {
+        printf("could not write %s\n", argv[4]);
+        return 1;
+    }
+
+    return 0;
+}
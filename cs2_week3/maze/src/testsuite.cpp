@@ -45,7 +45,788 @@
 
 #include "CoordinateStack.h"
 #include "CoordinateQueue.h"
+#include "VectorCoordinateStack.h"
+#include "VectorCoordinateQueue.h"
+#include "RecursiveBacktracker.h"
+#include "EllerGenerator.h"
+#include "FlatBreadthFirstSolver.h"
+#include "AStarSolver.h"
+#include "BidirectionalSolver.h"
+#include "ParallelBreadthFirstSolver.h"
+#include "MazeOracle.h"
+#include "BatchSolver.h"
+#include "CorridorSolver.h"
 #include <stdio.h>
+#include <vector>
+
+/**
+ * @brief Checks that a maze is perfect: walls agree between
+ * neighbors, nothing opens off the edge, and every cell is reachable
+ * by exactly one path (connected, with cells - 1 passages).
+ *
+ * @return Number of failures.
+ */
+int check_perfect(MazeGrid *maze, const char *name)
+{
+    int w = maze->get_width(), h = maze->get_height();
+    size_t cells = (size_t) w * h, passages = 0, reached = 1, i;
+    vector<bool> seen(cells, false);
+    vector<int> todo;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            int m = maze->get_possible_moves(x, y);
+
+            if (((m & N) && (y == 0 || !(maze->get_possible_moves(x, y - 1) & S))) ||
+                ((m & W) && (x == 0 || !(maze->get_possible_moves(x - 1, y) & E))) ||
+                ((m & S) && y == h - 1) || ((m & E) && x == w - 1))
+            {
+                printf("FAIL: %s: bad walls at (%d, %d)\n", name, x, y);
+                return 1;
+            }
+
+            passages += ((m & S) != 0) + ((m & E) != 0);
+        }
+    }
+
+    seen[0] = true;
+    todo.push_back(0);
+    while (!todo.empty())
+    {
+        i = todo.back();
+        todo.pop_back();
+
+        int x = i % w, y = i / w;
+        int m = maze->get_possible_moves(x, y);
+        size_t next[4] = {i - w, i + w, i + 1, i - 1};
+        int dirs[4] = {N, S, E, W};
+
+        for (int d = 0; d < 4; d++)
+        {
+            if ((m & dirs[d]) && !seen[next[d]])
+            {
+                seen[next[d]] = true;
+                todo.push_back(next[d]);
+                reached++;
+            }
+        }
+    }
+
+    if (passages != cells - 1 || reached != cells)
+    {
+        printf("FAIL: %s: %lu passages, %lu of %lu cells reachable\n",
+            name, (unsigned long) passages, (unsigned long) reached,
+            (unsigned long) cells);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+int test_generators()
+{
+    int failures = 0;
+
+    RecursiveBacktracker small;
+    small.create_maze_recursive();
+    failures += check_perfect(small.get_maze(), "recursive");
+
+    small.create_maze(7);
+    failures += check_perfect(small.get_maze(), "iterative");
+
+    /* Deep enough that the recursive version would overflow. */
+    RecursiveBacktracker large(2000, 1500);
+    large.create_maze(7);
+    failures += check_perfect(large.get_maze(), "iterative 2000x1500");
+
+    /* The same seed must give the same maze. */
+    MazeGrid copy(2000, 1500);
+    large.get_maze()->save("/tmp/maze_test.bin");
+    large.create_maze(7);
+    copy.load("/tmp/maze_test.bin");
+    for (int y = 0; y < 1500; y += 7)
+    {
+        for (int x = 0; x < 2000; x += 3)
+        {
+            if (copy.get_possible_moves(x, y) !=
+                large.get_maze()->get_possible_moves(x, y))
+            {
+                printf("FAIL: seeded generation is not reproducible\n");
+                return failures + 1;
+            }
+        }
+    }
+
+    /* Odd width, so rows straddle bytes in the streamed file. */
+    EllerGenerator eller(301, 177, 7);
+    MazeGrid streamed(1, 1);
+    if (!eller.write("/tmp/maze_test.bin") ||
+        !streamed.load("/tmp/maze_test.bin"))
+    {
+        printf("FAIL: could not stream maze to file\n");
+        failures++;
+    }
+    else
+    {
+        failures += check_perfect(&streamed, "streamed 301x177");
+    }
+
+    /* Walls that open off the grid, or from one side only, are
+     * rejected. */
+    static const unsigned char off_grid[] = {N | N << 4, N | N << 4};
+    static const unsigned char one_sided[] = {E, 0};
+    const unsigned char *bad[] = {off_grid, one_sided};
+    for (int b = 0; b < 2; b++)
+    {
+        FILE *f = fopen("/tmp/maze_test.bin", "wb");
+        fprintf(f, "MAZE 4 1\n");
+        fwrite(bad[b], 1, 2, f);
+        fclose(f);
+        if (streamed.load("/tmp/maze_test.bin"))
+        {
+            printf("FAIL: loaded a maze with inconsistent walls\n");
+            failures++;
+        }
+    }
+
+    remove("/tmp/maze_test.bin");
+    return failures;
+}
+
+
+/**
+ * @brief Checks that `path` runs from the goal back to the start
+ * through open walls without revisiting a cell.
+ *
+ * @return Number of failures.
+ */
+int check_path(MazeGrid *maze, const vector<coordinate> &path, int sx,
+    int sy, int gx, int gy, const char *name)
+{
+    int w = maze->get_width();
+    vector<bool> seen((size_t) w * maze->get_height(), false);
+
+    if (path.empty() || path[0].x != gx || path[0].y != gy ||
+        path.back().x != sx || path.back().y != sy)
+    {
+        printf("FAIL: %s: path does not join start and goal\n", name);
+        return 1;
+    }
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        size_t idx = (size_t) path[i].y * w + path[i].x;
+
+        if (seen[idx])
+        {
+            printf("FAIL: %s: path revisits (%d, %d)\n", name, path[i].x,
+                path[i].y);
+            return 1;
+        }
+        seen[idx] = true;
+
+        if (i == 0)
+            continue;
+
+        int dx = path[i - 1].x - path[i].x, dy = path[i - 1].y - path[i].y;
+        int m = maze->get_possible_moves(path[i].x, path[i].y);
+        int d = dx == 1 && dy == 0 ? E : dx == -1 && dy == 0 ? W :
+            dx == 0 && dy == 1 ? S : dx == 0 && dy == -1 ? N : 0;
+
+        if (!(m & d))
+        {
+            printf("FAIL: %s: bad step at (%d, %d)\n", name, path[i].x,
+                path[i].y);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Checks that a solver refuses start and goal cells off the
+ * maze instead of indexing past its arrays.
+ *
+ * @return Number of failures.
+ */
+int check_off_maze(MazeSolverBase &solver, MazeGrid *maze, const char *name)
+{
+    int w = maze->get_width(), h = maze->get_height();
+    int bad[][4] = {
+        {0, 5 * h, w - 1, h - 1}, {0, 0, w, h - 1}, {-1, 0, w - 1, h - 1},
+        {0, 0, w - 1, -1}
+    };
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (solver.solve(maze, bad[i][0], bad[i][1], bad[i][2], bad[i][3]))
+        {
+            printf("FAIL: %s: solved from (%d, %d) to (%d, %d) on a %dx%d"
+                " maze\n", name, bad[i][0], bad[i][1], bad[i][2], bad[i][3],
+                w, h);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Solves between two cells with each headless solver, checks
+ * that every path is valid and as short as the breadth-first one, and
+ * prints what each search cost.
+ *
+ * @return Number of failures.
+ */
+int compare_solvers(MazeGrid *maze, int sx, int sy, int gx, int gy,
+    const char *name)
+{
+    FlatBreadthFirstSolver flat;
+    AStarSolver astar;
+    BidirectionalSolver bidir;
+    ParallelBreadthFirstSolver par(3);
+    CorridorSolver corridor, pruned;
+    const char *names[] = {"flat bfs", "a*", "bidirectional", "parallel bfs",
+        "corridor", "corridor (pruned)"};
+    bool found[6];
+    vector<coordinate> paths[6];
+    MazeSolverBase *solvers[] = {&flat, &astar, &bidir, &par, &corridor,
+        &pruned};
+    int failures = 0;
+
+    pruned.set_pruning(true);
+
+    found[0] = flat.solve(maze, sx, sy, gx, gy);
+    found[1] = astar.solve(maze, sx, sy, gx, gy);
+    found[2] = bidir.solve(maze, sx, sy, gx, gy);
+    found[3] = par.solve(maze, sx, sy, gx, gy);
+    found[4] = corridor.solve(maze, sx, sy, gx, gy);
+    found[5] = pruned.solve(maze, sx, sy, gx, gy);
+
+    for (int i = 0; i < 6; i++)
+    {
+        char label[128];
+        sprintf(label, "%s: %s", name, names[i]);
+
+        if (!found[i])
+        {
+            printf("FAIL: %s: goal unreachable\n", label);
+            failures++;
+            continue;
+        }
+
+        paths[i] = solvers[i]->get_path();
+        failures += check_path(maze, paths[i], sx, sy, gx, gy, label);
+
+        if (paths[i].size() != paths[0].size())
+        {
+            printf("FAIL: %s: path of %lu cells, bfs found %lu\n", label,
+                (unsigned long) paths[i].size(),
+                (unsigned long) paths[0].size());
+            failures++;
+        }
+
+        printf("%-40s %9lu expanded %8.3f ms\n", label,
+            solvers[i]->get_nodes_expanded(),
+            solvers[i]->get_solve_time() * 1e3);
+    }
+
+    return failures;
+}
+
+
+/**
+ * @brief Runs the headless solvers on generated mazes.
+ *
+ * @return Number of failures.
+ */
+int test_solvers()
+{
+    int failures = 0;
+    RecursiveBacktracker small, large(1000, 700), open(1000, 700);
+
+    small.create_maze(3u);
+    failures += compare_solvers(small.get_maze(), 0, 0, WIDTH - 1,
+        HEIGHT - 1, "35x25");
+
+    large.create_maze(11u);
+    failures += compare_solvers(large.get_maze(), 0, 0, 999, 699,
+        "1000x700");
+    failures += compare_solvers(large.get_maze(), 500, 350, 17, 640,
+        "1000x700 interior");
+    failures += compare_solvers(large.get_maze(), 40, 40, 40, 40,
+        "1000x700 start = goal");
+
+    /* Knock out a third of the walls so there are many routes. */
+    open.create_maze(5u);
+    open.open_walls(700000, 6u);
+    failures += compare_solvers(open.get_maze(), 0, 0, 999, 699,
+        "1000x700 open");
+    failures += compare_solvers(open.get_maze(), 120, 600, 870, 90,
+        "1000x700 open interior");
+
+    /*
+     * Maze frontiers are too thin to go bottom-up on their own, so
+     * force every level bottom-up on mazes small enough for that.
+     */
+    RecursiveBacktracker mid(200, 150);
+    FlatBreadthFirstSolver flat;
+    ParallelBreadthFirstSolver up(2);
+
+    up.set_switch_ratios((size_t) -1, (size_t) -1);
+    mid.create_maze(8u);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        flat.solve(mid.get_maze(), 3, 140, 190, 7);
+
+        if (!up.solve(mid.get_maze(), 3, 140, 190, 7))
+        {
+            printf("FAIL: bottom-up bfs: goal unreachable\n");
+            failures++;
+            break;
+        }
+
+        vector<coordinate> path = up.get_path();
+        failures += check_path(mid.get_maze(), path, 3, 140, 190, 7,
+            "bottom-up bfs");
+
+        if (path.size() != flat.get_path().size() ||
+            up.get_bottom_up_levels() == 0)
+        {
+            printf("FAIL: bottom-up bfs: %lu cells in %lu bottom-up levels\n",
+                (unsigned long) path.size(), up.get_bottom_up_levels());
+            failures++;
+        }
+
+        mid.open_walls(10000, 9u);
+    }
+
+    RecursiveBacktracker tiny(8, 8);
+
+    tiny.create_maze(2u);
+    failures += check_off_maze(flat, tiny.get_maze(), "flat bfs");
+
+    AStarSolver astar;
+    BidirectionalSolver bidir;
+
+    failures += check_off_maze(astar, tiny.get_maze(), "a*");
+    failures += check_off_maze(bidir, tiny.get_maze(), "bidirectional");
+    failures += check_off_maze(up, tiny.get_maze(), "bottom-up bfs");
+
+    /* Zero ratios are clamped to 1 rather than divided by. */
+    ParallelBreadthFirstSolver zero(2);
+
+    zero.set_switch_ratios(0, 0);
+    flat.solve(mid.get_maze(), 3, 140, 190, 7);
+    if (!zero.solve(mid.get_maze(), 3, 140, 190, 7) ||
+        zero.get_path().size() != flat.get_path().size())
+    {
+        printf("FAIL: bfs with zero switch ratios\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks the vector-backed containers against the order and
+ * links the linked ones give, and that recycled items are reused.
+ *
+ * @return Number of failures.
+ */
+int test_vector_containers()
+{
+    int failures = 0;
+    VectorCoordinateStack stack;
+    VectorCoordinateQueue queue;
+    stackitem *first = NULL;
+    queueitem *q;
+
+    for (int i = 0; i < 10000; i++)
+    {
+        stackitem *item = stack.new_item(i, -i);
+
+        if (i == 0)
+            first = item;
+        stack.push(item);
+    }
+
+    if (stack.peek()->next->c->x != 9998)
+    {
+        printf("FAIL: vector stack: items not chained through next\n");
+        failures++;
+    }
+
+    for (int i = 9999; i >= 0; i--)
+    {
+        stackitem *item = stack.pop();
+
+        if (item->c->x != i || item->c->y != -i)
+        {
+            printf("FAIL: vector stack: popped %d, expected %d\n",
+                item->c->x, i);
+            return failures + 1;
+        }
+
+        stack.recycle(item);
+    }
+
+    if (!stack.is_empty() || stack.peek() != NULL ||
+        stack.new_item(1, 1) != first)
+    {
+        printf("FAIL: vector stack: recycled items not reused\n");
+        failures++;
+    }
+
+    /* Interleave so the queue wraps through its compaction. */
+    int next_in = 0, next_out = 0;
+
+    for (int round = 0; round < 100; round++)
+    {
+        for (int i = 0; i < 300; i++, next_in++)
+            queue.enqueue(queue.new_item(next_in, 0));
+
+        for (int i = 0; i < 200; i++, next_out++)
+        {
+            q = queue.dequeue();
+
+            if (q->c->x != next_out)
+            {
+                printf("FAIL: vector queue: dequeued %d, expected %d\n",
+                    q->c->x, next_out);
+                return failures + 1;
+            }
+
+            queue.recycle(q);
+        }
+    }
+
+    if (queue.peek()->c->x != next_out || queue.peek()->parent != NULL ||
+        queue.peek_last()->c->x != next_in - 1 ||
+        queue.peek_last()->parent->c->x != next_in - 2)
+    {
+        printf("FAIL: vector queue: bad front or rear\n");
+        failures++;
+    }
+
+    queue.dequeue_all();
+
+    if (!queue.is_empty() || queue.peek() != NULL)
+    {
+        printf("FAIL: vector queue: not empty after dequeue_all\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+
+/**
+ * @brief Checks oracle distances and paths against breadth-first
+ * search, across a save and load, and that mazes with loops are
+ * refused.
+ *
+ * @return Number of failures.
+ */
+int test_oracle()
+{
+    int failures = 0;
+    RecursiveBacktracker rb(300, 200);
+    MazeGrid *maze = rb.get_maze();
+    MazeOracle oracle, loaded;
+    FlatBreadthFirstSolver flat;
+    Xorshift rng(12);
+
+    rb.create_maze(21u);
+
+    if (!oracle.build(maze) || !oracle.save("/tmp/maze_oracle.bin") ||
+        !loaded.load("/tmp/maze_oracle.bin", maze))
+    {
+        printf("FAIL: oracle: could not build, save or load\n");
+        remove("/tmp/maze_oracle.bin");
+        return 1;
+    }
+
+    remove("/tmp/maze_oracle.bin");
+
+    for (int i = 0; i < 100; i++)
+    {
+        int sx = rng.below(300), sy = rng.below(200);
+        int gx = rng.below(300), gy = rng.below(200);
+        size_t want;
+
+        flat.solve(maze, sx, sy, gx, gy);
+        want = flat.get_path().size() - 1;
+
+        if (oracle.distance(sx, sy, gx, gy) != want ||
+            loaded.distance(sx, sy, gx, gy) != want)
+        {
+            printf("FAIL: oracle: distance (%d, %d)-(%d, %d) is %u, bfs"
+                " says %lu\n", sx, sy, gx, gy,
+                oracle.distance(sx, sy, gx, gy), (unsigned long) want);
+            return failures + 1;
+        }
+
+        /* The loaded index must answer solve() without the rebuild. */
+        loaded.solve(maze, sx, sy, gx, gy);
+        failures += check_path(maze, loaded.get_path(), sx, sy, gx, gy,
+            "oracle");
+
+        if (loaded.get_path().size() != want + 1)
+        {
+            printf("FAIL: oracle: path of %lu cells, expected %lu\n",
+                (unsigned long) loaded.get_path().size(),
+                (unsigned long) want + 1);
+            failures++;
+        }
+    }
+
+    if (oracle.distance(300, 0, 0, 0) != UINT_MAX ||
+        oracle.find_path(0, 0, 0, -1))
+    {
+        printf("FAIL: oracle: answered for a cell outside the maze\n");
+        failures++;
+    }
+
+    /* A corrupt tour position must be refused on load. */
+    unsigned int bad = UINT_MAX;
+    oracle.save("/tmp/maze_oracle.bin");
+    FILE *f = fopen("/tmp/maze_oracle.bin", "r+b");
+    fseek(f, sizeof("ORACLE 300 200\n") - 1 + 5 * 300 * 200 + 4 * 7,
+        SEEK_SET);
+    fwrite(&bad, 4, 1, f);
+    fclose(f);
+    if (loaded.load("/tmp/maze_oracle.bin", maze))
+    {
+        printf("FAIL: oracle: loaded an index with a bad tour position\n");
+        failures++;
+    }
+    remove("/tmp/maze_oracle.bin");
+
+    /* Regenerating the maze in place, at the same size and larger,
+     * must not reuse the old index. */
+    for (int size = 0; size < 2; size++)
+    {
+        if (size == 0)
+            rb.create_maze(23u);
+        else
+            rb.create_maze(24u, 320, 240);
+
+        int gx = maze->get_width() - 1, gy = maze->get_height() - 1;
+
+        flat.solve(maze, 0, 0, gx, gy);
+        if (!oracle.solve(maze, 0, 0, gx, gy) ||
+            oracle.get_path().size() != flat.get_path().size())
+        {
+            printf("FAIL: oracle: stale index after regenerating\n");
+            return failures + 1;
+        }
+        failures += check_path(maze, oracle.get_path(), 0, 0, gx, gy,
+            "oracle after regenerating");
+    }
+
+    rb.open_walls(50, 22u);
+
+    if (oracle.build(maze))
+    {
+        printf("FAIL: oracle: indexed a maze with loops\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+
+/**
+ * @brief Runs a batch of mazes of mixed sizes on a single thread and on
+ * a pool, and checks every path length against a fresh generator and
+ * solver per job, so stale scratch from a larger earlier maze shows.
+ *
+ * @return Number of failures.
+ */
+int test_batch()
+{
+    int failures = 0;
+    vector<batch_job> jobs;
+    Xorshift rng(31);
+
+    for (int i = 0; i < 300; i++)
+    {
+        batch_job job;
+
+        job.seed = rng.next();
+        job.width = 1 + rng.below(60);
+        job.height = 1 + rng.below(60);
+        job.sx = rng.below(job.width);
+        job.sy = rng.below(job.height);
+        job.gx = rng.below(job.width);
+        job.gy = rng.below(job.height);
+        jobs.push_back(job);
+    }
+
+    /* An endpoint off the maze makes the job invalid. */
+    jobs[7].gx = jobs[7].width;
+
+    for (int threads = 0; threads <= 3; threads += 3)
+    {
+        BatchSolver batch(threads, threads ? BATCH_BIDIRECTIONAL :
+            BATCH_FLAT_BFS);
+
+        batch.run(jobs);
+
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            const batch_job &j = jobs[i];
+            long want = -1;
+
+            if (i != 7)
+            {
+                RecursiveBacktracker rb(j.width, j.height);
+                FlatBreadthFirstSolver flat;
+
+                rb.create_maze(j.seed);
+                flat.solve(rb.get_maze(), j.sx, j.sy, j.gx, j.gy);
+                want = flat.get_path().size();
+            }
+
+            if (j.length != want)
+            {
+                printf("FAIL: batch: %d workers, job %lu has a path of %ld"
+                    " cells, expected %ld\n", threads, (unsigned long) i,
+                    j.length, want);
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+
+/**
+ * @brief Checks corridor graph searches between random cells, on one
+ * graph per maze, against breadth-first search, and that the graph of
+ * a perfect maze is much smaller than the maze.
+ *
+ * @return Number of failures.
+ */
+int test_corridor()
+{
+    int failures = 0;
+    RecursiveBacktracker rb(120, 80);
+    MazeGrid *maze = rb.get_maze();
+    CorridorSolver corridor, pruned;
+    FlatBreadthFirstSolver flat;
+    Xorshift rng(41);
+
+    pruned.set_pruning(true);
+    rb.create_maze(42u);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (!corridor.build(maze))
+        {
+            printf("FAIL: corridor: could not build\n");
+            return failures + 1;
+        }
+
+        printf("%s: %lu nodes, %lu edges for %d cells\n",
+            pass ? "loops" : "perfect", (unsigned long)
+            corridor.get_node_count(), (unsigned long)
+            corridor.get_edge_count(), 120 * 80);
+
+        if (pass == 0 && corridor.get_node_count() * 2 > 120 * 80)
+        {
+            printf("FAIL: corridor: graph is not smaller than the maze\n");
+            failures++;
+        }
+
+        for (int i = 0; i < 200; i++)
+        {
+            int sx = rng.below(120), sy = rng.below(80);
+            int gx = rng.below(120), gy = rng.below(80);
+
+            /* Some pairs on the same or neighboring cells. */
+            if (i % 10 == 0)
+            {
+                gx = sx;
+                gy = sy < 79 ? sy + i % 3 : sy;
+            }
+
+            flat.solve(maze, sx, sy, gx, gy);
+
+            MazeSolverBase *solvers[] = {&corridor, &pruned};
+
+            for (int k = 0; k < 2; k++)
+            {
+                bool found = k == 0 ? corridor.search(sx, sy, gx, gy) :
+                    pruned.solve(maze, sx, sy, gx, gy);
+                vector<coordinate> path = solvers[k]->get_path();
+
+                if (!found || check_path(maze, path, sx, sy, gx, gy,
+                    k ? "corridor (pruned)" : "corridor") != 0 ||
+                    path.size() != flat.get_path().size())
+                {
+                    printf("FAIL: corridor: (%d, %d)-(%d, %d) got %lu"
+                        " cells, bfs found %lu\n", sx, sy, gx, gy,
+                        (unsigned long) path.size(),
+                        (unsigned long) flat.get_path().size());
+                    return failures + 1;
+                }
+            }
+        }
+
+        /* Dead-end filling leaves one corridor in a perfect maze. */
+        pruned.build(maze, 0, 0, 119, 79);
+        if (pass == 0 && pruned.get_node_count() != 2)
+        {
+            printf("FAIL: corridor: pruned perfect maze has %lu nodes\n",
+                (unsigned long) pruned.get_node_count());
+            failures++;
+        }
+
+        rb.open_walls(400, 43u);
+    }
+
+    /* solve must not reuse the graph once the maze is regenerated in
+     * place, at the same size or larger. */
+    corridor.solve(maze, 0, 0, 119, 79);
+    for (int size = 0; size < 2; size++)
+    {
+        if (size == 0)
+            rb.create_maze(44u);
+        else
+            rb.create_maze(45u, 150, 100);
+
+        int gx = maze->get_width() - 1, gy = maze->get_height() - 1;
+
+        flat.solve(maze, 0, 0, gx, gy);
+        if (!corridor.solve(maze, 0, 0, gx, gy) ||
+            corridor.get_path().size() != flat.get_path().size())
+        {
+            printf("FAIL: corridor: stale graph after regenerating\n");
+            return failures + 1;
+        }
+        failures += check_path(maze, corridor.get_path(), 0, 0, gx, gy,
+            "corridor after regenerating");
+    }
+
+    if (corridor.search(150, 0, 0, 0) || corridor.search(0, 0, 0, -1))
+    {
+        printf("FAIL: corridor: searched from a cell off the maze\n");
+        failures++;
+    }
+
+    return failures;
+}
+
 
 int main()
 {
@@ -92,5 +873,24 @@ int main()
     }
     queue.dequeue();
 
-    return 0;
+    printf("\nTesting the vector-backed stack and queue\n");
+    int failures = test_vector_containers();
+
+    printf("\nTesting the maze generators\n");
+    failures += test_generators();
+
+    printf("\nTesting the solvers\n");
+    failures += test_solvers();
+
+    printf("\nTesting the distance oracle\n");
+    failures += test_oracle();
+
+    printf("\nTesting the batch solver\n");
+    failures += test_batch();
+
+    printf("\nTesting the corridor graph\n");
+    failures += test_corridor();
+    printf("%d failure(s)\n", failures);
+
+    return failures == 0 ? 0 : 1;
 }
@@ -0,0 +1,363 @@
+/**
+ * @file ConcurrentQuadtree.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Functions for a read-mostly concurrent quadtree.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <sched.h>
+#include "ConcurrentQuadtree.h"
+
+
+/**
+ * @brief Copies points out of a snapshot into a caller-owned array,
+ * so they stay valid after the snapshot is retired.
+ */
+class CopyVisitor : public QueryVisitor
+{
+public:
+    CopyVisitor(coordinate *out, int max)
+    {
+        this->out = out;
+        this->max = max;
+        this->count = 0;
+    }
+
+    bool VisitPoint(coordinate *c)
+    {
+        if (count >= max)
+            return false;
+
+        out[count++] = *c;
+        return count < max;
+    }
+
+    coordinate *out;
+    int max, count;
+};
+
+
+/**
+ * @brief Initializes the tree and starts its worker pool.
+ *
+ * @param worldsize Length of a side of the world square.
+ *
+ * @param nthreads Number of worker threads used by `QueryBatch`, in
+ * addition to the calling thread.
+ */
+ConcurrentQuadtree::ConcurrentQuadtree(float worldsize, int nthreads)
+{
+    this->worldsize = worldsize;
+    current = new Quadtree(worldsize);
+    epoch = 0;
+    readers[0] = 0;
+    readers[1] = 0;
+    snapshot_size = 0;
+
+    this->nthreads = nthreads;
+    stopping = false;
+    workers = new Thread[nthreads];
+
+    for (int i = 0; i < nthreads; i++)
+        workers[i].run(pool_worker, (void *) this);
+}
+
+
+/**
+ * @brief Stops the worker pool and frees the snapshot and any points
+ * still waiting in the delta buffer.
+ */
+ConcurrentQuadtree::~ConcurrentQuadtree()
+{
+    stopping = true;
+
+    for (int i = 0; i < nthreads; i++)
+        start.inc();
+
+    for (int i = 0; i < nthreads; i++)
+        workers[i].join();
+
+    delete[] workers;
+
+    for (unsigned int i = 0; i < delta.size(); i++)
+        delete delta[i];
+
+    delete current;
+}
+
+
+/**
+ * @brief Registers the calling thread as a reader of the current
+ * snapshot. Never blocks.
+ *
+ * @return The reader slot to pass to `ReadUnlock`.
+ */
+int ConcurrentQuadtree::ReadLock()
+{
+    int parity = epoch & 1;
+
+    __sync_fetch_and_add(&readers[parity], 1);
+    return parity;
+}
+
+
+/**
+ * @brief Unregisters a reader.
+ *
+ * @param parity The slot returned by `ReadLock`.
+ */
+void ConcurrentQuadtree::ReadUnlock(int parity)
+{
+    __sync_fetch_and_sub(&readers[parity], 1);
+}
+
+
+/**
+ * @brief Waits until every reader that registered before the call has
+ * finished. New readers are steered to the other slot by flipping the
+ * epoch, so a steady stream of queries cannot starve the writer. Two
+ * flips are needed because a reader may have read the epoch just
+ * before the first one.
+ */
+void ConcurrentQuadtree::Synchronize()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        int parity = epoch & 1;
+
+        __sync_fetch_and_add(&epoch, 1);
+
+        while (readers[parity] != 0)
+            sched_yield();
+    }
+}
+
+
+/**
+ * @brief Buffers a point for the next merge. The tree takes ownership
+ * of the point. Merges automatically once enough points are waiting
+ * (see `MERGE_THRESHOLD`).
+ *
+ * @param c The point to insert.
+ */
+void ConcurrentQuadtree::Insert(coordinate *c)
+{
+    bool full;
+
+    writer.lock();
+    delta.push_back(c);
+    full = delta.size() >= MERGE_THRESHOLD &&
+        delta.size() >= snapshot_size / MERGE_FRACTION;
+    writer.unlock();
+
+    if (full)
+        Merge();
+}
+
+
+/**
+ * @brief Builds a new snapshot from the current one plus the delta
+ * buffer, publishes it, and frees the old snapshot once no reader can
+ * still be using it.
+ */
+void ConcurrentQuadtree::Merge()
+{
+    writer.lock();
+
+    if (delta.empty())
+    {
+        writer.unlock();
+        return;
+    }
+
+    /* Only the writer replaces snapshots, so `old` is stable here. */
+    Quadtree *old = current;
+    Quadtree *fresh = new Quadtree(worldsize);
+    vector<coordinate*> points = old->ListPoints();
+
+    for (unsigned int i = 0; i < points.size(); i++)
+        fresh->Insert(new coordinate(points[i]));
+
+    for (unsigned int i = 0; i < delta.size(); i++)
+        fresh->Insert(delta[i]);
+
+    snapshot_size = points.size() + delta.size();
+    delta.clear();
+
+    __sync_synchronize();
+    current = fresh;
+    __sync_synchronize();
+
+    Synchronize();
+    delete old;
+
+    writer.unlock();
+}
+
+
+/**
+ * @brief Runs a visitor over the current snapshot without locking.
+ * Point pointers handed to the visitor are only valid during the call.
+ *
+ * @param r The query region.
+ *
+ * @param v The visitor; returning false from it ends the query.
+ *
+ * @return False if the visitor stopped the query early, true otherwise.
+ */
+bool ConcurrentQuadtree::Visit(const region &r, QueryVisitor *v)
+{
+    int parity = ReadLock();
+    bool ret = current->Visit(r, v);
+    ReadUnlock(parity);
+
+    return ret;
+}
+
+
+/**
+ * @brief Copies up to `max` points inside `r` into `out`.
+ *
+ * @param r The query region.
+ *
+ * @param out Caller-owned array with room for `max` points.
+ *
+ * @param max Capacity of `out`.
+ *
+ * @return The number of points written.
+ */
+int ConcurrentQuadtree::QueryPoints(const region &r, coordinate *out,
+    int max)
+{
+    CopyVisitor v(out, max);
+
+    if (max > 0)
+        Visit(r, &v);
+
+    return v.count;
+}
+
+
+/**
+ * @brief Runs `QueryPoints` for every region in `r`, spreading the
+ * work across the worker pool and the calling thread.
+ *
+ * @param r Array of `n` query regions.
+ *
+ * @param n Number of regions.
+ *
+ * @param out Caller-owned array of `n * max` points; results for
+ * `r[i]` start at `out[i * max]`.
+ *
+ * @param max Maximum number of points returned per region.
+ *
+ * @param counts Caller-owned array of `n` result counts.
+ */
+void ConcurrentQuadtree::QueryBatch(const region *r, int n,
+    coordinate *out, int max, int *counts)
+{
+    batch_lock.lock();
+
+    job.regions = r;
+    job.n = n;
+    job.out = out;
+    job.max = max;
+    job.counts = counts;
+    job.next = 0;
+    __sync_synchronize();
+
+    for (int i = 0; i < nthreads; i++)
+        start.inc();
+
+    RunJob();
+
+    for (int i = 0; i < nthreads; i++)
+        done.dec();
+
+    batch_lock.unlock();
+}
+
+
+/**
+ * @brief Claims chunks of the current batch until none are left.
+ */
+void ConcurrentQuadtree::RunJob()
+{
+    while (true)
+    {
+        int first = __sync_fetch_and_add(&job.next, BATCH_CHUNK);
+
+        if (first >= job.n)
+            break;
+
+        int last = first + BATCH_CHUNK < job.n ? first + BATCH_CHUNK : job.n;
+
+        for (int i = first; i < last; i++)
+        {
+            job.counts[i] = QueryPoints(job.regions[i],
+                job.out + i * job.max, job.max);
+        }
+    }
+}
+
+
+/**
+ * @brief Worker thread body: runs batches until the tree is destroyed.
+ *
+ * @param arg The owning `ConcurrentQuadtree`.
+ */
+void *pool_worker(void *arg)
+{
+    ConcurrentQuadtree *tree = (ConcurrentQuadtree *) arg;
+
+    while (true)
+    {
+        tree->start.dec();
+
+        if (tree->stopping)
+            break;
+
+        tree->RunJob();
+        tree->done.inc();
+    }
+
+    return NULL;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file ConcurrentQuadtree.h
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Definitions for a read-mostly concurrent quadtree.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#ifndef __CONCURRENTQUADTREE_H__
+#define __CONCURRENTQUADTREE_H__
+
+#include <vector>
+#include <stdlib.h>
+#include "Quadtree.h"
+#include "Thread.h"
+#include "structs.h"
+
+/* Buffered inserts that trigger an automatic merge. The delta must
+ * also reach 1/MERGE_FRACTION of the snapshot, so that a bulk load
+ * costs a constant number of rebuilds per point. */
+#define MERGE_THRESHOLD     (4096)
+#define MERGE_FRACTION      (4)
+
+/* Queries a worker claims at a time during a batch. */
+#define BATCH_CHUNK         (64)
+
+using namespace std;
+
+/**
+ * @brief The batch a worker pool is currently running.
+ */
+struct batch_job
+{
+    const region *regions;
+    int n;
+    coordinate *out;
+    int max;
+    int *counts;
+    volatile int next;
+};
+
+/**
+ * @brief A quadtree that many threads can query while one writer
+ * inserts.
+ *
+ * Queries run without locks against an immutable snapshot. Inserts
+ * collect in a delta buffer that `Merge` folds into a fresh snapshot,
+ * which is then published by swapping a pointer; the old snapshot is
+ * freed once every reader that might still see it has finished
+ * (RCU-style). Inserted points only become visible after a merge.
+ */
+class ConcurrentQuadtree
+{
+public:
+    ConcurrentQuadtree(float worldsize, int nthreads);
+    ~ConcurrentQuadtree();
+
+    void Insert(coordinate *c);
+    void Merge();
+    bool Visit(const region &r, QueryVisitor *v);
+    int QueryPoints(const region &r, coordinate *out, int max);
+    void QueryBatch(const region *r, int n, coordinate *out, int max,
+        int *counts);
+
+    friend void *pool_worker(void *arg);
+
+private:
+    float worldsize;
+
+    /* Snapshot and reader bookkeeping. */
+    Quadtree *volatile current;
+    volatile int epoch;
+    volatile int readers[2];
+
+    /* Writer state, guarded by `writer`. */
+    Mutex writer;
+    vector<coordinate*> delta;
+    unsigned int snapshot_size;
+
+    /* Worker pool. */
+    int nthreads;
+    Thread *workers;
+    Semaphore start, done;
+    Mutex batch_lock;
+    batch_job job;
+    volatile bool stopping;
+
+    int ReadLock();
+    void ReadUnlock(int parity);
+    void Synchronize();
+    void RunJob();
+};
+
+void *pool_worker(void *arg);
+
+#endif
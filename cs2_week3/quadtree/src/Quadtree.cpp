@@ -46,6 +46,34 @@
 #include "Quadtree.h"
 
 
+/**
+ * @brief Copies points into a caller-supplied array, stopping once
+ * the array is full.
+ */
+class SpanVisitor : public QueryVisitor
+{
+public:
+    SpanVisitor(coordinate **out, int max)
+    {
+        this->out = out;
+        this->max = max;
+        this->count = 0;
+    }
+
+    bool VisitPoint(coordinate *c)
+    {
+        if (count >= max)
+            return false;
+
+        out[count++] = c;
+        return count < max;
+    }
+
+    coordinate **out;
+    int max, count;
+};
+
+
 /**
  * @brief Initializes the quadtree.
  */
@@ -66,45 +94,85 @@ Quadtree::~Quadtree()
 
 
 /**
- * @brief Inserts a point into the tree. HINT: If implemented
- * recursively, this function is quite short.
+ * @brief Inserts a point into the tree. The tree takes ownership of
+ * the point; points outside the world are discarded.
  */
 void Quadtree::Insert(coordinate *c)
 {
+    if (c->x < 0 || c->y < 0 || c->x > worldsize || c->y > worldsize)
+    {
+        delete c;
+        return;
+    }
+
+    root->Insert(c);
+}
+
+
+/**
+ * @brief Removes a point from the tree and deletes it.
+ *
+ * @param c The point to remove; must be a pointer held by the tree.
+ *
+ * @return True if the point was found.
+ */
+bool Quadtree::Remove(coordinate *c)
+{
+    if (!root->Remove(c))
+        return false;
+
+    delete c;
+    return true;
+}
+
+
+/**
+ * @brief Moves a point held by the tree to (x, y). Moves that leave
+ * the world are rejected.
+ *
+ * @param c The point to move; must be a pointer held by the tree.
+ *
+ * @param x The new x-coordinate.
+ *
+ * @param y The new y-coordinate.
+ *
+ * @return True if the point was found and moved.
+ */
+bool Quadtree::Move(coordinate *c, float x, float y)
+{
+    if (x < 0 || y < 0 || x > worldsize || y > worldsize)
+        return false;
 
+    return root->Move(c, x, y);
 }
 
 
 /**
  * @brief Gets the list of all rectangles associated with this quadtree.
- * HINT: If implemented recursively, this function is quite short.
  *
  * @return A `std::vector` containing all rectangles in the tree.
  */
 vector<rect*> Quadtree::ListRectangles()
 {
-    vector<rect*> ret;
-    return ret;
+    return root->ListRectangles();
 }
 
 
 /**
- * @brief Gets the list of all points stored in this quadtree. HINT:
- * If implemented recursively, this function is quite short.
+ * @brief Gets the list of all points stored in this quadtree.
  *
  * @return A `std::vector` containing all points in the tree.
  */
 vector<coordinate*> Quadtree::ListPoints()
 {
-    vector<coordinate*> ret;
-    return ret;
+    return root->ListPoints();
 }
 
 
 /**
  * @brief Queries the quadtree for all points and rectangles that
  * intersect a square region centered on `center` of radius `radius`.
- * HINT: If implemented recursively, this function is quite short.
+ * Allocates its result; prefer `Visit` or `QueryPoints` on hot paths.
  *
  * @param center The center of the query region.
  *
@@ -114,10 +182,134 @@ vector<coordinate*> Quadtree::ListPoints()
  */
 query *Quadtree::Query(coordinate *center, float radius)
 {
-    vector<coordinate*> points;
-    vector<rect*> boxes;
-    
-    query *q = new query(points, boxes);
-    
-    return q;
+    return root->Query(center, radius);
+}
+
+
+/**
+ * @brief Hands every point inside `r` (and every leaf box that
+ * intersects it) to `v`, without allocating.
+ *
+ * @param r The query region; rectangular or circular.
+ *
+ * @param v The visitor; returning false from it ends the query.
+ *
+ * @return False if the visitor stopped the query early, true otherwise.
+ */
+bool Quadtree::Visit(const region &r, QueryVisitor *v)
+{
+    return root->Visit(r, v);
+}
+
+
+/**
+ * @brief Writes up to `max` points inside `r` into `out`, without
+ * allocating. The query stops as soon as `out` is full.
+ *
+ * @param r The query region; rectangular or circular.
+ *
+ * @param out Caller-owned array with room for `max` pointers.
+ *
+ * @param max Capacity of `out`.
+ *
+ * @return The number of points written.
+ */
+int Quadtree::QueryPoints(const region &r, coordinate **out, int max)
+{
+    SpanVisitor v(out, max);
+
+    if (max > 0)
+        root->Visit(r, &v);
+
+    return v.count;
+}
+
+
+/**
+ * @brief Finds the `k` points nearest to `c`.
+ *
+ * @param c The query point.
+ *
+ * @param k Number of neighbors wanted.
+ *
+ * @param out Caller-owned array with room for `k` results, sorted
+ * nearest first on return.
+ *
+ * @return The number of neighbors found.
+ */
+int Quadtree::Nearest(coordinate *c, int k, neighbor *out)
+{
+    vector<node_entry> frontier;
+
+    return root->Nearest(c, k, out, frontier);
+}
+
+
+/**
+ * @brief Runs `Nearest` for many query points, sharing one search
+ * frontier between them.
+ *
+ * @param c Array of `n` query points.
+ *
+ * @param n Number of query points.
+ *
+ * @param k Number of neighbors wanted per query.
+ *
+ * @param out Caller-owned array of `n * k` results; the neighbors of
+ * `c[i]` start at `out[i * k]`.
+ *
+ * @param counts Caller-owned array of `n` result counts.
+ */
+void Quadtree::NearestBatch(coordinate **c, int n, int k, neighbor *out,
+    int *counts)
+{
+    vector<node_entry> frontier;
+
+    for (int i = 0; i < n; i++)
+        counts[i] = root->Nearest(c[i], k, out + i * k, frontier);
+}
+
+
+/**
+ * @brief Runs the upward pass that gives every node its point count
+ * and center of mass. Call before `Forces`, and again after any
+ * insert, move or removal.
+ */
+void Quadtree::ComputeMass()
+{
+    root->ComputeMass();
+}
+
+
+/**
+ * @brief Approximates the total attraction on each of `c[0..n)` from
+ * every point in the tree with the Barnes-Hut method, in O(log n) per
+ * point. Points are unit masses under a softened inverse-square law.
+ *
+ * @param c Array of `n` points to evaluate; these may be points held
+ * by the tree, which then do not attract themselves.
+ *
+ * @param n Number of points.
+ *
+ * @param theta Opening angle; 0 gives the exact sum, larger values
+ * are faster and less accurate (0.5 is typical).
+ *
+ * @param softening Softening length, which keeps close pairs finite.
+ *
+ * @param fx Caller-owned array of `n` x-components.
+ *
+ * @param fy Caller-owned array of `n` y-components.
+ */
+void Quadtree::Forces(coordinate **c, int n, float theta, float softening,
+    float *fx, float *fy)
+{
+    float theta2 = theta * theta;
+    float eps2 = softening * softening;
+
+    for (int i = 0; i < n; i++)
+    {
+        fx[i] = 0;
+        fy[i] = 0;
+        root->Force(c[i], theta2, eps2, &fx[i], &fy[i]);
+    }
 }
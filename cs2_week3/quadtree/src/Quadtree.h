@@ -63,9 +63,19 @@ public:
     ~Quadtree();
 
     void Insert(coordinate *c);
+    bool Remove(coordinate *c);
+    bool Move(coordinate *c, float x, float y);
     vector<rect*> ListRectangles();
     vector<coordinate*> ListPoints();
     query *Query(coordinate *center, float radius);
+    bool Visit(const region &r, QueryVisitor *v);
+    int QueryPoints(const region &r, coordinate **out, int max);
+    int Nearest(coordinate *c, int k, neighbor *out);
+    void NearestBatch(coordinate **c, int n, int k, neighbor *out,
+        int *counts);
+    void ComputeMass();
+    void Forces(coordinate **c, int n, float theta, float softening,
+        float *fx, float *fy);
 
 private:
     float worldsize;
@@ -43,9 +43,34 @@
  * 
  */
 
+#include <algorithm>
+#include <math.h>
 #include "QuadtreeNode.h"
 
 
+/**
+ * @brief Collects the results of a `Query` call into vectors.
+ */
+class CollectVisitor : public QueryVisitor
+{
+public:
+    vector<coordinate*> points;
+    vector<rect*> boxes;
+
+    bool VisitPoint(coordinate *c)
+    {
+        points.push_back(c);
+        return true;
+    }
+
+    bool VisitBox(rect *r)
+    {
+        boxes.push_back(r);
+        return true;
+    }
+};
+
+
 /**
  * @brief Initializes the quadtree node.
  *
@@ -61,14 +86,31 @@ QuadtreeNode::QuadtreeNode(float size, coordinate *ul)
 
     coordinate *br = new coordinate(ul->x + size, ul->y + size);
     this->box = new rect(ul, br);
+
+    for (int i = 0; i < 4; i++)
+        children[i] = NULL;
+
+    count = 0;
+    comx = 0;
+    comy = 0;
 }
 
 
 /**
- * @brief Deinitializes a quadtree node.
+ * @brief Deinitializes a quadtree node, along with its children and
+ * all points stored in them.
  */
 QuadtreeNode::~QuadtreeNode()
 {
+    for (int i = 0; i < 4; i++)
+    {
+        if (children[i])
+            delete children[i];
+    }
+
+    for (unsigned int i = 0; i < points.size(); i++)
+        delete points[i];
+
     if (box)
     {
         delete box->ul;
@@ -90,13 +132,232 @@ rect *QuadtreeNode::NodeRect()
 
 
 /**
- * @brief Inserts a point into the quadtree.
+ * @brief Returns true if this node has not been subdivided.
+ *
+ * @return Boolean indicating whether this node is a leaf.
+ */
+bool QuadtreeNode::IsLeaf()
+{
+    return children[0] == NULL;
+}
+
+
+/**
+ * @brief Returns the index of the child quadrant containing `c`:
+ * bit 0 is set for the right half, bit 1 for the bottom half.
+ *
+ * @param c The point to locate.
+ *
+ * @return A child index in [0, 3].
+ */
+int QuadtreeNode::ChildIndex(coordinate *c)
+{
+    float half = size / 2;
+
+    return (c->x >= box->ul->x + half ? 1 : 0) |
+        (c->y >= box->ul->y + half ? 2 : 0);
+}
+
+
+/**
+ * @brief Returns the squared distance from `c` to the closest point
+ * of this node's box (zero if `c` is inside it).
+ *
+ * @param c The query point.
+ *
+ * @return The squared distance.
+ */
+float QuadtreeNode::MinDist2(coordinate *c)
+{
+    float dx = 0, dy = 0;
+
+    if (c->x < box->ul->x)
+        dx = box->ul->x - c->x;
+    else if (c->x > box->br->x)
+        dx = c->x - box->br->x;
+
+    if (c->y < box->ul->y)
+        dy = box->ul->y - c->y;
+    else if (c->y > box->br->y)
+        dy = c->y - box->br->y;
+
+    return dx * dx + dy * dy;
+}
+
+
+/**
+ * @brief Heap ordering for frontier entries; the closest box is on top.
+ */
+static bool farther_node(const node_entry &a, const node_entry &b)
+{
+    return a.dist2 > b.dist2;
+}
+
+
+/**
+ * @brief Heap ordering for results; the farthest point is on top.
+ */
+static bool closer_neighbor(const neighbor &a, const neighbor &b)
+{
+    return a.dist2 < b.dist2;
+}
+
+
+/**
+ * @brief Splits this leaf into four children and pushes its points
+ * down into them.
+ */
+void QuadtreeNode::Subdivide()
+{
+    float half = size / 2;
+
+    for (int i = 0; i < 4; i++)
+    {
+        children[i] = new QuadtreeNode(half, new coordinate(
+            box->ul->x + ((i & 1) ? half : 0),
+            box->ul->y + ((i & 2) ? half : 0)));
+    }
+
+    for (unsigned int i = 0; i < points.size(); i++)
+        children[ChildIndex(points[i])]->Insert(points[i]);
+
+    points.clear();
+}
+
+
+/**
+ * @brief Inserts a point into the quadtree. The tree takes ownership
+ * of the point.
  *
  * @param c The point to insert.
  */
 void QuadtreeNode::Insert(coordinate *c)
 {
-    
+    if (!IsLeaf())
+    {
+        children[ChildIndex(c)]->Insert(c);
+        return;
+    }
+
+    points.push_back(c);
+
+    if (points.size() > NODE_CAPACITY && size > MIN_NODE_SIZE)
+        Subdivide();
+}
+
+
+/**
+ * @brief Merges the children back into this node if, between them,
+ * they hold no more points than a single leaf may.
+ */
+void QuadtreeNode::Collapse()
+{
+    unsigned int total = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (!children[i]->IsLeaf())
+            return;
+
+        total += children[i]->points.size();
+    }
+
+    if (total > NODE_CAPACITY)
+        return;
+
+    for (int i = 0; i < 4; i++)
+    {
+        points.insert(points.end(), children[i]->points.begin(),
+            children[i]->points.end());
+
+        /* The points now belong to this node. */
+        children[i]->points.clear();
+        delete children[i];
+        children[i] = NULL;
+    }
+}
+
+
+/**
+ * @brief Removes a point from the quadtree without deleting it, and
+ * collapses any nodes left underfull.
+ *
+ * @param c The point to remove; must be the pointer that was inserted.
+ *
+ * @return True if the point was found.
+ */
+bool QuadtreeNode::Remove(coordinate *c)
+{
+    if (IsLeaf())
+    {
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            if (points[i] == c)
+            {
+                points[i] = points.back();
+                points.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    if (!children[ChildIndex(c)]->Remove(c))
+        return false;
+
+    Collapse();
+    return true;
+}
+
+
+/**
+ * @brief Moves a point to (x, y). If the point stays in its leaf it is
+ * updated in place; otherwise it is relocated only below the deepest
+ * node whose quadrant it changed, rather than reinserted from the root.
+ *
+ * @param c The point to move; must be the pointer that was inserted.
+ *
+ * @param x The new x-coordinate.
+ *
+ * @param y The new y-coordinate.
+ *
+ * @return True if the point was found.
+ */
+bool QuadtreeNode::Move(coordinate *c, float x, float y)
+{
+    if (IsLeaf())
+    {
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            if (points[i] == c)
+            {
+                c->x = x;
+                c->y = y;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    coordinate to(x, y);
+    int from = ChildIndex(c);
+    int dest = ChildIndex(&to);
+
+    if (from == dest)
+        return children[from]->Move(c, x, y);
+
+    /* This node keeps the same number of points, so only the subtree
+     * the point leaves can underflow. */
+    if (!children[from]->Remove(c))
+        return false;
+
+    c->x = x;
+    c->y = y;
+    children[dest]->Insert(c);
+
+    return true;
 }
 
 
@@ -110,6 +371,17 @@ vector<rect*> QuadtreeNode::ListRectangles()
 {
     vector<rect*> boxes;
 
+    boxes.push_back(box);
+
+    if (!IsLeaf())
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            vector<rect*> sub = children[i]->ListRectangles();
+            boxes.insert(boxes.end(), sub.begin(), sub.end());
+        }
+    }
+
     return boxes;
 }
 
@@ -122,16 +394,25 @@ vector<rect*> QuadtreeNode::ListRectangles()
  */
 vector<coordinate*> QuadtreeNode::ListPoints()
 {
-    vector<coordinate*> points;
+    vector<coordinate*> ret = points;
 
-    return points;
+    if (!IsLeaf())
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            vector<coordinate*> sub = children[i]->ListPoints();
+            ret.insert(ret.end(), sub.begin(), sub.end());
+        }
+    }
+
+    return ret;
 }
 
 
 /**
  * @brief Queries for all points and rectangles that intersect a square
  * region centered on `center` of radius `radius`, in this node and
- * its children.
+ * its children. This is a convenience wrapper around `Visit`.
  *
  * @param center The center of the query region.
  *
@@ -141,9 +422,240 @@ vector<coordinate*> QuadtreeNode::ListPoints()
  */
 query *QuadtreeNode::Query(coordinate *center, float radius)
 {
-    vector<coordinate*> points;
-    vector<rect*> boxes;
+    CollectVisitor v;
 
-    query *ret = new query(points, boxes);
-    return ret;
+    Visit(region(center, radius, REGION_RECT), &v);
+
+    return new query(v.points, v.boxes);
+}
+
+
+/**
+ * @brief Walks this node and its children, handing every leaf box that
+ * intersects `r` and every point inside `r` to the visitor. Performs
+ * no heap allocation.
+ *
+ * @param r The query region.
+ *
+ * @param v The visitor to call for each result.
+ *
+ * @return False if the visitor stopped the query early, true otherwise.
+ */
+bool QuadtreeNode::Visit(const region &r, QueryVisitor *v)
+{
+    if (!r.Intersects(box))
+        return true;
+
+    if (!IsLeaf())
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (!children[i]->Visit(r, v))
+                return false;
+        }
+
+        return true;
+    }
+
+    if (!v->VisitBox(box))
+        return false;
+
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        if (r.Contains(points[i]) && !v->VisitPoint(points[i]))
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Finds the `k` points nearest to `c` with a best-first search.
+ * Nodes are expanded closest-box-first and pruned once their box is
+ * farther than the current k-th best point.
+ *
+ * @param c The query point.
+ *
+ * @param k Number of neighbors wanted.
+ *
+ * @param out Caller-owned array with room for `k` results; on return
+ * it is sorted nearest first.
+ *
+ * @param frontier Scratch space for the search; reusing it across
+ * calls avoids reallocating.
+ *
+ * @return The number of neighbors found (less than `k` only if the
+ * tree holds fewer points).
+ */
+int QuadtreeNode::Nearest(coordinate *c, int k, neighbor *out,
+    vector<node_entry> &frontier)
+{
+    int found = 0;
+
+    if (k <= 0)
+        return 0;
+
+    frontier.clear();
+
+    node_entry start;
+    start.dist2 = MinDist2(c);
+    start.node = this;
+    frontier.push_back(start);
+
+    while (!frontier.empty())
+    {
+        node_entry e = frontier.front();
+        pop_heap(frontier.begin(), frontier.end(), farther_node);
+        frontier.pop_back();
+
+        /* Everything left is at least this far away. */
+        if (found == k && e.dist2 >= out[0].dist2)
+            break;
+
+        QuadtreeNode *n = e.node;
+
+        if (n->IsLeaf())
+        {
+            for (unsigned int i = 0; i < n->points.size(); i++)
+            {
+                float dx = n->points[i]->x - c->x;
+                float dy = n->points[i]->y - c->y;
+                neighbor nb;
+                nb.point = n->points[i];
+                nb.dist2 = dx * dx + dy * dy;
+
+                if (found < k)
+                {
+                    out[found++] = nb;
+                    push_heap(out, out + found, closer_neighbor);
+                }
+                else if (nb.dist2 < out[0].dist2)
+                {
+                    pop_heap(out, out + found, closer_neighbor);
+                    out[found - 1] = nb;
+                    push_heap(out, out + found, closer_neighbor);
+                }
+            }
+            continue;
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            node_entry child;
+            child.node = n->children[i];
+            child.dist2 = child.node->MinDist2(c);
+
+            if (found == k && child.dist2 >= out[0].dist2)
+                continue;
+
+            frontier.push_back(child);
+            push_heap(frontier.begin(), frontier.end(), farther_node);
+        }
+    }
+
+    sort_heap(out, out + found, closer_neighbor);
+    return found;
+}
+
+
+/**
+ * @brief Computes the point count and center of mass of this node and
+ * every node below it, treating each point as a unit mass. Must be
+ * called again after the tree changes.
+ *
+ * @return The number of points in this subtree.
+ */
+int QuadtreeNode::ComputeMass()
+{
+    double sx = 0, sy = 0;
+
+    count = 0;
+
+    if (IsLeaf())
+    {
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            sx += points[i]->x;
+            sy += points[i]->y;
+        }
+
+        count = points.size();
+    }
+    else
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            int n = children[i]->ComputeMass();
+
+            sx += (double) children[i]->comx * n;
+            sy += (double) children[i]->comy * n;
+            count += n;
+        }
+    }
+
+    comx = count ? sx / count : 0;
+    comy = count ? sy / count : 0;
+
+    return count;
+}
+
+
+/**
+ * @brief Accumulates the softened inverse-square attraction on `c`
+ * from every point in this subtree. A node whose box is small relative
+ * to its distance from `c` (size / d < theta) is treated as a single
+ * mass at its center of mass.
+ *
+ * @param c The point feeling the force; it does not attract itself.
+ *
+ * @param theta2 Square of the opening angle theta.
+ *
+ * @param eps2 Square of the softening length.
+ *
+ * @param fx Running x-component of the force.
+ *
+ * @param fy Running y-component of the force.
+ */
+void QuadtreeNode::Force(coordinate *c, float theta2, float eps2,
+    float *fx, float *fy)
+{
+    if (count == 0)
+        return;
+
+    if (IsLeaf())
+    {
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            if (points[i] == c)
+                continue;
+
+            float dx = points[i]->x - c->x;
+            float dy = points[i]->y - c->y;
+            float d2 = dx * dx + dy * dy + eps2;
+            float inv = 1 / (d2 * sqrtf(d2));
+
+            *fx += dx * inv;
+            *fy += dy * inv;
+        }
+
+        return;
+    }
+
+    float dx = comx - c->x;
+    float dy = comy - c->y;
+    float d2 = dx * dx + dy * dy;
+
+    if (size * size < theta2 * d2)
+    {
+        d2 += eps2;
+        float inv = count / (d2 * sqrtf(d2));
+
+        *fx += dx * inv;
+        *fy += dy * inv;
+        return;
+    }
+
+    for (int i = 0; i < 4; i++)
+        children[i]->Force(c, theta2, eps2, fx, fy);
 }
@@ -52,6 +52,25 @@
 
 using namespace std;
 
+/* Maximum number of points a leaf holds before it is split. */
+#define NODE_CAPACITY   (1)
+
+/* Leaves this small are never split, so coincident points cannot
+ * cause unbounded recursion. */
+#define MIN_NODE_SIZE   (1e-5)
+
+class QuadtreeNode;
+
+/**
+ * @brief A node waiting in the best-first search frontier, keyed on
+ * the squared distance from the query point to its box.
+ */
+struct node_entry
+{
+    float dist2;
+    QuadtreeNode *node;
+};
+
 /**
  * @brief A class encapsulating a simple quadtree node.
  */
@@ -62,14 +81,34 @@ public:
     ~QuadtreeNode();
 
     rect *NodeRect();
+    bool IsLeaf();
     void Insert(coordinate *c);
+    bool Remove(coordinate *c);
+    bool Move(coordinate *c, float x, float y);
     vector<rect*> ListRectangles();
     vector<coordinate*> ListPoints();
     query *Query(coordinate *center, float radius);
+    bool Visit(const region &r, QueryVisitor *v);
+    int Nearest(coordinate *c, int k, neighbor *out,
+        vector<node_entry> &frontier);
+    int ComputeMass();
+    void Force(coordinate *c, float theta2, float eps2, float *fx,
+        float *fy);
 
 private:
     float size;
     rect *box;
+    QuadtreeNode *children[4];
+    vector<coordinate*> points;
+
+    /* Barnes-Hut aggregates, valid after `ComputeMass`. */
+    int count;
+    float comx, comy;
+
+    int ChildIndex(coordinate *c);
+    float MinDist2(coordinate *c);
+    void Subdivide();
+    void Collapse();
 };
 
 #endif
@@ -0,0 +1,282 @@
+/**
+ * @file benchmark.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Headless quadtree benchmarks.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <sys/time.h>
+#include "Quadtree.h"
+#include "ConcurrentQuadtree.h"
+
+#define DEFAULT_POINTS      (1000000)
+#define DEFAULT_QUERIES     (10000)
+#define NUM_NEIGHBORS       (8)
+
+/* The brute-force scan is O(n) per query, so it runs on fewer. */
+#define BRUTE_QUERIES       (100)
+
+#define MOVE_FRAMES         (5)
+#define MOVE_STEP           (0.0005)
+
+#define BATCH_MAX           (32)
+#define BATCH_RADIUS        (0.002)
+
+
+float frand()
+{
+    return (float) rand() / (float) RAND_MAX;
+}
+
+
+double seconds_since(clock_t start)
+{
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+/**
+ * @brief Wall-clock time; `clock` would add up CPU time across threads.
+ */
+double wall_seconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+bool closer(const neighbor &a, const neighbor &b)
+{
+    return a.dist2 < b.dist2;
+}
+
+
+/**
+ * @brief Reference k-nearest search: score every point and keep the
+ * `k` smallest.
+ */
+void brute_nearest(vector<coordinate*> &points, coordinate *c, int k,
+    vector<neighbor> &scratch, neighbor *out)
+{
+    scratch.resize(points.size());
+
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        float dx = points[i]->x - c->x;
+        float dy = points[i]->y - c->y;
+        scratch[i].point = points[i];
+        scratch[i].dist2 = dx * dx + dy * dy;
+    }
+
+    partial_sort(scratch.begin(), scratch.begin() + k, scratch.end(),
+        closer);
+    copy(scratch.begin(), scratch.begin() + k, out);
+}
+
+
+void bench_nearest(Quadtree &tree, vector<coordinate*> &points,
+    coordinate **qs, int nq)
+{
+    neighbor *out = new neighbor[nq * NUM_NEIGHBORS];
+    int *counts = new int[nq];
+    vector<neighbor> scratch;
+    clock_t start;
+    double t;
+
+    start = clock();
+    tree.NearestBatch(qs, nq, NUM_NEIGHBORS, out, counts);
+    t = seconds_since(start);
+    printf("kNN (k=%d), quadtree:    %8d queries  %10.0f queries/s\n",
+        NUM_NEIGHBORS, nq, nq / t);
+
+    int nb = min(nq, BRUTE_QUERIES);
+    int mismatches = 0;
+    neighbor ref[NUM_NEIGHBORS];
+
+    start = clock();
+    for (int i = 0; i < nb; i++)
+    {
+        brute_nearest(points, qs[i], NUM_NEIGHBORS, scratch, ref);
+
+        if (ref[NUM_NEIGHBORS - 1].dist2 !=
+            out[i * NUM_NEIGHBORS + NUM_NEIGHBORS - 1].dist2)
+            mismatches++;
+    }
+    t = seconds_since(start);
+    printf("kNN (k=%d), linear scan: %8d queries  %10.0f queries/s\n",
+        NUM_NEIGHBORS, nb, nb / t);
+
+    if (mismatches)
+        printf("WARNING: %d results differ from the linear scan\n",
+            mismatches);
+
+    delete[] out;
+    delete[] counts;
+}
+
+
+/**
+ * @brief Jitters every point once per frame, bouncing off the world
+ * edges, and compares `Move` against rebuilding the tree each frame.
+ */
+void bench_moves(int np)
+{
+    Quadtree tree(1.);
+    vector<coordinate*> points;
+    vector<float> vx, vy;
+
+    for (int i = 0; i < np; i++)
+        tree.Insert(new coordinate(frand(), frand()));
+
+    points = tree.ListPoints();
+    for (int i = 0; i < np; i++)
+    {
+        vx.push_back((frand() - 0.5) * MOVE_STEP);
+        vy.push_back((frand() - 0.5) * MOVE_STEP);
+    }
+
+    double start = wall_seconds();
+    for (int f = 0; f < MOVE_FRAMES; f++)
+    {
+        for (int i = 0; i < np; i++)
+        {
+            float x = points[i]->x + vx[i];
+            float y = points[i]->y + vy[i];
+
+            if (x < 0 || x > 1)
+            {
+                vx[i] = -vx[i];
+                x = points[i]->x;
+            }
+            if (y < 0 || y > 1)
+            {
+                vy[i] = -vy[i];
+                y = points[i]->y;
+            }
+
+            tree.Move(points[i], x, y);
+        }
+    }
+    double t = (wall_seconds() - start) / MOVE_FRAMES;
+    printf("Move %d points:           %8.1f ms/frame\n", np, t * 1000);
+
+    start = wall_seconds();
+    for (int f = 0; f < MOVE_FRAMES; f++)
+    {
+        Quadtree rebuilt(1.);
+
+        for (int i = 0; i < np; i++)
+            rebuilt.Insert(new coordinate(points[i]->x + vx[i],
+                points[i]->y + vy[i]));
+    }
+    t = (wall_seconds() - start) / MOVE_FRAMES;
+    printf("Rebuild with %d points:   %8.1f ms/frame\n", np, t * 1000);
+}
+
+
+void bench_batch(vector<coordinate*> &points, coordinate **qs, int nq)
+{
+    vector<region> regions;
+    coordinate *out = new coordinate[nq * BATCH_MAX];
+    int *counts = new int[nq];
+
+    for (int i = 0; i < nq; i++)
+        regions.push_back(region(qs[i], BATCH_RADIUS, REGION_CIRCLE));
+
+    for (int threads = 0; threads <= 8; threads = threads ? threads * 2 : 1)
+    {
+        ConcurrentQuadtree tree(1., threads);
+
+        for (unsigned int i = 0; i < points.size(); i++)
+            tree.Insert(new coordinate(points[i]));
+        tree.Merge();
+
+        double start = wall_seconds();
+        tree.QueryBatch(&regions[0], nq, out, BATCH_MAX, counts);
+        double t = wall_seconds() - start;
+
+        printf("QueryBatch, %d worker(s):  %8d queries  %10.0f queries/s\n",
+            threads, nq, nq / t);
+    }
+
+    delete[] out;
+    delete[] counts;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int np = DEFAULT_POINTS;
+    int nq = DEFAULT_QUERIES;
+
+    if (argc > 1)
+        np = atoi(argv[1]);
+    if (argc > 2)
+        nq = atoi(argv[2]);
+
+    srand(1);
+
+    clock_t start = clock();
+    Quadtree tree(1.);
+    for (int i = 0; i < np; i++)
+        tree.Insert(new coordinate(frand(), frand()));
+    printf("Inserted %d points in %.3f s\n", np, seconds_since(start));
+
+    vector<coordinate*> points = tree.ListPoints();
+    coordinate **qs = new coordinate*[nq];
+    for (int i = 0; i < nq; i++)
+        qs[i] = new coordinate(frand(), frand());
+
+    bench_nearest(tree, points, qs, nq);
+    bench_batch(points, qs, nq);
+    bench_moves(np);
+
+    for (int i = 0; i < nq; i++)
+        delete qs[i];
+    delete[] qs;
+
+    return 0;
+}
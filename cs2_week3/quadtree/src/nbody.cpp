@@ -0,0 +1,160 @@
+/**
+ * @file nbody.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Headless Barnes-Hut N-body benchmark.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include "Quadtree.h"
+
+#define DEFAULT_POINTS      (1000000)
+#define THETA               (0.5)
+#define SOFTENING           (0.001)
+
+/* Points checked against the exact O(n) sum. */
+#define CHECK_POINTS        (50)
+
+
+float frand()
+{
+    return (float) rand() / (float) RAND_MAX;
+}
+
+
+double wall_seconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+/**
+ * @brief Exact softened attraction on `c` from every other point.
+ */
+void direct_force(vector<coordinate*> &points, coordinate *c, double *fx,
+    double *fy)
+{
+    double eps2 = SOFTENING * SOFTENING;
+
+    *fx = 0;
+    *fy = 0;
+
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        if (points[i] == c)
+            continue;
+
+        double dx = points[i]->x - c->x;
+        double dy = points[i]->y - c->y;
+        double d2 = dx * dx + dy * dy + eps2;
+        double inv = 1 / (d2 * sqrt(d2));
+
+        *fx += dx * inv;
+        *fy += dy * inv;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int np = DEFAULT_POINTS;
+
+    if (argc > 1)
+        np = atoi(argv[1]);
+
+    srand(1);
+
+    double start = wall_seconds();
+    Quadtree tree(1.);
+    for (int i = 0; i < np; i++)
+        tree.Insert(new coordinate(frand(), frand()));
+    printf("Build, %d points:          %8.3f s\n", np,
+        wall_seconds() - start);
+
+    vector<coordinate*> points = tree.ListPoints();
+    np = points.size();
+
+    start = wall_seconds();
+    tree.ComputeMass();
+    printf("Upward pass:                 %8.3f s\n", wall_seconds() - start);
+
+    float *fx = new float[np];
+    float *fy = new float[np];
+
+    start = wall_seconds();
+    tree.Forces(&points[0], np, THETA, SOFTENING, fx, fy);
+    double t = wall_seconds() - start;
+    printf("Forces (theta=%.2f):         %8.3f s  (%.0f points/s)\n",
+        THETA, t, np / t);
+
+    /* Compare a sample against the exact sum. */
+    double worst = 0, total = 0;
+    int nc = np < CHECK_POINTS ? np : CHECK_POINTS;
+
+    start = wall_seconds();
+    for (int i = 0; i < nc; i++)
+    {
+        int j = i * (np / nc);
+        double ex, ey;
+
+        direct_force(points, points[j], &ex, &ey);
+
+        double err = sqrt((fx[j] - ex) * (fx[j] - ex) +
+            (fy[j] - ey) * (fy[j] - ey)) / sqrt(ex * ex + ey * ey);
+        total += err;
+        if (err > worst)
+            worst = err;
+    }
+    t = (wall_seconds() - start) / nc;
+    printf("Direct sum:                  %8.3f s/point, extrapolated "
+        "%.0f s for all\n", t, t * np);
+    printf("Relative error:              mean %.2e, worst %.2e\n",
+        total / nc, worst);
+
+    delete[] fx;
+    delete[] fy;
+    return 0;
+}
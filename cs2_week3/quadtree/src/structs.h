@@ -54,6 +54,12 @@ struct coordinate
 {
     float x, y;
 
+    coordinate()
+    {
+        this->x = 0;
+        this->y = 0;
+    }
+
     coordinate(float x, float y)
     {
         this->x = x;
@@ -106,6 +112,101 @@ struct rect
 };
 
 
+/**
+ * @brief Shapes a query region can take.
+ */
+enum region_shape
+{
+    REGION_RECT,
+    REGION_CIRCLE
+};
+
+
+/**
+ * @brief A query region: either an axis-aligned rectangle given by its
+ * center and half-extents, or a circle given by its center and radius
+ * (stored in `hw`; `hh` is unused).
+ */
+struct region
+{
+    region_shape shape;
+    float cx, cy;
+    float hw, hh;
+
+    region(coordinate *center, float radius, region_shape shape)
+    {
+        this->shape = shape;
+        this->cx = center->x;
+        this->cy = center->y;
+        this->hw = radius;
+        this->hh = radius;
+    }
+
+    region(coordinate *ul, coordinate *br)
+    {
+        this->shape = REGION_RECT;
+        this->cx = (ul->x + br->x) / 2;
+        this->cy = (ul->y + br->y) / 2;
+        this->hw = (br->x - ul->x) / 2;
+        this->hh = (br->y - ul->y) / 2;
+    }
+
+    bool Contains(const coordinate *c) const
+    {
+        float dx = c->x - cx;
+        float dy = c->y - cy;
+
+        if (shape == REGION_CIRCLE)
+            return dx * dx + dy * dy <= hw * hw;
+
+        return (dx >= -hw) && (dx <= hw) && (dy >= -hh) && (dy <= hh);
+    }
+
+    bool Intersects(const rect *r) const
+    {
+        if (shape == REGION_CIRCLE)
+        {
+            /* Distance from the center to the closest point of `r`. */
+            float px = (cx < r->ul->x) ? r->ul->x :
+                ((cx > r->br->x) ? r->br->x : cx);
+            float py = (cy < r->ul->y) ? r->ul->y :
+                ((cy > r->br->y) ? r->br->y : cy);
+            float dx = px - cx;
+            float dy = py - cy;
+
+            return dx * dx + dy * dy <= hw * hw;
+        }
+
+        return (cx - hw <= r->br->x) && (cx + hw >= r->ul->x) &&
+            (cy - hh <= r->br->y) && (cy + hh >= r->ul->y);
+    }
+};
+
+
+/**
+ * @brief Callback interface for allocation-free queries. Return false
+ * from either function to stop the query early.
+ */
+class QueryVisitor
+{
+public:
+    virtual ~QueryVisitor() { }
+
+    virtual bool VisitPoint(coordinate *c) = 0;
+    virtual bool VisitBox(rect *r) { return true; }
+};
+
+
+/**
+ * @brief One result of a nearest-neighbor search.
+ */
+struct neighbor
+{
+    coordinate *point;
+    float dist2;        /* squared distance to the query point */
+};
+
+
 struct query
 {
     vector<coordinate*> points;
@@ -0,0 +1,445 @@
+/**
+ * @file testsuite.cpp
+ * @version 1.0
+ * @date 2013-2014
+ * @copyright see License section
+ *
+ * @brief Tests for the quadtree.
+ *
+ * @section License
+ * Copyright (c) 2013-2014 California Institute of Technology.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the California Institute of Technology.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include "Quadtree.h"
+#include "ConcurrentQuadtree.h"
+
+#define NUM_POINTS      (2000)
+#define NUM_QUERIES     (200)
+#define NUM_NEIGHBORS   (10)
+#define NUM_READERS     (3)
+
+/**
+ * @brief Counts visited points, stopping after `limit` of them.
+ */
+class CountVisitor : public QueryVisitor
+{
+public:
+    CountVisitor(int limit)
+    {
+        this->limit = limit;
+        this->count = 0;
+    }
+
+    bool VisitPoint(coordinate *c)
+    {
+        count++;
+        return count < limit;
+    }
+
+    int limit, count;
+};
+
+
+float frand()
+{
+    return (float) rand() / (float) RAND_MAX;
+}
+
+
+int brute_count(vector<coordinate*> &points, const region &r)
+{
+    int n = 0;
+
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        if (r.Contains(points[i]))
+            n++;
+    }
+
+    return n;
+}
+
+
+int check_nearest(vector<coordinate*> &points,
+    coordinate *c, neighbor *found, int count)
+{
+    vector<float> d;
+
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        float dx = points[i]->x - c->x;
+        float dy = points[i]->y - c->y;
+        d.push_back(dx * dx + dy * dy);
+    }
+    sort(d.begin(), d.end());
+
+    if (count != NUM_NEIGHBORS)
+    {
+        printf("FAIL: Nearest found %d points, expected %d\n",
+            count, NUM_NEIGHBORS);
+        return 1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (found[i].dist2 != d[i])
+        {
+            printf("FAIL: neighbor %d at distance^2 %f, expected %f\n",
+                i, found[i].dist2, d[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+volatile bool readers_done = false;
+volatile int reader_failures = 0;
+
+
+/**
+ * @brief Reader thread body: queries the concurrent tree until told
+ * to stop, checking that the point count never goes backwards.
+ */
+void *reader(void *arg)
+{
+    ConcurrentQuadtree *tree = (ConcurrentQuadtree *) arg;
+    coordinate center(0.5, 0.5);
+    region everything(&center, 1., REGION_RECT);
+    int last = 0;
+
+    while (!readers_done)
+    {
+        CountVisitor v(NUM_POINTS + 1);
+        tree->Visit(everything, &v);
+
+        if (v.count < last)
+            __sync_fetch_and_add(&reader_failures, 1);
+        last = v.count;
+    }
+
+    return NULL;
+}
+
+
+int test_dynamic()
+{
+    int failures = 0;
+    Quadtree tree(1.);
+    vector<coordinate*> points;
+
+    for (int i = 0; i < NUM_POINTS; i++)
+        tree.Insert(new coordinate(frand(), frand()));
+    points = tree.ListPoints();
+
+    /* Small moves mostly stay in their leaf; large ones do not. */
+    for (int step = 0; step < 10; step++)
+    {
+        float scale = step % 2 ? 0.001 : 0.5;
+
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            float x = points[i]->x + (frand() - 0.5) * scale;
+            float y = points[i]->y + (frand() - 0.5) * scale;
+
+            if (x >= 0 && x <= 1 && y >= 0 && y <= 1 &&
+                !tree.Move(points[i], x, y))
+            {
+                printf("FAIL: could not move point %d\n", i);
+                failures++;
+            }
+        }
+    }
+
+    for (int i = 0; i < NUM_QUERIES; i++)
+    {
+        coordinate center(frand(), frand());
+        region circle(&center, frand() * 0.2, REGION_CIRCLE);
+        CountVisitor v(NUM_POINTS + 1);
+
+        tree.Visit(circle, &v);
+        if (v.count != brute_count(points, circle))
+        {
+            printf("FAIL: query after moves found %d points, expected %d\n",
+                v.count, brute_count(points, circle));
+            failures++;
+        }
+    }
+
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        if (!tree.Remove(points[i]))
+        {
+            printf("FAIL: could not remove point %d\n", i);
+            failures++;
+        }
+    }
+
+    if (tree.ListPoints().size() != 0 || tree.ListRectangles().size() != 1)
+    {
+        printf("FAIL: tree did not collapse after removing every point\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+
+int test_forces()
+{
+    int failures = 0;
+    Quadtree tree(1.);
+
+    for (int i = 0; i < NUM_POINTS; i++)
+        tree.Insert(new coordinate(frand(), frand()));
+
+    vector<coordinate*> points = tree.ListPoints();
+    float *fx = new float[NUM_POINTS];
+    float *fy = new float[NUM_POINTS];
+
+    tree.ComputeMass();
+
+    /* With theta = 0 every node is opened, so the sum is exact. */
+    tree.Forces(&points[0], NUM_POINTS, 0, 0.01, fx, fy);
+
+    for (int i = 0; i < NUM_POINTS; i += NUM_POINTS / 20)
+    {
+        double ex = 0, ey = 0;
+
+        for (int j = 0; j < NUM_POINTS; j++)
+        {
+            if (j == i)
+                continue;
+
+            double dx = points[j]->x - points[i]->x;
+            double dy = points[j]->y - points[i]->y;
+            double d2 = dx * dx + dy * dy + 0.01 * 0.01;
+            ex += dx / (d2 * sqrt(d2));
+            ey += dy / (d2 * sqrt(d2));
+        }
+
+        double err = sqrt((fx[i] - ex) * (fx[i] - ex) +
+            (fy[i] - ey) * (fy[i] - ey)) / sqrt(ex * ex + ey * ey);
+        if (err > 1e-3)
+        {
+            printf("FAIL: force on point %d off by %e\n", i, err);
+            failures++;
+        }
+    }
+
+    delete[] fx;
+    delete[] fy;
+    return failures;
+}
+
+
+int test_concurrent()
+{
+    int failures = 0;
+    ConcurrentQuadtree tree(1., 2);
+    Thread threads[NUM_READERS];
+
+    for (int i = 0; i < NUM_READERS; i++)
+        threads[i].run(reader, (void *) &tree);
+
+    for (int i = 0; i < NUM_POINTS; i++)
+    {
+        tree.Insert(new coordinate(frand(), frand()));
+
+        if (i % 100 == 99)
+            tree.Merge();
+    }
+    tree.Merge();
+
+    readers_done = true;
+    for (int i = 0; i < NUM_READERS; i++)
+        threads[i].join();
+
+    if (reader_failures)
+    {
+        printf("FAIL: readers saw the tree shrink %d time(s)\n",
+            reader_failures);
+        failures++;
+    }
+
+    coordinate center(0.5, 0.5);
+    region everything(&center, 1., REGION_RECT);
+    coordinate *all = new coordinate[NUM_POINTS];
+
+    if (tree.QueryPoints(everything, all, NUM_POINTS) != NUM_POINTS)
+    {
+        printf("FAIL: concurrent tree lost points\n");
+        failures++;
+    }
+
+    vector<region> regions;
+    for (int i = 0; i < NUM_QUERIES; i++)
+    {
+        coordinate c(frand(), frand());
+        regions.push_back(region(&c, frand() * 0.2, REGION_CIRCLE));
+    }
+
+    coordinate *out = new coordinate[NUM_QUERIES * 16];
+    int counts[NUM_QUERIES];
+    tree.QueryBatch(&regions[0], NUM_QUERIES, out, 16, counts);
+
+    for (int i = 0; i < NUM_QUERIES; i++)
+    {
+        if (counts[i] != tree.QueryPoints(regions[i], all, 16))
+        {
+            printf("FAIL: QueryBatch disagrees with QueryPoints\n");
+            failures++;
+        }
+    }
+
+    delete[] out;
+    delete[] all;
+    return failures;
+}
+
+
+int main()
+{
+    int failures = 0;
+    coordinate *buf[NUM_POINTS];
+
+    srand(1);
+
+    printf("Testing insertion\n");
+    Quadtree tree(1.);
+    for (int i = 0; i < NUM_POINTS; i++)
+        tree.Insert(new coordinate(frand(), frand()));
+
+    vector<coordinate*> points = tree.ListPoints();
+    if (points.size() != NUM_POINTS)
+    {
+        printf("FAIL: listed %d points, expected %d\n",
+            (int) points.size(), NUM_POINTS);
+        failures++;
+    }
+
+    printf("Testing queries against a linear scan\n");
+    for (int i = 0; i < NUM_QUERIES; i++)
+    {
+        coordinate center(frand(), frand());
+        float radius = frand() * 0.2;
+        region square(&center, radius, REGION_RECT);
+        region circle(&center, radius, REGION_CIRCLE);
+
+        query *q = tree.Query(&center, radius);
+        int expected = brute_count(points, square);
+        if ((int) q->points.size() != expected)
+        {
+            printf("FAIL: Query found %d points, expected %d\n",
+                (int) q->points.size(), expected);
+            failures++;
+        }
+        delete q;
+
+        CountVisitor all(NUM_POINTS + 1);
+        tree.Visit(circle, &all);
+        expected = brute_count(points, circle);
+        if (all.count != expected)
+        {
+            printf("FAIL: Visit found %d points, expected %d\n",
+                all.count, expected);
+            failures++;
+        }
+
+        int n = tree.QueryPoints(circle, buf, NUM_POINTS);
+        if (n != expected)
+        {
+            printf("FAIL: QueryPoints found %d points, expected %d\n",
+                n, expected);
+            failures++;
+        }
+    }
+
+    printf("Testing nearest neighbors against a linear scan\n");
+    coordinate *qs[NUM_QUERIES];
+    neighbor nb[NUM_QUERIES * NUM_NEIGHBORS];
+    int counts[NUM_QUERIES];
+
+    for (int i = 0; i < NUM_QUERIES; i++)
+        qs[i] = new coordinate(frand(), frand());
+
+    tree.NearestBatch(qs, NUM_QUERIES, NUM_NEIGHBORS, nb, counts);
+    for (int i = 0; i < NUM_QUERIES; i++)
+    {
+        failures += check_nearest(points, qs[i],
+            nb + i * NUM_NEIGHBORS, counts[i]);
+
+        neighbor single[NUM_NEIGHBORS];
+        int n = tree.Nearest(qs[i], NUM_NEIGHBORS, single);
+        failures += check_nearest(points, qs[i], single, n);
+
+        delete qs[i];
+    }
+
+    printf("Testing early termination\n");
+    coordinate center(0.5, 0.5);
+    region everything(&center, 1., REGION_RECT);
+
+    CountVisitor three(3);
+    if (tree.Visit(everything, &three) || three.count != 3)
+    {
+        printf("FAIL: visitor did not stop after 3 points\n");
+        failures++;
+    }
+
+    if (tree.QueryPoints(everything, buf, 5) != 5)
+    {
+        printf("FAIL: QueryPoints overran its output array\n");
+        failures++;
+    }
+
+    printf("Testing moves and removals\n");
+    failures += test_dynamic();
+
+    printf("Testing Barnes-Hut forces against a direct sum\n");
+    failures += test_forces();
+
+    printf("Testing concurrent inserts and queries\n");
+    failures += test_concurrent();
+
+    printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -6,173 +6,40 @@
 //  Copyright (c) 2014 California Institute of Technology. All rights reserved.
 //
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <ctype.h>
 #include <stdio.h>
-#include <unordered_map>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "align.h"
 
 using namespace std;
 
-// scoring values
-#define GAP_SCORE -5
-#define MISMATCH -1
-#define MATCHING 2
+// largest traceback matrix the automatic engine choice allows nw_align
+#define NW_MAX_BYTES (256 << 20)
 
-// packages the score, instruction string the align function returns
-struct align_result {
-    int score;      // score of this alignment
-    string inst;    // instruction on how to align the inputs
-
-    align_result(int s, string i){
-      // constructor with values
-        this->score = s;
-        this->inst = i;
-    }
-    align_result(){
-        this->score = 0;
-        this->inst = "";
-    }
+// alignment engines DNA_align can use
+enum align_engine {
+    ENGINE_AUTO,        // nw_align unless its matrix is too big
+    ENGINE_NW,
+    ENGINE_HIRSCHBERG,
+    ENGINE_STRIPED,     // SIMD score, banded traceback
+    ENGINE_BANDED,      // band doubled until provably optimal
+    ENGINE_GOTOH        // affine gaps and local or semi-global modes
 };
 
-// memo_type will allow us to hash the string input to align
-// with its output for memoization
-typedef unordered_map<string, align_result> memo_type;
-
-/*
- * @brief: Return max of three integers.
- *
- * @param first, second, third: The integers to be compared.
- *
- * @return: The max of the three parameters.
- */
-int get_max(int first, int second, int third)
-{
-    if (first >= second && first >= third)
-    {
-        return first;
-    }
-    else if (second >= first && second >= third)
-    {
-        return second;
-    }
-    return third;
-}
-
+// settings for DNA_align, from the command line
+static align_scoring scoring = DEFAULT_SCORING;
+static align_engine engine = ENGINE_AUTO;
+static align_mode mode = ALIGN_GLOBAL;
 
-// function takes two strings, s and t, and produces an align_result
-// of the highest alignment score and its corresponding instruction str.
-align_result align(string s, string t, memo_type &memo)
-{
-    string key = s + "," + t;
-    // If the result has been memoized, return that instead of recalculating.
-    if (memo.count(key) > 0)
-    {
-        return memo[key];
-    }
-
-    string new_s;
-    string new_t;
-    int score1, score2, score3, max;
-    string inst1, inst2, inst3;
-    align_result answer;
-
-    if (s.length() == 0)
-    {
-        /*
-         * Base case - s string is empty. In that case, then all
-         * characters in t make a gap.
-         */
-        answer.score = (int) t.length() * -5;
-        string inst = string((int) t.length(), 't');
-        answer.inst = inst;
-        return answer;
-    }
-    else if (t.length() == 0)
-    {
-        /*
-         * Base case - t string is empty. In that case, then all
-         * characters in s make a gap.
-         */
-        answer.score = (int) s.length() * -5;
-        string inst = string((int) s.length(), 's');
-        answer.inst = string((int) s.length(), 's');
-
-        return answer;
-    }
-    else
-    {
-        // Gap in first string (s)
-        new_s = s;
-        new_t = t.substr(1, -1);
-        /*
-         * Add the score and inst strings for the "removed" characters and
-         * for the rest of the string.
-         */
-        score1 = align("", t.substr(0, 1), memo).score
-            + align(new_s, new_t, memo).score;
-        inst1 = align("", t.substr(0, 1), memo).inst
-            + align(new_s, new_t, memo).inst;
-
-        // Gap in second string (t)
-        new_s = s.substr(1, -1);
-        new_t = t;
-        /*
-         * Add the score and inst strings for the "removed" characters and
-         * for the rest of the string.
-         */
-        score2 = align(s.substr(0, 1), "", memo).score
-            + align(new_s, new_t, memo).score;
-        inst2 = align(s.substr(0, 1), "", memo).inst
-            + align(new_s, new_t, memo).inst;
-
-        // Gap in neither string
-        new_s = s.substr(1, -1);
-        new_t = t.substr(1, -1);
-        // Calculate the score for the "removed" characters
-        if (s.substr(0, 1).compare(t.substr(0, 1)) == 0)
-        {
-            score3 = 2;
-            inst3 = "|";
-        }
-        else
-        {
-            score3 = -1;
-            inst3 = "*";
-        }
-        // Add the score for the rest of the string
-        score3 += align(new_s, new_t, memo).score;
-        inst3 += align(new_s, new_t, memo).inst;
-
-        // Get the max score, and use that to choose the right inst string.
-        max = get_max(score1, score2, score3);
-        if (max == score1)
-        {
-            answer.score = max;
-            answer.inst = inst1;
-        }
-        else if (max == score2)
-        {
-            answer.score = max;
-            answer.inst = inst2;
-        }
-        else if (max == score3)
-        {
-            answer.score = max;
-            answer.inst = inst3;
-        }
-        // Memoize this ish
-        memo[key] = answer;
-        return answer;
-    }}
-
-// Wrapper function to print the results of align
-void DNA_align(string s, string t){
-    cout << endl<<"Calling DNA align on strings " << s <<", "<< t<< endl;
-
-    // create the memoization system
-    memo_type memo;
-
-    align_result answer = align(s,t, memo);
-    string ans =answer.inst;
+// Prints s and t one above the other, spaced out according to the
+// instruction string, with the instructions on a third line
+void print_alignment(const string &s, const string &t,
+    const align_result &answer){
+    const string &ans = answer.inst;
 
     // Printing section
     string line1 = "";      // line where string s will be printed, spaces inserted
@@ -185,24 +52,24 @@ void DNA_align(string s, string t){
     for (unsigned int m = 0; m< ans.length(); m++){
 
         // i is the next element in our instruction string ans
-        string i = ans.substr(m, 1);
+        char i = ans[m];
 
         // only in s
-        if(i.compare("s") == 0){
+        if (i == 's'){
             line1 += s[j]; j++;
             line2 += " ";
             line3 += "s";
         }
 
         // only in t
-        else if (i.compare("t") == 0){
+        else if (i == 't'){
             line1 += " ";
             line2 += t[k]; k++;
             line3 += "t";
         }
 
         // mismatch
-        else if (i.compare("*") == 0){
+        else if (i == '*'){
             line1 += s[j]; j++;
             line2 += t[k]; k++;
             line3 += "*";
@@ -219,8 +86,167 @@ void DNA_align(string s, string t){
     cout << line1 << endl << line2 << endl << line3 << endl;
 }
 
-int main()
+// Wrapper function to print the results of align
+void DNA_align(string s, string t){
+    cout << endl<<"Calling DNA align on strings " << s <<", "<< t<< endl;
+
+    bool small = (double) s.length() * t.length() / 4 <= NW_MAX_BYTES;
+    align_result answer;
+
+    // Near-identical DNA of one length needs no table at all.
+    if (mode == ALIGN_GLOBAL && ungapped_align(s, t, scoring, answer))
+    {
+        print_alignment(s, t, answer);
+    }
+    // Only Gotoh handles affine gaps and the other modes.
+    else if (engine == ENGINE_GOTOH || scoring.gap_open != 0 ||
+        mode != ALIGN_GLOBAL)
+    {
+        print_alignment(s, t, gotoh_align(s, t, scoring, mode));
+    }
+    else if (engine == ENGINE_NW || (engine == ENGINE_AUTO && small))
+    {
+        print_alignment(s, t, nw_align(s, t, scoring));
+    }
+    else if (engine == ENGINE_BANDED)
+    {
+        print_alignment(s, t, adaptive_banded_align(s, t, scoring));
+    }
+    else if (engine == ENGINE_STRIPED)
+    {
+        print_alignment(s, t, striped_align(s, t, scoring));
+    }
+    else
+    {
+        print_alignment(s, t, hirschberg_align(s, t, scoring));
+    }
+}
+
+/*
+ * @brief: Reads a sequence from a file, skipping whitespace and any
+ * FASTA header lines (starting with '>').
+ *
+ * @return: False if the file could not be opened.
+ */
+bool read_sequence(const char *filename, string &seq)
 {
+    ifstream in(filename);
+    string line;
+
+    if (!in)
+    {
+        return false;
+    }
+
+    seq.clear();
+    while (getline(in, line))
+    {
+        if (!line.empty() && line[0] == '>')
+        {
+            continue;
+        }
+        for (unsigned int i = 0; i < line.length(); i++)
+        {
+            if (!isspace((unsigned char) line[i]))
+            {
+                seq += line[i];
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    bool files = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "e:g:o:x:m:M:f")) != -1)
+    {
+        if (opt == 'e' && strcmp(optarg, "nw") == 0)
+        {
+            engine = ENGINE_NW;
+        }
+        else if (opt == 'e' && strcmp(optarg, "hirschberg") == 0)
+        {
+            engine = ENGINE_HIRSCHBERG;
+        }
+        else if (opt == 'e' && strcmp(optarg, "banded") == 0)
+        {
+            engine = ENGINE_BANDED;
+        }
+        else if (opt == 'e' && strcmp(optarg, "striped") == 0)
+        {
+            engine = ENGINE_STRIPED;
+        }
+        else if (opt == 'e' && strcmp(optarg, "gotoh") == 0)
+        {
+            engine = ENGINE_GOTOH;
+        }
+        else if (opt == 'g')
+        {
+            scoring.gap_score = atoi(optarg);
+        }
+        else if (opt == 'o')
+        {
+            scoring.gap_open = atoi(optarg);
+        }
+        else if (opt == 'x')
+        {
+            scoring.mismatch = atoi(optarg);
+        }
+        else if (opt == 'm')
+        {
+            scoring.matching = atoi(optarg);
+        }
+        else if (opt == 'M' && strcmp(optarg, "global") == 0)
+        {
+            mode = ALIGN_GLOBAL;
+        }
+        else if (opt == 'M' && strcmp(optarg, "local") == 0)
+        {
+            mode = ALIGN_LOCAL;
+        }
+        else if (opt == 'M' && strcmp(optarg, "semi") == 0)
+        {
+            mode = ALIGN_SEMIGLOBAL;
+        }
+        else if (opt == 'f')
+        {
+            files = true;
+        }
+        else
+        {
+            optind = -1;
+            break;
+        }
+    }
+
+    // align two strings, or two sequence files with -f
+    if (optind == argc - 2)
+    {
+        string s = argv[optind], t = argv[optind + 1];
+
+        if (files && (!read_sequence(argv[optind], s) ||
+            !read_sequence(argv[optind + 1], t)))
+        {
+            printf("could not read %s or %s\n", argv[optind],
+                argv[optind + 1]);
+            return 1;
+        }
+        DNA_align(s, t);
+        return 0;
+    }
+    if (optind != argc || files)
+    {
+        printf("usage: %s [-e nw|hirschberg|banded|striped|gotoh]"
+            " [-g gap] [-o gap open]\n"
+            "             [-x mismatch] [-m match] [-M global|local|semi]\n"
+            "             [<s> <t> | -f <s file> <t file>]\n",
+            argv[0]);
+        return 1;
+    }
+
   // some test cases to begin with
     DNA_align("",   "a");
     DNA_align("bbbb",  "");
@@ -0,0 +1,138 @@
+//
+//  align.h
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#ifndef __ALIGN_H__
+#define __ALIGN_H__
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// scoring values, settable at run time
+struct align_scoring {
+    int gap_score;  // a character aligned with a gap
+    int mismatch;   // two different characters
+    int matching;   // two equal characters
+    int gap_open;   // added once per run of gaps (affine, gotoh_align only)
+};
+
+// the scores the assignment uses
+static const align_scoring DEFAULT_SCORING = {-5, -1, 2, 0};
+
+// which ends of the strings may be left out for free
+enum align_mode {
+    ALIGN_GLOBAL,       // all of s against all of t
+    ALIGN_LOCAL,        // best-scoring substring of s against one of t
+    ALIGN_SEMIGLOBAL    // one string may overhang the other at each end
+};
+
+// packages the score, instruction string the align function returns
+struct align_result {
+    int score;      // score of this alignment
+    string inst;    // instruction on how to align the inputs
+
+    align_result(int s, string i){
+      // constructor with values
+        this->score = s;
+        this->inst = i;
+    }
+    align_result(){
+        this->score = 0;
+        this->inst = "";
+    }
+};
+
+// buffers an engine may keep between calls, so that aligning many pairs
+// on one thread does not allocate for each of them
+struct align_scratch {
+    vector<int> rows;               // score rows
+    vector<unsigned char> trace;    // packed traceback moves
+};
+
+/*
+ * Instruction characters, one per column of the alignment:
+ *   '|'  s and t match          '*'  s and t mismatch
+ *   's'  character only in s    't'  character only in t
+ */
+
+// Needleman-Wunsch, bottom up (nw.cpp)
+align_result nw_align(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_scratch *scratch = NULL);
+
+// Score of an instruction string for s and t (nw.cpp)
+int score_alignment(const string &s, const string &t, const string &inst,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_mode mode = ALIGN_GLOBAL);
+
+// Instruction string with runs written as <count><instruction> (nw.cpp)
+string run_length(const string &inst);
+
+// Global and local scores only, scalar, linear space (nw.cpp)
+int nw_score(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+int sw_score(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+
+// Gotoh: affine gaps, in any mode. Characters left out of a local or
+// semi-global alignment are given as unscored 's' and 't' at either end
+// of the instruction string (gotoh.cpp)
+align_result gotoh_align(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_mode mode = ALIGN_GLOBAL, align_scratch *scratch = NULL);
+int gotoh_score(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_mode mode = ALIGN_GLOBAL);
+
+// Gapless alignment of equal-length DNA, found by comparing 2-bit packed
+// words, when it is provably optimal; the tools try it before calling
+// an engine, which is then never needed (packed.cpp)
+bool ungapped_align(const string &s, const string &t,
+    const align_scoring &scoring, align_result &answer);
+
+// Edit distance by Myers' bit-parallel algorithm, 64 rows of the table
+// per word, and a test against a limit that stops early (myers.cpp)
+size_t edit_distance(const string &s, const string &t);
+bool edit_distance_within(const string &s, const string &t, size_t limit,
+    size_t *distance = NULL);
+
+// Hirschberg, linear space (hirschberg.cpp)
+align_result hirschberg_align(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+
+// Banded Needleman-Wunsch: only cells within `band` of the diagonals
+// joining the two corners (banded.cpp)
+align_result banded_align(const string &s, const string &t, size_t band,
+    const align_scoring &scoring = DEFAULT_SCORING);
+
+// Best score an alignment that leaves that band could have; a banded
+// score at least this high is optimal (banded.cpp)
+long band_outside_bound(size_t m, size_t n, size_t band,
+    const align_scoring &scoring);
+
+// Banded, doubling the band until the result is provably optimal
+// (banded.cpp)
+align_result adaptive_banded_align(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    size_t *band_used = NULL);
+
+// Farrar striped SIMD scores, run on the widest vectors the CPU has,
+// and a full alignment scored by them and traced back in a band
+// (striped.cpp)
+int striped_global_score(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+int striped_local_score(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+align_result striped_align(const string &s, const string &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+const char *striped_isa();
+
+// Prints an alignment in the DNA_align format (align.cpp)
+void print_alignment(const string &s, const string &t,
+    const align_result &answer);
+
+#endif
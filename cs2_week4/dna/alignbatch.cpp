@@ -0,0 +1,383 @@
+//
+//  alignbatch.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Aligns the i-th record of one FASTA file with the i-th record of
+//  another, on a pool of threads, and writes one tab-separated line per
+//  pair.
+//
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "align.h"
+#include "bench.h"
+#include "fasta.h"
+
+// pairs read in before the threads are set to work on them
+#define BATCH_ROUND 4096
+
+// largest traceback matrix a thread builds; bigger pairs go to
+// hirschberg_align, or with affine gaps or another mode are only scored
+#define BATCH_MAX_TRACE_BYTES (64 << 20)
+
+// settings for every pair, from the command line
+static align_scoring scoring = DEFAULT_SCORING;
+static align_mode mode = ALIGN_GLOBAL;
+static long max_edits = -1;     // pairs further apart are not aligned
+
+// one query/target pair and, once aligned, its result
+struct batch_pair {
+    string query_name, target_name;
+    string query, target;
+    bool filtered;          // over max_edits apart, so not aligned
+    bool score_only;        // too big to trace back; only scored
+    align_result result;
+};
+
+/*
+ * @brief: Aligns one pair with the engine its size and the settings call
+ * for, reusing this thread's buffers. With -d, the edit distance is
+ * checked first and pairs too far apart are only marked. No traceback
+ * grows past BATCH_MAX_TRACE_BYTES, so neither do the buffers a thread
+ * keeps.
+ */
+void align_pair(batch_pair &pair, align_scratch &scratch)
+{
+    const string &s = pair.query, &t = pair.target;
+
+    double cells = (double) s.length() * t.length();
+
+    pair.filtered = max_edits >= 0 &&
+        !edit_distance_within(s, t, (size_t) max_edits);
+    pair.score_only = false;
+    if (pair.filtered)
+    {
+        pair.result = align_result();
+    }
+    else if (mode == ALIGN_GLOBAL &&
+        ungapped_align(s, t, scoring, pair.result))
+    {
+        // Near-identical DNA of one length needs no table at all.
+    }
+    else if (scoring.gap_open != 0 || mode != ALIGN_GLOBAL)
+    {
+        // Gotoh keeps four bits per cell, and has no linear-space
+        // traceback here, so a pair too big for that is only scored.
+        if (cells / 2 <= BATCH_MAX_TRACE_BYTES)
+        {
+            pair.result = gotoh_align(s, t, scoring, mode, &scratch);
+        }
+        else
+        {
+            pair.result = align_result();
+            pair.result.score = gotoh_score(s, t, scoring, mode);
+            pair.score_only = true;
+        }
+    }
+    else if (cells / 4 <= BATCH_MAX_TRACE_BYTES)
+    {
+        pair.result = nw_align(s, t, scoring, &scratch);
+    }
+    else
+    {
+        pair.result = hirschberg_align(s, t, scoring);
+    }
+}
+
+/*
+ * @brief: Threads that align a round of pairs together. The thread that
+ * calls run() takes its share as well, so a pool of n threads starts
+ * n - 1 of them. Each keeps its own scratch buffers, which grow to the
+ * largest pair it has seen and are then reused.
+ */
+class batch_pool
+{
+public:
+    batch_pool(int threads);
+    ~batch_pool();
+
+    void run(vector<batch_pair> &pairs, size_t count);
+
+private:
+    void work();
+    void drain(align_scratch &scratch);
+
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, finished;
+
+    vector<batch_pair> *round;  // pairs of the current round
+    size_t end;                 // how many of them are in use
+    atomic<size_t> next;        // first pair no thread has taken yet
+    size_t rounds;              // rounds started so far
+    int busy;                   // workers still on the current round
+    bool stopping;
+
+    align_scratch own;          // buffers of the calling thread
+};
+
+batch_pool::batch_pool(int threads)
+    : round(NULL), end(0), next(0), rounds(0), busy(0), stopping(false)
+{
+    for (int i = 1; i < threads; i++)
+    {
+        workers.push_back(thread(&batch_pool::work, this));
+    }
+}
+
+batch_pool::~batch_pool()
+{
+    {
+        lock_guard<mutex> hold(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+/*
+ * @brief: Aligns the first `count` pairs, returning once all are done.
+ */
+void batch_pool::run(vector<batch_pair> &pairs, size_t count)
+{
+    {
+        lock_guard<mutex> hold(lock);
+        round = &pairs;
+        end = count;
+        next = 0;
+        rounds++;
+        busy = (int) workers.size();
+    }
+    wake.notify_all();
+
+    drain(own);
+
+    unique_lock<mutex> hold(lock);
+    finished.wait(hold, [this] { return busy == 0; });
+}
+
+/*
+ * @brief: Takes pairs of the current round one at a time until none are
+ * left.
+ */
+void batch_pool::drain(align_scratch &scratch)
+{
+    size_t k;
+
+    while ((k = next++) < end)
+    {
+        align_pair((*round)[k], scratch);
+    }
+}
+
+/*
+ * @brief: Body of each worker: wait for a round, help with it, repeat.
+ */
+void batch_pool::work()
+{
+    align_scratch scratch;
+    size_t seen = 0;
+
+    for (;;)
+    {
+        {
+            unique_lock<mutex> hold(lock);
+            wake.wait(hold, [&] { return stopping || rounds != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = rounds;
+        }
+
+        drain(scratch);
+
+        lock_guard<mutex> hold(lock);
+        if (--busy == 0)
+        {
+            finished.notify_one();
+        }
+    }
+}
+
+/*
+ * @brief: Writes the result line of one pair: names, lengths, score,
+ * counts of matches, mismatches and gaps, and the run-length encoded
+ * instruction string. A pair left out by -d has '*' for its score and
+ * nothing after it; a pair too big to trace back has its score and
+ * nothing after it.
+ */
+void write_pair(FILE *out, const batch_pair &pair)
+{
+    const string &inst = pair.result.inst;
+
+    if (pair.filtered)
+    {
+        fprintf(out, "%s\t%s\t%zu\t%zu\t*\t\t\t\t\n",
+            pair.query_name.c_str(), pair.target_name.c_str(),
+            pair.query.length(), pair.target.length());
+        return;
+    }
+    if (pair.score_only)
+    {
+        fprintf(out, "%s\t%s\t%zu\t%zu\t%d\t\t\t\t\n",
+            pair.query_name.c_str(), pair.target_name.c_str(),
+            pair.query.length(), pair.target.length(), pair.result.score);
+        return;
+    }
+    fprintf(out, "%s\t%s\t%zu\t%zu\t%d\t%zu\t%zu\t%zu\t%s\n",
+        pair.query_name.c_str(), pair.target_name.c_str(),
+        pair.query.length(), pair.target.length(), pair.result.score,
+        (size_t) count(inst.begin(), inst.end(), '|'),
+        (size_t) count(inst.begin(), inst.end(), '*'),
+        (size_t) (count(inst.begin(), inst.end(), 's') +
+        count(inst.begin(), inst.end(), 't')),
+        run_length(inst).c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = (int) thread::hardware_concurrency();
+    FILE *out = stdout;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:g:o:x:m:M:d:")) != -1)
+    {
+        if (opt == 'j')
+        {
+            threads = atoi(optarg);
+        }
+        else if (opt == 'd')
+        {
+            max_edits = atol(optarg);
+        }
+        else if (opt == 'g')
+        {
+            scoring.gap_score = atoi(optarg);
+        }
+        else if (opt == 'o')
+        {
+            scoring.gap_open = atoi(optarg);
+        }
+        else if (opt == 'x')
+        {
+            scoring.mismatch = atoi(optarg);
+        }
+        else if (opt == 'm')
+        {
+            scoring.matching = atoi(optarg);
+        }
+        else if (opt == 'M' && strcmp(optarg, "global") == 0)
+        {
+            mode = ALIGN_GLOBAL;
+        }
+        else if (opt == 'M' && strcmp(optarg, "local") == 0)
+        {
+            mode = ALIGN_LOCAL;
+        }
+        else if (opt == 'M' && strcmp(optarg, "semi") == 0)
+        {
+            mode = ALIGN_SEMIGLOBAL;
+        }
+        else
+        {
+            optind = -1;
+            break;
+        }
+    }
+
+    if (optind < 0 || argc - optind < 2 || argc - optind > 3)
+    {
+        printf("usage: %s [-j threads] [-g gap] [-o gap open] [-x mismatch]"
+            " [-m match]\n"
+            "             [-M global|local|semi] [-d max edits]"
+            " <queries.fa> <targets.fa> [out.tsv]\n", argv[0]);
+        return 1;
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    fasta_reader queries(argv[optind]), targets(argv[optind + 1]);
+    if (!queries.ok() || !targets.ok())
+    {
+        printf("could not read %s or %s\n", argv[optind], argv[optind + 1]);
+        return 1;
+    }
+    if (argc - optind == 3 && (out = fopen(argv[optind + 2], "w")) == NULL)
+    {
+        printf("could not write %s\n", argv[optind + 2]);
+        return 1;
+    }
+
+    batch_pool pool(threads);
+    vector<batch_pair> pairs(BATCH_ROUND);
+    size_t total = 0, score_only = 0;
+    bool more = true;
+    double start = now();
+
+    fprintf(out, "#query\ttarget\tquery_length\ttarget_length\tscore"
+        "\tmatches\tmismatches\tgaps\talignment\n");
+
+    // Read a round, align it, write it out in input order, repeat.
+    while (more)
+    {
+        size_t count = 0;
+
+        while (count < BATCH_ROUND)
+        {
+            batch_pair &pair = pairs[count];
+            bool got_query = queries.next(pair.query_name, pair.query);
+            bool got_target = got_query &&
+                targets.next(pair.target_name, pair.target);
+
+            if (!got_target)
+            {
+                if (got_query || targets.next(pair.target_name, pair.target))
+                {
+                    fprintf(stderr, "%s and %s have different numbers of"
+                        " records; the extra ones are ignored\n",
+                        argv[optind], argv[optind + 1]);
+                }
+                more = false;
+                break;
+            }
+            count++;
+        }
+
+        pool.run(pairs, count);
+        for (size_t k = 0; k < count; k++)
+        {
+            write_pair(out, pairs[k]);
+            score_only += pairs[k].score_only;
+        }
+        total += count;
+    }
+
+    double seconds = now() - start;
+    fprintf(stderr, "%zu pairs on %d threads in %.2f s (%.0f pairs/s)\n",
+        total, threads, seconds, total / (seconds > 0 ? seconds : 1e-9));
+    if (score_only > 0)
+    {
+        fprintf(stderr, "%zu pairs were too big to trace back with these"
+            " settings and were only scored\n", score_only);
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
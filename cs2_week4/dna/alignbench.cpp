@@ -0,0 +1,363 @@
+//
+//  alignbench.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Runs every alignment engine on random DNA and mutated copies of it,
+//  from 100 to 1,000,000 bases, checks each score against a reference
+//  DP, and reports throughput and peak memory. Past the full-table
+//  budgets the reference is a banded DP whose band is proven wide enough.
+//
+//  Each engine runs in a child process, so its peak resident set can be
+//  read back from wait4() without the other engines' allocations mixed
+//  in; a child that does nothing gives the baseline subtracted from it.
+//
+#include <algorithm>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "align.h"
+#include "bench.h"
+#include "packed.h"
+
+// engines with quadratic time or memory skip inputs with more cells
+// than these
+#define REFERENCE_MAX_CELLS 2e9     // nw_score, the reference
+#define MATRIX_MAX_CELLS    4e8     // a full traceback matrix
+#define STRIPED_MAX_CELLS   2e10    // SIMD score
+#define MYERS_MAX_CELLS     1e11    // 64 cells per step
+#define BAND_MAX_CELLS      4e10    // the banded reference
+
+// band the banded reference first fills, for a score to size the band
+#define REFERENCE_FIRST_BAND    512
+
+// what an engine run sends back to the parent
+struct bench_run {
+    long score;
+    double seconds;
+};
+
+// an engine as the benchmark calls it
+struct bench_engine {
+    const char *name;
+    double max_cells;
+    bool edits;     // returns an edit distance, not a score
+    long (*run)(const string &s, const string &t);
+};
+
+static long run_nothing(const string &, const string &)
+{
+    return 0;
+}
+
+static long run_nw_score(const string &s, const string &t)
+{
+    return nw_score(s, t);
+}
+
+static long run_nw(const string &s, const string &t)
+{
+    return nw_align(s, t).score;
+}
+
+static long run_hirschberg(const string &s, const string &t)
+{
+    return hirschberg_align(s, t).score;
+}
+
+static long run_gotoh(const string &s, const string &t)
+{
+    return gotoh_align(s, t).score;
+}
+
+static long run_striped_score(const string &s, const string &t)
+{
+    return striped_global_score(s, t);
+}
+
+static long run_striped(const string &s, const string &t)
+{
+    return striped_align(s, t).score;
+}
+
+static long run_banded(const string &s, const string &t)
+{
+    return adaptive_banded_align(s, t).score;
+}
+
+static long run_myers(const string &s, const string &t)
+{
+    return (long) edit_distance(s, t);
+}
+
+static const bench_engine ENGINES[] = {
+    {"nw_score", REFERENCE_MAX_CELLS, false, run_nw_score},
+    {"nw_align", MATRIX_MAX_CELLS, false, run_nw},
+    {"hirschberg", REFERENCE_MAX_CELLS, false, run_hirschberg},
+    {"gotoh", MATRIX_MAX_CELLS, false, run_gotoh},
+    {"striped score", STRIPED_MAX_CELLS, false, run_striped_score},
+    {"striped", STRIPED_MAX_CELLS, false, run_striped},
+    {"adaptive banded", 1e300, false, run_banded},
+    {"myers edits", MYERS_MAX_CELLS, true, run_myers}
+};
+
+/*
+ * @brief: Runs an engine in a child process.
+ *
+ * @param peak_kb: Set to the child's peak resident set, in kilobytes.
+ *
+ * @return: False if the child failed (crashed, or ran out of memory).
+ */
+bool run_child(const bench_engine &engine, const string &s, const string &t,
+    bench_run &result, long &peak_kb)
+{
+    int fds[2];
+    struct rusage usage;
+    int status;
+
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        bench_run run;
+        double start = now();
+
+        close(fds[0]);
+        run.score = engine.run(s, t);
+        run.seconds = now() - start;
+        _exit(write(fds[1], &run, sizeof run) == sizeof run ? 0 : 1);
+    }
+
+    close(fds[1]);
+    bool got = read(fds[0], &result, sizeof result) == sizeof result;
+    close(fds[0]);
+
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0)
+    {
+        return false;
+    }
+    peak_kb = usage.ru_maxrss;
+    return got;
+}
+
+/*
+ * @brief: Best global score of s and t among the alignments that keep
+ * to banded_align's band, i.e. within `band` diagonals of the ones
+ * through the two corners. Scores only, in two rows; written apart from
+ * banded.cpp so that it checks the banded engines rather than sharing
+ * their code.
+ */
+long band_score(const string &s, const string &t, size_t band,
+    const align_scoring &scoring)
+{
+    long m = s.length(), n = t.length();
+    long lo = (n < m ? n - m : 0) - (long) band;
+    long hi = (n > m ? n - m : 0) + (long) band;
+    long width = hi - lo + 1;
+    int gap = scoring.gap_score;
+    const int outside = INT_MIN / 2;
+
+    // Row i holds the cells (i, i + lo + d) at d + 1, so d - 1 and d + 1
+    // always exist.
+    vector<int> prev(width + 2, outside), cur(width + 2, outside);
+
+    for (long d = 0; d < width; d++)
+    {
+        long j = lo + d;
+        if (j >= 0 && j <= n)
+        {
+            prev[d + 1] = (int) j * gap;
+        }
+    }
+
+    for (long i = 1; i <= m; i++)
+    {
+        // The cells of row i with 1 <= j <= n; the next row reads
+        // these and the one before them, which is j = 0 or outside.
+        long first = max(0L, 1 - i - lo), last = min(width - 1, n - i - lo);
+        long shift = i + lo - 1;
+        char c = s[i - 1];
+
+        if (first > 0)
+        {
+            cur[first] = (int) i * gap;
+        }
+
+        // Diagonal and vertical moves first, which vectorize; then the
+        // horizontal ones, left to right.
+        for (long d = first; d <= last; d++)
+        {
+            cur[d + 1] = max(prev[d + 1] + (c == t[shift + d] ?
+                scoring.matching : scoring.mismatch), prev[d + 2] + gap);
+        }
+        for (long d = first; d <= last; d++)
+        {
+            cur[d + 1] = max(cur[d + 1], cur[d] + gap);
+        }
+        prev.swap(cur);
+    }
+
+    return prev[n - m - lo + 1];
+}
+
+/*
+ * @brief: Reference score of s and t: the scalar DP while it is small
+ * enough, then band_score in a band proven wide enough. Neither shares
+ * code with the engines it checks, striped included.
+ *
+ * That band comes from a first pass in REFERENCE_FIRST_BAND: its score
+ * is reached by some alignment, so the best score is at least that, and
+ * any band in which band_outside_bound falls to it holds the optimum.
+ *
+ * @return: False if the pair is too big for any of them.
+ */
+bool reference_score(const string &s, const string &t,
+    const align_scoring &scoring, long &score)
+{
+    size_t m = s.length(), n = t.length();
+    double cells = (double) m * n;
+
+    if (cells <= REFERENCE_MAX_CELLS)
+    {
+        score = nw_score(s, t, scoring);
+        return true;
+    }
+    long floor = band_score(s, t, REFERENCE_FIRST_BAND, scoring);
+    size_t low = REFERENCE_FIRST_BAND, high = m > n ? m : n;
+
+    // the narrowest band whose outside cannot beat floor
+    while (low < high)
+    {
+        size_t band = low + (high - low) / 2;
+
+        if (band_outside_bound(m, n, band, scoring) <= floor)
+        {
+            high = band;
+        }
+        else
+        {
+            low = band + 1;
+        }
+    }
+
+    size_t diagonals = (m > n ? m - n : n - m) + 2 * low + 1;
+    if ((double) m * diagonals > BAND_MAX_CELLS)
+    {
+        return false;
+    }
+    score = band_score(s, t, low, scoring);
+    return score >= band_outside_bound(m, n, low, scoring);
+}
+
+/*
+ * @brief: Runs every engine on one pair and prints a line for each.
+ *
+ * @return: The number of engines whose score was wrong.
+ */
+int bench_pair(const string &s, const string &t)
+{
+    static const bench_engine BASELINE = {"", 0, false, run_nothing};
+    static const align_scoring UNIT_COST = {-1, -1, 0, 0};
+    double cells = (double) s.length() * t.length();
+    long score = 0, edits = 0, baseline_kb = 0;
+    bool have_score = reference_score(s, t, DEFAULT_SCORING, score);
+    bool have_edits = cells <= MYERS_MAX_CELLS &&
+        reference_score(s, t, UNIT_COST, edits);
+    bench_run run;
+    int failures = 0;
+
+    run_child(BASELINE, s, t, run, baseline_kb);
+
+    for (size_t e = 0; e < sizeof(ENGINES) / sizeof(ENGINES[0]); e++)
+    {
+        const bench_engine &engine = ENGINES[e];
+        long peak_kb;
+
+        if (cells > engine.max_cells)
+        {
+            continue;
+        }
+        if (!run_child(engine, s, t, run, peak_kb))
+        {
+            printf("%8zu  %-16s  failed\n", s.length(), engine.name);
+            failures++;
+            continue;
+        }
+
+        // edit distance is minus the unit-cost score
+        bool have = engine.edits ? have_edits : have_score;
+        long expected = engine.edits ? -edits : score;
+        const char *check = !have ? "-" :
+            run.score == expected ? "ok" : "WRONG";
+
+        printf("%8zu  %-16s %10ld  %-5s %9.3f %10.1f %9.1f\n", s.length(),
+            engine.name, run.score, check, run.seconds,
+            cells / (run.seconds > 0 ? run.seconds : 1e-9) / 1e6,
+            (peak_kb - baseline_kb) / 1024.0);
+        failures += have && run.score != expected;
+    }
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    double substitutions = 0.01, indels = 0.01;
+    size_t max_length = 1000000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:i:l:")) != -1)
+    {
+        if (opt == 's')
+        {
+            substitutions = atof(optarg);
+        }
+        else if (opt == 'i')
+        {
+            indels = atof(optarg);
+        }
+        else if (opt == 'l')
+        {
+            max_length = atol(optarg);
+        }
+        else
+        {
+            printf("usage: %s [-s substitution rate] [-i indel rate]"
+                " [-l max length]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("substitutions %.3f, indels %.3f per base; striped uses %s\n",
+        substitutions, indels, striped_isa());
+    printf("%8s  %-16s %10s  %-5s %9s %10s %9s\n", "length", "engine",
+        "score", "check", "seconds", "Mcells/s", "peak MB");
+
+    int failures = 0;
+    srand(2014);
+    for (size_t length = 100; length <= max_length; length *= 10)
+    {
+        string reference = random_dna(length);
+
+        failures += bench_pair(reference,
+            mutate(reference, substitutions, indels));
+    }
+
+    printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
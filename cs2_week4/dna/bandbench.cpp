@@ -0,0 +1,63 @@
+//
+//  bandbench.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Times the adaptive banded aligner against full Needleman-Wunsch on
+//  near-identical and on unrelated pairs of random DNA.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include "align.h"
+#include "bench.h"
+
+/*
+ * @brief: Aligns one pair both ways and prints the times.
+ *
+ * @return: 1 if the scores differ, else 0.
+ */
+int bench(const char *name, const string &s, const string &t)
+{
+    size_t band;
+    double start = now();
+    align_result full = nw_align(s, t);
+    double full_time = now() - start;
+
+    start = now();
+    align_result banded = adaptive_banded_align(s, t, DEFAULT_SCORING, &band);
+    double banded_time = now() - start;
+
+    printf("%-10s %6lu x %6lu  full %8.1f ms  banded %8.1f ms (band %6lu)"
+        "  %5.1fx  %s\n", name, (unsigned long) s.length(),
+        (unsigned long) t.length(), full_time * 1e3, banded_time * 1e3,
+        (unsigned long) band, full_time / banded_time,
+        full.score == banded.score ? "ok" : "SCORE DIFFERS");
+
+    return full.score == banded.score ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    static const size_t lengths[] = {1000, 10000, 30000};
+    size_t max = argc > 1 ? atol(argv[1]) : 30000;
+    int failures = 0;
+
+    srand(2014);
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        if (lengths[i] > max)
+        {
+            break;
+        }
+
+        string ref = random_dna(lengths[i]);
+
+        failures += bench("1% diff", ref, mutate(ref, 0.01 / 3, 0.02 / 3));
+        failures += bench("10% diff", ref, mutate(ref, 0.10 / 3, 0.20 / 3));
+        failures += bench("unrelated", ref, random_dna(lengths[i]));
+    }
+
+    printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
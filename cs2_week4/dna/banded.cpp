@@ -0,0 +1,237 @@
+//
+//  banded.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <limits.h>
+#include <vector>
+#include "align.h"
+#include "packed.h"
+
+// traceback moves, two bits per cell, as in nw.cpp
+#define MOVE_T      0
+#define MOVE_S      1
+#define MOVE_DIAG   2
+
+// score of a cell outside the band; far from INT_MIN so sums cannot wrap
+#define OUTSIDE     (INT_MIN / 2)
+
+// band adaptive_banded_align tries first
+#define ADAPTIVE_FIRST_BAND     8
+
+/*
+ * @brief: Aligns s and t like nw_align, but only fills the cells (i, j)
+ * with lo <= j - i <= hi, where the band runs `band` cells either side
+ * of the diagonals through (0, 0) and (|s|, |t|). That is O((m + n) *
+ * band) time and memory instead of O(m * n). The result is the best
+ * alignment that stays in the band, which is the best overall whenever
+ * the band is wide enough; ties are broken as in nw_align.
+ *
+ * @param s, t: The sequences to be aligned, as strings or packed DNA.
+ * @param band: Extra diagonals kept on each side.
+ * @param scoring: Gap, mismatch and match scores.
+ *
+ * @return: The best banded score and its instruction string.
+ */
+template <class S>
+static align_result band_fill(const S &s, const S &t, size_t band,
+    const align_scoring &scoring)
+{
+    long m = s.length(), n = t.length();
+    long lo = (n < m ? n - m : 0) - (long) band;
+    long hi = (n > m ? n - m : 0) + (long) band;
+    long width = hi - lo + 1;
+    int gap = scoring.gap_score;
+    align_result answer;
+
+    // Rows are indexed by d = j - i - lo, offset by one so d - 1 and
+    // d + 1 always exist.
+    vector<int> next(width + 2, OUTSIDE), cur(width + 2, OUTSIDE);
+    vector<unsigned char> moves((m * width + 3) / 4, 0);
+
+    // Last row: s is used up, so the rest of t is all gaps.
+    for (long d = 0; d < width; d++)
+    {
+        long j = m + lo + d;
+        if (j >= 0 && j <= n)
+        {
+            next[d + 1] = (int) (n - j) * gap;
+        }
+    }
+
+    for (long i = m; i-- > 0; )
+    {
+        for (long d = width; d-- > 0; )
+        {
+            long j = i + lo + d;
+
+            cur[d + 1] = OUTSIDE;
+            if (j < 0 || j > n)
+            {
+                continue;
+            }
+            if (j == n)
+            {
+                cur[d + 1] = (int) (m - i) * gap;
+                continue;
+            }
+
+            int score_t = cur[d + 2] + gap;
+            int score_s = next[d] + gap;
+            int score_d = next[d + 1] +
+                (s[i] == t[j] ? scoring.matching : scoring.mismatch);
+            int best = score_t, move = MOVE_T;
+
+            if (score_s > best)
+            {
+                best = score_s;
+                move = MOVE_S;
+            }
+            if (score_d > best)
+            {
+                best = score_d;
+                move = MOVE_DIAG;
+            }
+
+            size_t cell = (size_t) i * width + d;
+            moves[cell >> 2] |= move << ((cell & 3) << 1);
+            cur[d + 1] = best;
+        }
+
+        cur.swap(next);
+    }
+
+    answer.score = next[-lo + 1];
+    answer.inst.reserve(m + n);
+
+    // Follow the moves from (0, 0) to the far corner.
+    long i = 0, j = 0;
+    while (i < m || j < n)
+    {
+        int move;
+
+        if (i == m)
+        {
+            move = MOVE_T;
+        }
+        else if (j == n)
+        {
+            move = MOVE_S;
+        }
+        else
+        {
+            size_t cell = (size_t) i * width + (j - i - lo);
+            move = (moves[cell >> 2] >> ((cell & 3) << 1)) & 3;
+        }
+
+        if (move == MOVE_T)
+        {
+            answer.inst += 't';
+            j++;
+        }
+        else if (move == MOVE_S)
+        {
+            answer.inst += 's';
+            i++;
+        }
+        else
+        {
+            answer.inst += s[i] == t[j] ? '|' : '*';
+            i++;
+            j++;
+        }
+    }
+
+    return answer;
+}
+
+align_result banded_align(const string &s, const string &t, size_t band,
+    const align_scoring &scoring)
+{
+    return band_fill(s, t, band, scoring);
+}
+
+align_result banded_align(const packed_seq &s, const packed_seq &t,
+    size_t band, const align_scoring &scoring)
+{
+    return band_fill(s, t, band, scoring);
+}
+
+/*
+ * @brief: Best score any alignment of s and t could have if it strays
+ * outside the band of banded_align(s, t, band). Leaving the band means
+ * reaching a diagonal more than `band` past the ones through the two
+ * corners, which takes at least |m - n| + 2 * (band + 1) gaps, and each
+ * pair of extra gaps displaces one match or mismatch; the bound is the
+ * better of using the fewest gaps and using nothing but gaps.
+ *
+ * @return: The bound, or INT_MIN if no alignment can leave the band.
+ */
+long band_outside_bound(size_t m, size_t n, size_t band,
+    const align_scoring &scoring)
+{
+    long gaps = (long) (m > n ? m - n : n - m) + 2 * ((long) band + 1);
+    long best_pair = scoring.matching > scoring.mismatch ?
+        scoring.matching : scoring.mismatch;
+
+    if (gaps > (long) (m + n))
+    {
+        return INT_MIN;
+    }
+
+    long fewest = ((long) (m + n) - gaps) / 2 * best_pair +
+        gaps * scoring.gap_score;
+    long only_gaps = (long) (m + n) * scoring.gap_score;
+
+    return fewest > only_gaps ? fewest : only_gaps;
+}
+
+/*
+ * @brief: Aligns s and t in a band that starts narrow and doubles until
+ * no alignment outside it could score better than the best one inside,
+ * at which point the banded alignment is optimal. Near-identical pairs
+ * stop at the first band; unrelated ones end up doing full DP, a few
+ * times over.
+ *
+ * @param s, t: The sequences to be aligned, as strings or packed DNA.
+ * @param scoring: Gap, mismatch and match scores.
+ * @param band_used: If not NULL, set to the band that was enough.
+ *
+ * @return: The highest alignment score and its instruction string.
+ */
+template <class S>
+static align_result adaptive_band(const S &s, const S &t,
+    const align_scoring &scoring, size_t *band_used)
+{
+    size_t m = s.length(), n = t.length();
+    size_t longest = m > n ? m : n;
+    align_result answer;
+
+    for (size_t band = ADAPTIVE_FIRST_BAND; ; band *= 2)
+    {
+        answer = band_fill(s, t, band, scoring);
+
+        if (answer.score >= band_outside_bound(m, n, band, scoring) ||
+            band >= longest)
+        {
+            if (band_used != NULL)
+            {
+                *band_used = band;
+            }
+            return answer;
+        }
+    }
+}
+
+align_result adaptive_banded_align(const string &s, const string &t,
+    const align_scoring &scoring, size_t *band_used)
+{
+    return adaptive_band(s, t, scoring, band_used);
+}
+
+align_result adaptive_banded_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring, size_t *band_used)
+{
+    return adaptive_band(s, t, scoring, band_used);
+}
@@ -0,0 +1,68 @@
+//
+//  bench.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <stdlib.h>
+#include <sys/time.h>
+#include "bench.h"
+#include "packed.h"
+
+/*
+ * @brief: Current wall-clock time in seconds.
+ */
+double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/*
+ * @brief: Random DNA of the given length.
+ */
+string random_dna(size_t length)
+{
+    string seq(length, 'A');
+
+    for (size_t i = 0; i < length; i++)
+    {
+        seq[i] = "ACGT"[rand() % 4];
+    }
+    return seq;
+}
+
+/*
+ * @brief: Copy of seq in which each base is substituted (by a different
+ * base) with probability `substitutions`, and deleted or followed by an
+ * inserted base with probability `indels`, half each.
+ */
+string mutate(const string &seq, double substitutions, double indels)
+{
+    string out;
+
+    out.reserve(seq.length() + seq.length() / 10);
+    for (size_t i = 0; i < seq.length(); i++)
+    {
+        double r = rand() / (RAND_MAX + 1.0);
+
+        if (r < substitutions)
+        {
+            out += "ACGT"[(dna_code(seq[i]) + 1 + rand() % 3) % 4];
+        }
+        else if (r < substitutions + indels / 2)
+        {
+            continue;
+        }
+        else
+        {
+            out += seq[i];
+            if (r < substitutions + indels)
+            {
+                out += "ACGT"[rand() % 4];
+            }
+        }
+    }
+    return out;
+}
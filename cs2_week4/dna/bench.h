@@ -0,0 +1,21 @@
+//
+//  bench.h
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Timing and random-input helpers shared by the benchmarks, the batch
+//  tools and the testsuite.
+//
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <string>
+
+using namespace std;
+
+double now();
+string random_dna(size_t length);
+string mutate(const string &seq, double substitutions, double indels);
+
+#endif
@@ -0,0 +1,53 @@
+//
+//  fasta.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <ctype.h>
+#include "fasta.h"
+
+/*
+ * @brief: Reads the next record. Its name is the header up to the first
+ * space; whitespace inside the sequence is skipped.
+ *
+ * @return: False at the end of the file.
+ */
+bool fasta_reader::next(string &name, string &seq)
+{
+    string line;
+
+    while (header.empty() && getline(in, line))
+    {
+        if (!line.empty() && line[0] == '>')
+        {
+            header = line;
+        }
+    }
+    if (header.empty())
+    {
+        return false;
+    }
+
+    size_t end = header.find_first_of(" \t\r", 1);
+    name = header.substr(1, end == string::npos ? end : end - 1);
+    header.clear();
+    seq.clear();
+
+    while (getline(in, line))
+    {
+        if (!line.empty() && line[0] == '>')
+        {
+            header = line;
+            break;
+        }
+        for (size_t i = 0; i < line.length(); i++)
+        {
+            if (!isspace((unsigned char) line[i]))
+            {
+                seq += line[i];
+            }
+        }
+    }
+    return true;
+}
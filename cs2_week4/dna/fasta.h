@@ -0,0 +1,32 @@
+//
+//  fasta.h
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#ifndef __FASTA_H__
+#define __FASTA_H__
+
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+/*
+ * @brief: Reads a FASTA file one record at a time, so that input of any
+ * size streams through a fixed amount of memory.
+ */
+class fasta_reader
+{
+public:
+    fasta_reader(const char *filename) : in(filename) {}
+
+    bool ok() const { return (bool) in; }
+    bool next(string &name, string &seq);
+
+private:
+    ifstream in;
+    string header;  // header line of the next record, once it is read
+};
+
+#endif
@@ -0,0 +1,314 @@
+//
+//  gotoh.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <algorithm>
+#include <limits.h>
+#include <vector>
+#include "align.h"
+#include "packed.h"
+
+// where the best score of a cell came from, in the low two bits
+#define FROM_DIAG   0   // match or mismatch
+#define FROM_T      1   // a run of gaps in s (characters of t) ends here
+#define FROM_S      2   // a run of gaps in t (characters of s) ends here
+#define FROM_START  3   // a local alignment starts here
+
+// set when the run of gaps through a cell continues the one before it
+#define EXTEND_T    4
+#define EXTEND_S    8
+
+// low enough that adding a few gaps to it cannot wrap around
+#define NEG_INF     (INT_MIN / 2)
+
+// each column of the row above holds its best score, then its best
+// score ending in a gap in t
+#define BEST        0
+#define GAP_S       1
+
+/*
+ * @brief: Aligns s and t with Gotoh's algorithm: a run of k gaps scores
+ * gap_open + k * gap_score, so one long gap beats many short ones.
+ *
+ * The three matrices (best overall, best ending in a gap in s, best
+ * ending in a gap in t) are filled together, one cell at a time. The
+ * previous row keeps the overall and gap-in-t scores side by side, and
+ * the gap-in-s score runs along the row in a register, so each cell
+ * touches one 8-byte slot. Its traceback is four bits: which matrix the
+ * best score came from, and whether each gap run opens or extends.
+ *
+ * @param s, t: The sequences to be aligned, as strings or packed DNA.
+ * @param scoring: Gap, gap opening, mismatch and match scores.
+ * @param mode: Global, local, or semi-global (free overhangs).
+ * @param scratch: Buffers to reuse, or NULL to allocate them.
+ *
+ * @return: The score and the instruction string. Characters outside a
+ * local or semi-global alignment are given as 's' and 't' at the ends.
+ */
+template <class S>
+static align_result gotoh_fill(const S &s, const S &t,
+    const align_scoring &scoring, align_mode mode, align_scratch *scratch)
+{
+    size_t m = s.length(), n = t.length();
+    int open = scoring.gap_open + scoring.gap_score;
+    int extend = scoring.gap_score;
+    bool global = mode == ALIGN_GLOBAL, local = mode == ALIGN_LOCAL;
+    align_scratch own;
+    align_scratch &work = scratch ? *scratch : own;
+    size_t best_i = 0, best_j = 0;
+    int best = local ? 0 : NEG_INF;
+    align_result answer;
+
+    work.rows.resize(2 * (n + 1));
+    work.trace.assign((m * n + 1) / 2, 0);
+    int *row = work.rows.data();
+    unsigned char *trace = work.trace.data();
+
+    // Row 0: only gaps in s, free unless the alignment is global.
+    row[BEST] = 0;
+    row[GAP_S] = NEG_INF;
+    for (size_t j = 1; j <= n; j++)
+    {
+        row[2 * j + BEST] = global ? open + (int) (j - 1) * extend : 0;
+        row[2 * j + GAP_S] = NEG_INF;
+    }
+
+    for (size_t i = 1; i <= m; i++)
+    {
+        // A semi-global alignment may end in the last column.
+        if (mode == ALIGN_SEMIGLOBAL && row[2 * n + BEST] > best)
+        {
+            best = row[2 * n + BEST];
+            best_i = i - 1;
+            best_j = n;
+        }
+
+        int diag = row[BEST];
+        int gap_t = NEG_INF;
+        int c = s[i - 1];
+        size_t cell = (i - 1) * n;
+
+        row[BEST] = global ? open + (int) (i - 1) * extend : 0;
+
+        for (size_t j = 1; j <= n; j++, cell++)
+        {
+            int *here = row + 2 * j;
+
+            // gap in s: open from the cell to the left or extend its run
+            int opened = here[BEST - 2] + open;
+            gap_t += extend;
+            int flags = gap_t > opened ? EXTEND_T : 0;
+            gap_t = gap_t > opened ? gap_t : opened;
+
+            // gap in t: the same from the cell above
+            opened = here[BEST] + open;
+            int gap_s = here[GAP_S] + extend;
+            flags |= gap_s > opened ? EXTEND_S : 0;
+            gap_s = gap_s > opened ? gap_s : opened;
+            here[GAP_S] = gap_s;
+
+            // best of the three, written without branches since the
+            // winner changes unpredictably from cell to cell
+            int h = diag + (c == t[j - 1] ? scoring.matching :
+                scoring.mismatch);
+            int from = gap_t > h ? FROM_T : FROM_DIAG;
+            h = gap_t > h ? gap_t : h;
+            from = gap_s > h ? FROM_S : from;
+            h = gap_s > h ? gap_s : h;
+            if (local)
+            {
+                from = h < 0 ? FROM_START : from;
+                h = h < 0 ? 0 : h;
+            }
+
+            diag = here[BEST];
+            here[BEST] = h;
+            trace[cell >> 1] |= (flags | from) << ((cell & 1) << 2);
+
+            if (local && h > best)
+            {
+                best = h;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+
+    // Where the alignment ends.
+    if (global)
+    {
+        best = row[2 * n + BEST];
+        best_i = m;
+        best_j = n;
+    }
+    else if (mode == ALIGN_SEMIGLOBAL)
+    {
+        for (size_t j = 0; j <= n; j++)
+        {
+            if (row[2 * j + BEST] > best)
+            {
+                best = row[2 * j + BEST];
+                best_i = m;
+                best_j = j;
+            }
+        }
+    }
+
+    // Trace back to the first row or column, or to where a local
+    // alignment starts, building the instructions back to front.
+    size_t i = best_i, j = best_j;
+    int state = FROM_DIAG;
+    string core;
+
+    while (i > 0 && j > 0)
+    {
+        size_t cell = (i - 1) * n + (j - 1);
+        int bits = (trace[cell >> 1] >> ((cell & 1) << 2)) & 15;
+
+        if (state == FROM_DIAG)
+        {
+            state = bits & 3;
+            if (state == FROM_START)
+            {
+                break;
+            }
+            if (state == FROM_DIAG)
+            {
+                core += s[i - 1] == t[j - 1] ? '|' : '*';
+                i--;
+                j--;
+                continue;
+            }
+        }
+
+        // inside a run of gaps; it began here unless it extends
+        if (state == FROM_T)
+        {
+            core += 't';
+            state = bits & EXTEND_T ? FROM_T : FROM_DIAG;
+            j--;
+        }
+        else
+        {
+            core += 's';
+            state = bits & EXTEND_S ? FROM_S : FROM_DIAG;
+            i--;
+        }
+    }
+
+    // Whatever is left before and after is gaps; in a global alignment
+    // the row or column it runs along was already scored as such.
+    answer.score = best;
+    answer.inst.reserve(m + n);
+    answer.inst.append(i, 's');
+    answer.inst.append(j, 't');
+    answer.inst.append(core.rbegin(), core.rend());
+    answer.inst.append(m - best_i, 's');
+    answer.inst.append(n - best_j, 't');
+
+    return answer;
+}
+
+align_result gotoh_align(const string &s, const string &t,
+    const align_scoring &scoring, align_mode mode, align_scratch *scratch)
+{
+    return gotoh_fill(s, t, scoring, mode, scratch);
+}
+
+align_result gotoh_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring, align_mode mode, align_scratch *scratch)
+{
+    return gotoh_fill(s, t, scoring, mode, scratch);
+}
+
+/*
+ * @brief: Score of the alignment gotoh_align would find, in linear
+ * space: the same recurrences, with no traceback kept.
+ *
+ * @param s, t: The sequences to be scored.
+ * @param scoring: Gap, gap opening, mismatch and match scores.
+ * @param mode: Global, local, or semi-global (free overhangs).
+ *
+ * @return: The best score.
+ */
+template <class S>
+static int gotoh_linear(const S &s, const S &t,
+    const align_scoring &scoring, align_mode mode)
+{
+    size_t m = s.length(), n = t.length();
+    int open = scoring.gap_open + scoring.gap_score;
+    int extend = scoring.gap_score;
+    bool global = mode == ALIGN_GLOBAL, local = mode == ALIGN_LOCAL;
+    int best = local ? 0 : NEG_INF;
+    vector<int> rows(2 * (n + 1));
+    int *row = rows.data();
+
+    row[BEST] = 0;
+    row[GAP_S] = NEG_INF;
+    for (size_t j = 1; j <= n; j++)
+    {
+        row[2 * j + BEST] = global ? open + (int) (j - 1) * extend : 0;
+        row[2 * j + GAP_S] = NEG_INF;
+    }
+
+    for (size_t i = 1; i <= m; i++)
+    {
+        if (mode == ALIGN_SEMIGLOBAL)
+        {
+            best = max(best, row[2 * n + BEST]);
+        }
+
+        int diag = row[BEST];
+        int gap_t = NEG_INF;
+        int c = s[i - 1];
+
+        row[BEST] = global ? open + (int) (i - 1) * extend : 0;
+
+        for (size_t j = 1; j <= n; j++)
+        {
+            int *here = row + 2 * j;
+
+            gap_t = max(gap_t + extend, here[BEST - 2] + open);
+            here[GAP_S] = max(here[GAP_S] + extend, here[BEST] + open);
+
+            int h = diag + (c == t[j - 1] ? scoring.matching :
+                scoring.mismatch);
+            h = max(h, max(gap_t, here[GAP_S]));
+            if (local)
+            {
+                h = max(h, 0);
+                best = max(best, h);
+            }
+
+            diag = here[BEST];
+            here[BEST] = h;
+        }
+    }
+
+    if (global)
+    {
+        return row[2 * n + BEST];
+    }
+    if (mode == ALIGN_SEMIGLOBAL)
+    {
+        for (size_t j = 0; j <= n; j++)
+        {
+            best = max(best, row[2 * j + BEST]);
+        }
+    }
+    return best;
+}
+
+int gotoh_score(const string &s, const string &t,
+    const align_scoring &scoring, align_mode mode)
+{
+    return gotoh_linear(s, t, scoring, mode);
+}
+
+int gotoh_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring, align_mode mode)
+{
+    return gotoh_linear(s, t, scoring, mode);
+}
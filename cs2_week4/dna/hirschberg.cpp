@@ -0,0 +1,213 @@
+//
+//  hirschberg.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <vector>
+#include "align.h"
+#include "packed.h"
+
+// blocks with at most this many cells are aligned with nw_align
+#define HIRSCHBERG_BASE_CELLS   (1 << 16)
+
+// state shared by one Hirschberg alignment of two strings, or of two
+// stretches of packed DNA
+template <class S>
+struct hirschberg_state {
+    const S *a, *b;                 // a is the longer sequence
+    const align_scoring *scoring;
+    bool swapped;                   // a is t and b is s
+    vector<int> forward, reverse;   // score rows, |b| + 1 each
+    string inst;
+};
+
+/*
+ * @brief: Scores a[a0..a1) against every prefix of b[b0..b1), leaving
+ * the best score for b[b0..b0 + j) in row[j].
+ */
+template <class S>
+static void forward_scores(hirschberg_state<S> &st, size_t a0, size_t a1,
+    size_t b0, size_t b1, vector<int> &row)
+{
+    const S &a = *st.a, &b = *st.b;
+    const align_scoring &sc = *st.scoring;
+    size_t n = b1 - b0;
+
+    row[0] = 0;
+    for (size_t j = 1; j <= n; j++)
+    {
+        row[j] = row[j - 1] + sc.gap_score;
+    }
+
+    for (size_t i = a0; i < a1; i++)
+    {
+        int diag = row[0];
+        row[0] += sc.gap_score;
+
+        for (size_t j = 1; j <= n; j++)
+        {
+            int up = row[j];
+            int best = diag + (a[i] == b[b0 + j - 1] ? sc.matching :
+                sc.mismatch);
+
+            if (up + sc.gap_score > best)
+            {
+                best = up + sc.gap_score;
+            }
+            if (row[j - 1] + sc.gap_score > best)
+            {
+                best = row[j - 1] + sc.gap_score;
+            }
+
+            diag = up;
+            row[j] = best;
+        }
+    }
+}
+
+/*
+ * @brief: Scores a[a0..a1) against every suffix of b[b0..b1), leaving
+ * the best score for b[b0 + j..b1) in row[j].
+ */
+template <class S>
+static void reverse_scores(hirschberg_state<S> &st, size_t a0, size_t a1,
+    size_t b0, size_t b1, vector<int> &row)
+{
+    const S &a = *st.a, &b = *st.b;
+    const align_scoring &sc = *st.scoring;
+    size_t n = b1 - b0;
+
+    row[n] = 0;
+    for (size_t j = n; j-- > 0; )
+    {
+        row[j] = row[j + 1] + sc.gap_score;
+    }
+
+    for (size_t i = a1; i-- > a0; )
+    {
+        int diag = row[n];
+        row[n] += sc.gap_score;
+
+        for (size_t j = n; j-- > 0; )
+        {
+            int down = row[j];
+            int best = diag + (a[i] == b[b0 + j] ? sc.matching :
+                sc.mismatch);
+
+            if (down + sc.gap_score > best)
+            {
+                best = down + sc.gap_score;
+            }
+            if (row[j + 1] + sc.gap_score > best)
+            {
+                best = row[j + 1] + sc.gap_score;
+            }
+
+            diag = down;
+            row[j] = best;
+        }
+    }
+}
+
+/*
+ * @brief: Appends the alignment of a[a0..a1) and b[b0..b1) to st.inst.
+ * Splits a in half, finds where an optimal alignment crosses the middle
+ * row by meeting a forward and a reverse pass there, and recurses on
+ * the two corners; small blocks go to nw_align.
+ */
+template <class S>
+static void hirschberg(hirschberg_state<S> &st, size_t a0, size_t a1,
+    size_t b0, size_t b1)
+{
+    size_t m = a1 - a0, n = b1 - b0;
+
+    if (m <= 1 || n <= 1 || m * n <= HIRSCHBERG_BASE_CELLS)
+    {
+        string inst = nw_align(st.a->substr(a0, m), st.b->substr(b0, n),
+            *st.scoring).inst;
+
+        // nw_align named a's gaps 's' and b's 't'; swap them back.
+        if (st.swapped)
+        {
+            for (size_t k = 0; k < inst.length(); k++)
+            {
+                if (inst[k] == 's')
+                {
+                    inst[k] = 't';
+                }
+                else if (inst[k] == 't')
+                {
+                    inst[k] = 's';
+                }
+            }
+        }
+        st.inst += inst;
+        return;
+    }
+
+    size_t mid = a0 + m / 2, split = 0;
+    int best = 0;
+
+    forward_scores(st, a0, mid, b0, b1, st.forward);
+    reverse_scores(st, mid, a1, b0, b1, st.reverse);
+
+    for (size_t j = 0; j <= n; j++)
+    {
+        int score = st.forward[j] + st.reverse[j];
+
+        if (j == 0 || score > best)
+        {
+            best = score;
+            split = j;
+        }
+    }
+
+    hirschberg(st, a0, mid, b0, b0 + split);
+    hirschberg(st, mid, a1, b0 + split, b1);
+}
+
+/*
+ * @brief: Aligns s and t with Hirschberg's divide-and-conquer algorithm.
+ * The score rows span the shorter string only, so memory is
+ * O(min(|s|, |t|)) on top of the result, at about twice the work of
+ * nw_align. Among equally good alignments it may pick a different one.
+ *
+ * @param s, t: The sequences to be aligned, as strings or packed DNA.
+ * @param scoring: Gap, mismatch and match scores.
+ *
+ * @return: The highest alignment score and its instruction string.
+ */
+template <class S>
+static align_result hirschberg_run(const S &s, const S &t,
+    const align_scoring &scoring)
+{
+    hirschberg_state<S> st;
+    align_result answer;
+
+    st.swapped = t.length() > s.length();
+    st.a = st.swapped ? &t : &s;
+    st.b = st.swapped ? &s : &t;
+    st.scoring = &scoring;
+    st.forward.resize(st.b->length() + 1);
+    st.reverse.resize(st.b->length() + 1);
+    st.inst.reserve(s.length() + t.length());
+
+    hirschberg(st, 0, st.a->length(), 0, st.b->length());
+
+    answer.inst.swap(st.inst);
+    answer.score = score_alignment(s, t, answer.inst, scoring);
+    return answer;
+}
+
+align_result hirschberg_align(const string &s, const string &t,
+    const align_scoring &scoring)
+{
+    return hirschberg_run(s, t, scoring);
+}
+
+align_result hirschberg_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring)
+{
+    return hirschberg_run(s, t, scoring);
+}
@@ -0,0 +1,763 @@
+//
+//  kmer_index.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <algorithm>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "kmer_index.h"
+#include "packed.h"
+
+// first bytes of an index file; the digit is the format version
+#define KMER_MAGIC      "DNAKMER3"
+
+// most buckets an index may have (2^KMER_MAX_HASH_BITS)
+#define KMER_MAX_HASH_BITS  30
+
+// chaining: how many earlier seeds each seed looks back at, and how far
+// apart two chained seeds' diagonals may be (the indels between them)
+#define CHAIN_LOOKBACK  64
+#define CHAIN_MAX_SHIFT 32
+
+// one exact k-mer hit: read offset q matches reference position p, in
+// record r
+struct kmer_seed {
+    uint32_t q, p, r;
+
+    bool operator<(const kmer_seed &other) const
+    {
+        return p != other.p ? p < other.p : q < other.q;
+    }
+};
+
+// header of an index that holds nothing, so the getters work before
+// build() or load()
+static const kmer_index_header EMPTY_HEADER = {{0}, 0, 0, 0, 0, 0, 0};
+
+/*
+ * @brief: Bucket of a k-mer: Fibonacci hashing, the top hash_bits bits
+ * of the k-mer times 2^64 / phi.
+ */
+static inline size_t bucket_of(uint64_t kmer, int hash_bits)
+{
+    return (size_t) ((kmer * 0x9E3779B97F4A7C15ULL) >> (64 - hash_bits));
+}
+
+/*
+ * @brief: 2-bit code of a base of either case, so that soft-masked
+ * (lower-case) sequence codes like the rest; -1 for anything but ACGT.
+ */
+static inline int base_code(char c)
+{
+    return dna_code((char) toupper((unsigned char) c));
+}
+
+/*
+ * @brief: Words of the mask that marks the bases other than ACGT.
+ */
+static inline size_t mask_words(size_t length)
+{
+    return (length + 63) / 64;
+}
+
+/*
+ * @brief: Bits of a packed k-mer.
+ */
+static inline uint64_t kmer_mask(int k)
+{
+    return k >= 32 ? ~0ULL : (1ULL << (2 * k)) - 1;
+}
+
+/*
+ * @brief: Size in bytes of an index image, each part padded to 8 bytes.
+ */
+static size_t image_size(size_t length, int hash_bits, size_t count,
+    size_t records, size_t names)
+{
+    size_t words = (length + PACKED_BASES - 1) / PACKED_BASES +
+        mask_words(length);
+    size_t offsets = ((((size_t) 1 << hash_bits) + 1) * 4 + 7) / 8;
+    size_t positions = (count * 4 + 7) / 8;
+    size_t table = ((records + 1) * 4 + 7) / 8;
+
+    return sizeof(kmer_index_header) + 8 * (words + offsets + positions +
+        2 * table + (names + 7) / 8);
+}
+
+kmer_index::kmer_index()
+    : header(&EMPTY_HEADER), words(NULL), unknown(NULL), offsets(NULL),
+      positions(NULL),
+      record_starts(NULL), name_offsets(NULL), record_names(NULL),
+      bytes(0), mapping(NULL)
+{
+}
+
+kmer_index::~kmer_index()
+{
+    release();
+}
+
+/*
+ * @brief: Drops the current image, unmapping it if it came from a file.
+ */
+void kmer_index::release()
+{
+    if (mapping != NULL)
+    {
+        munmap(mapping, bytes);
+        mapping = NULL;
+    }
+    owned.clear();
+    header = &EMPTY_HEADER;
+    words = unknown = NULL;
+    offsets = positions = record_starts = name_offsets = NULL;
+    record_names = NULL;
+    bytes = 0;
+}
+
+/*
+ * @brief: Points the index at an image after checking that it is one:
+ * that its parts fit in `size` bytes, that the bucket offsets and the
+ * record table only go forward, and that every position holds a whole
+ * k-mer of the reference. This reads the whole image once.
+ *
+ * @return: False if the image is not a valid index.
+ */
+bool kmer_index::attach(const void *image, size_t size)
+{
+    const kmer_index_header *h = (const kmer_index_header *) image;
+
+    if (size < sizeof(kmer_index_header) ||
+        memcmp(h->magic, KMER_MAGIC, 8) != 0 ||
+        h->k < 1 || h->k > KMER_MAX_K ||
+        h->hash_bits < 1 || h->hash_bits > KMER_MAX_HASH_BITS ||
+        h->length > UINT32_MAX || h->count > h->length ||
+        h->records < 1 || h->records > UINT32_MAX ||
+        h->names < h->records || h->names > UINT32_MAX ||
+        image_size(h->length, h->hash_bits, h->count, h->records,
+            h->names) != size)
+    {
+        return false;
+    }
+
+    const uint64_t *body = (const uint64_t *) (h + 1);
+    size_t word_count = (h->length + PACKED_BASES - 1) / PACKED_BASES;
+    size_t buckets = (size_t) 1 << h->hash_bits;
+    size_t table = ((h->records + 1) * 4 + 7) / 8;
+    const uint64_t *unk = body + word_count;
+    const uint32_t *offs = (const uint32_t *) (unk + mask_words(h->length));
+    const uint64_t *rest = unk + mask_words(h->length) +
+        ((buckets + 1) * 4 + 7) / 8;
+    const uint32_t *pos = (const uint32_t *) rest;
+    rest += (h->count * 4 + 7) / 8;
+    const uint32_t *starts = (const uint32_t *) rest;
+    const uint32_t *name_offs = (const uint32_t *) (rest + table);
+    const char *names = (const char *) (rest + 2 * table);
+
+    if (offs[0] != 0 || offs[buckets] != h->count)
+    {
+        return false;
+    }
+    for (size_t b = 0; b < buckets; b++)
+    {
+        if (offs[b] > offs[b + 1])
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < h->count; i++)
+    {
+        if ((uint64_t) pos[i] + h->k > h->length)
+        {
+            return false;
+        }
+    }
+
+    // Records tile the reference; each name ends in its own '\0'.
+    if (starts[0] != 0 || starts[h->records] != h->length ||
+        name_offs[0] != 0 || name_offs[h->records] != h->names)
+    {
+        return false;
+    }
+    for (size_t r = 0; r < h->records; r++)
+    {
+        if (starts[r] > starts[r + 1] || name_offs[r] >= name_offs[r + 1] ||
+            names[name_offs[r + 1] - 1] != '\0')
+        {
+            return false;
+        }
+    }
+
+    header = h;
+    words = body;
+    unknown = unk;
+    offsets = offs;
+    positions = pos;
+    record_starts = starts;
+    name_offsets = name_offs;
+    record_names = names;
+    bytes = size;
+    return true;
+}
+
+/*
+ * @brief: Indexes every k-mer of a reference of one record, with an
+ * empty name.
+ */
+bool kmer_index::build(const string &reference, int k)
+{
+    return build(reference, vector<size_t>(1, 0), vector<string>(1, ""),
+        k);
+}
+
+/*
+ * @brief: Indexes every k-mer of a reference.
+ *
+ * Two passes counting-sort the k-mer start positions by bucket, so each
+ * bucket's positions end up together and in increasing order, and the
+ * whole index is a handful of flat arrays. A k-mer that would run from
+ * one record into the next is not indexed.
+ *
+ * @param reference: The records end to end, at most 2^32 - 1 bases.
+ * @param starts: Where each record starts in reference, the first at 0.
+ * @param names: Each record's name.
+ * @param k: The k-mer length, 1 to KMER_MAX_K.
+ *
+ * @return: False if k, the reference length or the records are out of
+ * range.
+ */
+bool kmer_index::build(const string &reference, const vector<size_t> &starts,
+    const vector<string> &names, int k)
+{
+    size_t length = reference.length();
+    size_t word_count = (length + PACKED_BASES - 1) / PACKED_BASES;
+    size_t records = starts.size();
+    uint64_t mask = kmer_mask(k);
+    size_t count = 0, run = 0, name_bytes = 0;
+
+    if (k < 1 || k > KMER_MAX_K || length > UINT32_MAX ||
+        records < 1 || records != names.size() || starts[0] != 0)
+    {
+        return false;
+    }
+    for (size_t r = 0; r < records; r++)
+    {
+        if (starts[r] > (r + 1 < records ? starts[r + 1] : length))
+        {
+            return false;
+        }
+        name_bytes += names[r].length() + 1;
+    }
+    if (records > UINT32_MAX || name_bytes > UINT32_MAX)
+    {
+        return false;
+    }
+
+    // Count the k-mers made only of ACGT and inside one record.
+    size_t next = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        while (next < records && starts[next] == i)
+        {
+            run = 0;
+            next++;
+        }
+        run = base_code(reference[i]) < 0 ? 0 : run + 1;
+        if (run >= (size_t) k)
+        {
+            count++;
+        }
+    }
+
+    // About one k-mer per bucket.
+    int hash_bits = 1;
+    while (hash_bits < KMER_MAX_HASH_BITS &&
+        ((size_t) 1 << hash_bits) < count)
+    {
+        hash_bits++;
+    }
+    size_t buckets = (size_t) 1 << hash_bits;
+    size_t table = ((records + 1) * 4 + 7) / 8;
+
+    release();
+    bytes = image_size(length, hash_bits, count, records, name_bytes);
+    owned.assign(bytes / 8, 0);
+
+    kmer_index_header *h = (kmer_index_header *) owned.data();
+    uint64_t *packed = (uint64_t *) (h + 1);
+    uint64_t *unk = packed + word_count;
+    uint32_t *offs = (uint32_t *) (unk + mask_words(length));
+    uint64_t *rest = unk + mask_words(length) + ((buckets + 1) * 4 + 7) / 8;
+    uint32_t *pos = (uint32_t *) rest;
+    rest += (count * 4 + 7) / 8;
+    uint32_t *starts_out = (uint32_t *) rest;
+    uint32_t *name_offs = (uint32_t *) (rest + table);
+    char *names_out = (char *) (rest + 2 * table);
+
+    memcpy(h->magic, KMER_MAGIC, 8);
+    h->k = k;
+    h->hash_bits = hash_bits;
+    h->length = length;
+    h->count = count;
+    h->records = records;
+    h->names = name_bytes;
+
+    // The record table: starts, then the names one after another.
+    name_bytes = 0;
+    for (size_t r = 0; r < records; r++)
+    {
+        starts_out[r] = (uint32_t) starts[r];
+        name_offs[r] = (uint32_t) name_bytes;
+        memcpy(names_out + name_bytes, names[r].c_str(),
+            names[r].length() + 1);
+        name_bytes += names[r].length() + 1;
+    }
+    starts_out[records] = (uint32_t) length;
+    name_offs[records] = (uint32_t) name_bytes;
+
+    // Pack the reference, marking the bases other than ACGT, and count
+    // each bucket's k-mers, the k-mer ending at base i rolling in from
+    // the top.
+    uint64_t kmer = 0;
+    run = 0;
+    next = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        int code = base_code(reference[i]);
+
+        while (next < records && starts[next] == i)
+        {
+            run = 0;
+            next++;
+        }
+        run = code < 0 ? 0 : run + 1;
+        if (code < 0)
+        {
+            unk[i / 64] |= 1ULL << (i % 64);
+            code = 0;
+        }
+        packed[i / PACKED_BASES] |= (uint64_t) code <<
+            (2 * (i % PACKED_BASES));
+        kmer = ((kmer >> 2) | ((uint64_t) code << (2 * (k - 1)))) & mask;
+
+        if (run >= (size_t) k)
+        {
+            offs[bucket_of(kmer, hash_bits) + 1]++;
+        }
+    }
+
+    for (size_t b = 0; b < buckets; b++)
+    {
+        offs[b + 1] += offs[b];
+    }
+
+    // Place the positions, rolling the k-mers through a second time.
+    vector<uint32_t> fill(offs, offs + buckets);
+    kmer = 0;
+    run = 0;
+    next = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        int code = base_code(reference[i]);
+
+        while (next < records && starts[next] == i)
+        {
+            run = 0;
+            next++;
+        }
+        run = code < 0 ? 0 : run + 1;
+        kmer = ((kmer >> 2) | ((uint64_t) (code < 0 ? 0 : code) <<
+            (2 * (k - 1)))) & mask;
+        if (run >= (size_t) k)
+        {
+            pos[fill[bucket_of(kmer, hash_bits)]++] = (uint32_t) (i + 1 - k);
+        }
+    }
+
+    return attach(h, bytes);
+}
+
+/*
+ * @brief: Writes the index image to a file.
+ *
+ * @return: False if the file could not be written.
+ */
+bool kmer_index::save(const char *filename) const
+{
+    FILE *f = fopen(filename, "wb");
+    bool ok;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+    ok = fwrite(header, 1, bytes, f) == bytes;
+    return fclose(f) == 0 && ok;
+}
+
+/*
+ * @brief: Maps an index file into memory and checks it in place; the
+ * image is never parsed or copied.
+ *
+ * @return: False if the file could not be mapped or is not an index.
+ */
+bool kmer_index::load(const char *filename)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+
+    release();
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+    {
+        return false;
+    }
+
+    mapping = image;
+    bytes = st.st_size;
+    if (!attach(image, st.st_size))
+    {
+        release();
+        return false;
+    }
+    return true;
+}
+
+/*
+ * @brief: Reference positions stored in a k-mer's bucket. Other k-mers
+ * that hash to the same bucket are there too; check with kmer_at().
+ *
+ * @return: How many positions hits points to.
+ */
+size_t kmer_index::lookup(uint64_t kmer, const uint32_t *&hits) const
+{
+    if (header->count == 0)
+    {
+        hits = NULL;
+        return 0;
+    }
+
+    size_t b = bucket_of(kmer, header->hash_bits);
+    hits = positions + offsets[b];
+    return offsets[b + 1] - offsets[b];
+}
+
+/*
+ * @brief: The packed k-mer starting at reference position pos.
+ */
+uint64_t kmer_index::kmer_at(size_t pos) const
+{
+    size_t word_count = (header->length + PACKED_BASES - 1) / PACKED_BASES;
+
+    return packed_window(words, word_count, pos) & kmer_mask(header->k);
+}
+
+/*
+ * @brief: Part of the reference as text, upper case, with N for every
+ * base that was not ACGT.
+ */
+string kmer_index::reference(size_t start, size_t length) const
+{
+    string text(length, 'A');
+
+    for (size_t i = 0; i < length; i++)
+    {
+        size_t at = start + i;
+        text[i] = (unknown[at / 64] >> (at % 64)) & 1 ? 'N' :
+            "ACGT"[(words[at / PACKED_BASES] >>
+            (2 * (at % PACKED_BASES))) & 3];
+    }
+    return text;
+}
+
+/*
+ * @brief: Whether part of the reference is all ACGT, so that its 2-bit
+ * codes are the bases themselves.
+ */
+bool kmer_index::all_known(size_t start, size_t length) const
+{
+    for (size_t at = start; at < start + length; )
+    {
+        size_t span = min(64 - at % 64, start + length - at);
+        uint64_t keep = span < 64 ? (1ULL << span) - 1 : ~0ULL;
+
+        if ((unknown[at / 64] >> (at % 64)) & keep)
+        {
+            return false;
+        }
+        at += span;
+    }
+    return true;
+}
+
+/*
+ * @brief: The record that reference position pos lies in.
+ */
+size_t kmer_index::record_of(size_t pos) const
+{
+    return upper_bound(record_starts, record_starts + header->records,
+        (uint32_t) pos) - record_starts - 1;
+}
+
+/*
+ * @brief: A read in upper case, with every base other than ACGT made
+ * an X. No reference base is an X, so those bases mismatch everything
+ * in the alignment, the reference's own N included.
+ */
+static string fold_read(const string &read)
+{
+    string text(read.length(), 'X');
+
+    for (size_t i = 0; i < read.length(); i++)
+    {
+        int code = base_code(read[i]);
+
+        if (code >= 0)
+        {
+            text[i] = "ACGT"[code];
+        }
+    }
+    return text;
+}
+
+/*
+ * @brief: Reverse complement of a read; bases other than ACGT are kept.
+ */
+static string reverse_complement(const string &read)
+{
+    string rc(read.rbegin(), read.rend());
+
+    for (size_t i = 0; i < rc.length(); i++)
+    {
+        switch (rc[i])
+        {
+        case 'A': rc[i] = 'T'; break;
+        case 'C': rc[i] = 'G'; break;
+        case 'G': rc[i] = 'C'; break;
+        case 'T': rc[i] = 'A'; break;
+        }
+    }
+    return rc;
+}
+
+/*
+ * @brief: Finds every exact k-mer hit of a read in the reference,
+ * skipping k-mers that occur more than KMER_MAX_HITS times.
+ */
+static void find_seeds(const kmer_index &index, const string &read,
+    vector<kmer_seed> &seeds)
+{
+    int k = index.get_k();
+    uint64_t mask = kmer_mask(k);
+    uint64_t kmer = 0;
+    size_t run = 0;
+
+    seeds.clear();
+    for (size_t i = 0; i < read.length(); i++)
+    {
+        int code = base_code(read[i]);
+
+        run = code < 0 ? 0 : run + 1;
+        kmer = ((kmer >> 2) | ((uint64_t) (code < 0 ? 0 : code) <<
+            (2 * (k - 1)))) & mask;
+        if (run < (size_t) k)
+        {
+            continue;
+        }
+
+        const uint32_t *hits;
+        size_t found = index.lookup(kmer, hits);
+        size_t before = seeds.size();
+
+        for (size_t h = 0; h < found; h++)
+        {
+            if (index.kmer_at(hits[h]) == kmer)
+            {
+                kmer_seed seed = {(uint32_t) (i + 1 - k), hits[h],
+                    (uint32_t) index.record_of(hits[h])};
+                seeds.push_back(seed);
+            }
+        }
+        if (seeds.size() - before > KMER_MAX_HITS)
+        {
+            seeds.resize(before);
+        }
+    }
+}
+
+/*
+ * @brief: Picks the best chain of seeds that keep going forward in both
+ * the read and one record of the reference. A seed extends a chain by
+ * the read bases it adds and loses one point per base its diagonal
+ * shifts, i.e. per base of indel the chain implies.
+ *
+ * @param seeds: The seeds; sorted in place.
+ * @param k: The k-mer length.
+ * @param chain: Set to the chain, in read order.
+ *
+ * @return: The chain's score, or 0 if there are no seeds.
+ */
+static int best_chain(vector<kmer_seed> &seeds, int k,
+    vector<kmer_seed> &chain)
+{
+    size_t n = seeds.size();
+    vector<int> score(n);
+    vector<long> prev(n);
+    long best = -1;
+
+    chain.clear();
+    sort(seeds.begin(), seeds.end());
+
+    for (size_t i = 0; i < n; i++)
+    {
+        long diag = (long) seeds[i].p - seeds[i].q;
+
+        score[i] = k;
+        prev[i] = -1;
+        for (size_t j = i > CHAIN_LOOKBACK ? i - CHAIN_LOOKBACK : 0; j < i;
+            j++)
+        {
+            long shift = diag - ((long) seeds[j].p - seeds[j].q);
+            long dq = (long) seeds[i].q - seeds[j].q;
+            long dp = (long) seeds[i].p - seeds[j].p;
+
+            shift = shift < 0 ? -shift : shift;
+            if (dq <= 0 || dp <= 0 || shift > CHAIN_MAX_SHIFT ||
+                seeds[j].r != seeds[i].r)
+            {
+                continue;
+            }
+
+            long gain = min(min(dq, dp), (long) k) - shift;
+            if (score[j] + gain > score[i])
+            {
+                score[i] = (int) (score[j] + gain);
+                prev[i] = j;
+            }
+        }
+        if (best < 0 || score[i] > score[best])
+        {
+            best = i;
+        }
+    }
+
+    for (long i = best; i >= 0; i = prev[i])
+    {
+        chain.push_back(seeds[i]);
+    }
+    reverse(chain.begin(), chain.end());
+    return best < 0 ? 0 : score[best];
+}
+
+/*
+ * @brief: Maps a read: seeds both strands, keeps the strand with the
+ * better chain, and aligns the read globally against the chain's record
+ * between where the chain's first and last seeds place its ends. The
+ * alignment is banded, the band doubling until the result is optimal,
+ * so a read with few indels costs a few diagonals, not the full table.
+ *
+ * @param read: The read.
+ * @param scoring: Scores for the alignment; with gap_open set, Gotoh's
+ * algorithm is used instead of the band.
+ *
+ * @return: The mapping; mapped is false if no seed was found or the
+ * index is empty.
+ */
+kmer_mapping kmer_index::map(const string &read,
+    const align_scoring &scoring) const
+{
+    kmer_mapping result;
+    vector<kmer_seed> seeds, chain, rc_chain;
+    string text = fold_read(read);
+    string rc = reverse_complement(text);
+    int k = get_k();
+
+    result.mapped = false;
+    result.reverse = false;
+    result.record = result.start = result.end = 0;
+    result.chain_score = 0;
+    if (k == 0)
+    {
+        return result;
+    }
+
+    find_seeds(*this, text, seeds);
+    result.chain_score = best_chain(seeds, k, chain);
+    find_seeds(*this, rc, seeds);
+    int rc_score = best_chain(seeds, k, rc_chain);
+
+    if (rc_score > result.chain_score)
+    {
+        result.chain_score = rc_score;
+        result.reverse = true;
+        chain.swap(rc_chain);
+    }
+    if (chain.empty())
+    {
+        return result;
+    }
+
+    // The window runs from the first seed's diagonal to the last's,
+    // kept inside the chain's record.
+    const string &oriented = result.reverse ? rc : text;
+    long first = (long) chain.front().p - chain.front().q;
+    long last = (long) chain.back().p - chain.back().q + oriented.length();
+    size_t record = chain.front().r;
+    long begin = record_start(record);
+
+    first = max(first, begin);
+    last = min(last, begin + (long) record_length(record));
+    last = max(last, first);
+    result.mapped = true;
+    result.record = record;
+    result.start = first - begin;
+    result.end = last - begin;
+
+    // A read of plain ACGT under a window of plain ACGT is aligned
+    // against the packed reference in place, gaplessly if that is
+    // provably best; other bases need the window as text.
+    packed_dna packed_read;
+    if (all_known(first, last - first) && packed_read.assign(oriented))
+    {
+        size_t word_count = (get_length() + PACKED_BASES - 1) / PACKED_BASES;
+        packed_seq read_seq(packed_read);
+        packed_seq window(words, word_count, first, last - first);
+
+        if (!ungapped_align(read_seq, window, scoring, result.alignment))
+        {
+            result.alignment = scoring.gap_open != 0 ?
+                gotoh_align(read_seq, window, scoring) :
+                adaptive_banded_align(read_seq, window, scoring);
+        }
+        return result;
+    }
+
+    string window = reference(first, last - first);
+    if (scoring.gap_open != 0)
+    {
+        result.alignment = gotoh_align(oriented, window, scoring);
+    }
+    else
+    {
+        result.alignment = adaptive_banded_align(oriented, window, scoring);
+    }
+    return result;
+}
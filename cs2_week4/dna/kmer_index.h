@@ -0,0 +1,121 @@
+//
+//  kmer_index.h
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  A hash index of every k-mer of a reference, for mapping short reads:
+//  exact k-mer hits seed a read, colinear seeds are chained, and only
+//  the stretch of reference under the best chain is aligned.
+//
+//  The index is one flat image (header, 2-bit packed reference, mask of
+//  the bases other than ACGT, bucket offsets, positions, record table)
+//  that is written to disk as is and mapped back into memory with mmap,
+//  so loading it is one read-only pass that checks it, with no parsing
+//  or copying.
+//
+//  A reference of several records (chromosomes, contigs) is indexed as
+//  their bases end to end, but no k-mer, chain or alignment crosses
+//  from one record into the next.
+//
+#ifndef __KMER_INDEX_H__
+#define __KMER_INDEX_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "align.h"
+
+using namespace std;
+
+// k-mer length when none is given; k-mers must fit one 64-bit word
+#define KMER_DEFAULT_K  15
+#define KMER_MAX_K      32
+
+// seeds from a k-mer found more often than this are dropped (repeats)
+#define KMER_MAX_HITS   64
+
+// start of an index file
+struct kmer_index_header {
+    char magic[8];          // KMER_MAGIC
+    uint32_t k;
+    uint32_t hash_bits;     // 2^hash_bits buckets
+    uint64_t length;        // bases in the reference
+    uint64_t count;         // k-mers indexed
+    uint64_t records;       // records in the reference
+    uint64_t names;         // bytes of record names, each ending in '\0'
+};
+
+// one read mapped to the reference
+struct kmer_mapping {
+    bool mapped;
+    bool reverse;           // the read's reverse complement was aligned
+    size_t record;          // reference record the read maps to
+    size_t start, end;      // bases of that record aligned, [start, end)
+    int chain_score;        // read bases the chained seeds cover, less
+                            // one for each base of shift between them
+    align_result alignment; // read (s) against the reference (t)
+};
+
+/*
+ * @brief: Index of every k-mer of a reference. Case is ignored, in the
+ * reference and in reads, so soft-masked (lower-case) sequence indexes
+ * and maps like the rest. Bases other than ACGT, such as N, are in no
+ * k-mer, and in an alignment they are mismatches against everything,
+ * another N included.
+ */
+class kmer_index
+{
+public:
+    kmer_index();
+    ~kmer_index();
+
+    bool build(const string &reference, int k);
+    bool build(const string &reference, const vector<size_t> &starts,
+        const vector<string> &names, int k);
+    bool save(const char *filename) const;
+    bool load(const char *filename);
+
+    int get_k() const { return header->k; }
+    size_t get_length() const { return header->length; }
+    size_t get_bytes() const { return bytes; }
+
+    size_t lookup(uint64_t kmer, const uint32_t *&hits) const;
+    uint64_t kmer_at(size_t pos) const;
+    string reference(size_t start, size_t length) const;
+
+    size_t get_records() const { return header->records; }
+    size_t record_start(size_t r) const { return record_starts[r]; }
+    size_t record_length(size_t r) const
+    {
+        return record_starts[r + 1] - record_starts[r];
+    }
+    const char *record_name(size_t r) const
+    {
+        return record_names + name_offsets[r];
+    }
+    size_t record_of(size_t pos) const;
+
+    kmer_mapping map(const string &read,
+        const align_scoring &scoring = DEFAULT_SCORING) const;
+
+private:
+    bool attach(const void *image, size_t size);
+    bool all_known(size_t start, size_t length) const;
+    void release();
+
+    const kmer_index_header *header;
+    const uint64_t *words;      // packed reference
+    const uint64_t *unknown;    // a bit set for each base not ACGT
+    const uint32_t *offsets;    // first position of each bucket, and end
+    const uint32_t *positions;  // k-mer starts, bucket by bucket
+    const uint32_t *record_starts;  // first base of each record, and end
+    const uint32_t *name_offsets;   // where each record's name starts
+    const char *record_names;       // the names
+    size_t bytes;               // size of the whole image
+
+    vector<uint64_t> owned;     // the image, when built here
+    void *mapping;              // the image, when loaded from a file
+};
+
+#endif
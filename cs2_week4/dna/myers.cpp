@@ -0,0 +1,186 @@
+//
+//  myers.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <stdint.h>
+#include <vector>
+#include "align.h"
+
+// rows of the table in one word
+#define WORD_ROWS   64
+
+/*
+ * @brief: Advances one 64-row block of the table by one column, in the
+ * form of Myers' algorithm that Hyyro gives for a block inside a larger
+ * pattern.
+ *
+ * Pv and Mv say, for each row, whether the score goes up or down by one
+ * from the row above; Eq has a bit for each row whose character matches
+ * this column's. The carry of the addition runs the effect of a match
+ * down the rows of the block in one instruction.
+ *
+ * @param pv, mv: The block's vertical deltas, updated in place.
+ * @param eq: Rows of the block that match the column's character.
+ * @param h_in: Horizontal delta (-1, 0, 1) in the row above the block.
+ * @param last: The bit of the row whose horizontal delta is returned.
+ *
+ * @return: The horizontal delta in that row.
+ */
+static inline int advance_block(uint64_t &pv, uint64_t &mv, uint64_t eq,
+    int h_in, uint64_t last)
+{
+    uint64_t xv = eq | mv;
+
+    if (h_in < 0)
+    {
+        eq |= 1;
+    }
+
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    int h_out = (ph & last) ? 1 : (mh & last) ? -1 : 0;
+
+    ph <<= 1;
+    mh <<= 1;
+    if (h_in < 0)
+    {
+        mh |= 1;
+    }
+    else if (h_in > 0)
+    {
+        ph |= 1;
+    }
+
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return h_out;
+}
+
+/*
+ * @brief: Edit (Levenshtein) distance of s and t, giving up once it is
+ * certain to exceed a limit.
+ *
+ * The shorter string is the pattern and runs down the rows, 64 to a
+ * word; the longer is read one character per column. A pattern of up to
+ * 64 characters is a single word. A longer one is a column of blocks,
+ * each passing its bottom row's horizontal delta to the block below.
+ * The score is tracked in the last row: D(m, j) for the columns j read
+ * so far. Since one more column lowers it by at most one, the scan stops
+ * as soon as that score less the columns left is over the limit.
+ *
+ * @param s, t: The strings.
+ * @param limit: Stop once the distance is known to be more than this.
+ *
+ * @return: The distance, or limit + 1 if it is more than limit.
+ */
+static size_t myers_distance(const string &s, const string &t, size_t limit)
+{
+    const string &pattern = s.length() <= t.length() ? s : t;
+    const string &text = s.length() <= t.length() ? t : s;
+    size_t m = pattern.length(), n = text.length();
+
+    if (n - m > limit)
+    {
+        return limit + 1;
+    }
+    if (m == 0)
+    {
+        return n;
+    }
+
+    // Each distinct pattern character gets a row of match masks, one
+    // word per block; characters not in the pattern match nothing.
+    size_t blocks = (m + WORD_ROWS - 1) / WORD_ROWS;
+    unsigned short symbol[256] = {0};
+    size_t symbols = 1;
+    vector<uint64_t> peq(blocks, 0);
+
+    for (size_t i = 0; i < m; i++)
+    {
+        unsigned char c = pattern[i];
+        if (symbol[c] == 0)
+        {
+            symbol[c] = symbols++;
+            peq.resize(symbols * blocks, 0);
+        }
+        peq[symbol[c] * blocks + i / WORD_ROWS] |= 1ULL << (i % WORD_ROWS);
+    }
+
+    uint64_t last = 1ULL << ((m - 1) % WORD_ROWS);
+    uint64_t top = 1ULL << (WORD_ROWS - 1);
+    size_t score = m;
+
+    if (blocks == 1)
+    {
+        uint64_t pv = ~0ULL, mv = 0;
+
+        for (size_t j = 0; j < n; j++)
+        {
+            // Row 0 is D(0, j) = j, so it always goes up by one.
+            score += advance_block(pv, mv,
+                peq[symbol[(unsigned char) text[j]]], 1, last);
+            if (score > limit + (n - j - 1))
+            {
+                return limit + 1;
+            }
+        }
+        return score;
+    }
+
+    vector<uint64_t> pv(blocks, ~0ULL), mv(blocks, 0);
+
+    for (size_t j = 0; j < n; j++)
+    {
+        const uint64_t *eq = &peq[symbol[(unsigned char) text[j]] * blocks];
+        int h = 1;
+
+        for (size_t b = 0; b + 1 < blocks; b++)
+        {
+            h = advance_block(pv[b], mv[b], eq[b], h, top);
+        }
+        score += advance_block(pv[blocks - 1], mv[blocks - 1],
+            eq[blocks - 1], h, last);
+        if (score > limit + (n - j - 1))
+        {
+            return limit + 1;
+        }
+    }
+    return score;
+}
+
+/*
+ * @brief: Edit distance of s and t: the fewest substitutions, insertions
+ * and deletions that turn one into the other.
+ */
+size_t edit_distance(const string &s, const string &t)
+{
+    size_t longest = s.length() > t.length() ? s.length() : t.length();
+
+    return myers_distance(s, t, longest);
+}
+
+/*
+ * @brief: Whether s and t are at most `limit` edits apart. Pairs far
+ * over the limit are rejected after a fraction of the work.
+ *
+ * @param distance: If not NULL and the answer is true, set to the
+ * distance.
+ */
+bool edit_distance_within(const string &s, const string &t, size_t limit,
+    size_t *distance)
+{
+    size_t d = myers_distance(s, t, limit);
+
+    if (d > limit)
+    {
+        return false;
+    }
+    if (distance != NULL)
+    {
+        *distance = d;
+    }
+    return true;
+}
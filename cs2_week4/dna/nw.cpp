@@ -0,0 +1,345 @@
+//
+//  nw.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include <algorithm>
+#include <limits.h>
+#include <stdio.h>
+#include <vector>
+#include "align.h"
+#include "packed.h"
+
+// traceback moves, two bits per cell
+#define MOVE_T      0   // gap in s: take a character of t
+#define MOVE_S      1   // gap in t: take a character of s
+#define MOVE_DIAG   2   // match or mismatch
+
+/*
+ * @brief: Aligns s and t with the Needleman-Wunsch algorithm, filled in
+ * bottom up instead of by memoized recursion.
+ *
+ * Cell (i, j) holds the best score for aligning the suffixes s[i..] and
+ * t[j..], which is what align(s.substr(i), t.substr(j)) used to return,
+ * so the instruction string can be read off front to back starting at
+ * (0, 0). Ties go to a gap in s, then a gap in t, then the diagonal, as
+ * they always have. Only two rows of scores are live at a time; the
+ * move chosen at each cell is kept in a matrix of 2-bit codes, four to
+ * a byte, for the traceback.
+ *
+ * @param s, t: The sequences to be aligned, as strings or packed DNA.
+ * @param scoring: Gap, mismatch and match scores.
+ * @param scratch: Buffers to reuse, or NULL to allocate them.
+ *
+ * @return: The highest alignment score and its instruction string.
+ */
+template <class S>
+static align_result nw_fill(const S &s, const S &t,
+    const align_scoring &scoring, align_scratch *scratch)
+{
+    size_t m = s.length(), n = t.length();
+    align_scratch own;
+    align_scratch &work = scratch ? *scratch : own;
+    int gap = scoring.gap_score;
+    align_result answer;
+
+    work.rows.resize(2 * (n + 1));
+    work.trace.assign((m * n + 3) / 4, 0);
+    int *next = work.rows.data(), *cur = next + n + 1;
+    unsigned char *moves = work.trace.data();
+
+    // Last row: s is used up, so the rest of t is all gaps.
+    for (size_t j = 0; j <= n; j++)
+    {
+        next[j] = (int) (n - j) * gap;
+    }
+
+    for (size_t i = m; i-- > 0; )
+    {
+        cur[n] = (int) (m - i) * gap;
+
+        for (size_t j = n; j-- > 0; )
+        {
+            int score_t = cur[j + 1] + gap;
+            int score_s = next[j] + gap;
+            int score_d = next[j + 1] +
+                (s[i] == t[j] ? scoring.matching : scoring.mismatch);
+            int best = score_t, move = MOVE_T;
+
+            if (score_s > best)
+            {
+                best = score_s;
+                move = MOVE_S;
+            }
+            if (score_d > best)
+            {
+                best = score_d;
+                move = MOVE_DIAG;
+            }
+
+            size_t cell = i * n + j;
+            moves[cell >> 2] |= move << ((cell & 3) << 1);
+            cur[j] = best;
+        }
+
+        swap(cur, next);
+    }
+
+    answer.score = next[0];
+    answer.inst.reserve(m + n);
+
+    // Follow the moves from (0, 0) to the far corner.
+    size_t i = 0, j = 0;
+    while (i < m || j < n)
+    {
+        int move;
+
+        if (i == m)
+        {
+            move = MOVE_T;
+        }
+        else if (j == n)
+        {
+            move = MOVE_S;
+        }
+        else
+        {
+            size_t cell = i * n + j;
+            move = (moves[cell >> 2] >> ((cell & 3) << 1)) & 3;
+        }
+
+        if (move == MOVE_T)
+        {
+            answer.inst += 't';
+            j++;
+        }
+        else if (move == MOVE_S)
+        {
+            answer.inst += 's';
+            i++;
+        }
+        else
+        {
+            answer.inst += s[i] == t[j] ? '|' : '*';
+            i++;
+            j++;
+        }
+    }
+
+    return answer;
+}
+
+align_result nw_align(const string &s, const string &t,
+    const align_scoring &scoring, align_scratch *scratch)
+{
+    return nw_fill(s, t, scoring, scratch);
+}
+
+align_result nw_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring, align_scratch *scratch)
+{
+    return nw_fill(s, t, scoring, scratch);
+}
+
+/*
+ * @brief: Adds up the score of an alignment given by its instruction
+ * string. Characters are compared again, so a '|' or '*' that does not
+ * fit s and t is scored by what the characters actually are. Each run of
+ * 's' or of 't' pays gap_open once on top of gap_score per character.
+ *
+ * @param s, t: The aligned sequences.
+ * @param inst: The instruction string.
+ * @param scoring: Gap, mismatch and match scores.
+ * @param mode: Which gaps at the ends are free.
+ *
+ * @return: The score, or INT_MIN if inst does not use up exactly s and t.
+ */
+template <class S>
+static int score_instructions(const S &s, const S &t, const string &inst,
+    const align_scoring &scoring, align_mode mode)
+{
+    size_t i = 0, j = 0;
+    size_t first = 0, last = inst.length();
+    int score = 0;
+
+    // Find the part that is scored: a local alignment leaves out
+    // everything around its aligned characters, a semi-global one the
+    // overhang of one string at each end.
+    if (mode == ALIGN_LOCAL)
+    {
+        first = inst.find_first_of("|*");
+        last = inst.find_last_of("|*") + 1;
+        if (first == string::npos)
+        {
+            first = last = inst.length();
+        }
+    }
+    else if (mode == ALIGN_SEMIGLOBAL && !inst.empty())
+    {
+        if (inst[0] == 's' || inst[0] == 't')
+        {
+            first = inst.find_first_not_of(inst[0]);
+        }
+        if (inst[last - 1] == 's' || inst[last - 1] == 't')
+        {
+            last = inst.find_last_not_of(inst[last - 1]) + 1;
+        }
+        if (first == string::npos || first > last)
+        {
+            first = last = inst.length();
+        }
+    }
+
+    for (size_t k = 0; k < inst.length(); k++)
+    {
+        bool scored = k >= first && k < last;
+        bool opens = k == first || inst[k - 1] != inst[k];
+
+        if ((inst[k] == 's' && i < s.length()) ||
+            (inst[k] == 't' && j < t.length()))
+        {
+            if (scored)
+            {
+                score += scoring.gap_score + (opens ? scoring.gap_open : 0);
+            }
+            (inst[k] == 's' ? i : j)++;
+        }
+        else if ((inst[k] == '|' || inst[k] == '*') && i < s.length() &&
+            j < t.length())
+        {
+            score += s[i] == t[j] ? scoring.matching : scoring.mismatch;
+            i++;
+            j++;
+        }
+        else
+        {
+            return INT_MIN;
+        }
+    }
+
+    return i == s.length() && j == t.length() ? score : INT_MIN;
+}
+
+int score_alignment(const string &s, const string &t, const string &inst,
+    const align_scoring &scoring, align_mode mode)
+{
+    return score_instructions(s, t, inst, scoring, mode);
+}
+
+int score_alignment(const packed_seq &s, const packed_seq &t,
+    const string &inst, const align_scoring &scoring, align_mode mode)
+{
+    return score_instructions(s, t, inst, scoring, mode);
+}
+
+/*
+ * @brief: Writes an instruction string with each run as its length and
+ * then its instruction, e.g. "12|1*3s40|".
+ */
+string run_length(const string &inst)
+{
+    string runs;
+    char number[24];
+
+    for (size_t k = 0; k < inst.length(); )
+    {
+        size_t end = inst.find_first_not_of(inst[k], k);
+        if (end == string::npos)
+        {
+            end = inst.length();
+        }
+        snprintf(number, sizeof number, "%zu", end - k);
+        runs += number;
+        runs += inst[k];
+        k = end;
+    }
+    return runs;
+}
+
+/*
+ * @brief: Best global (Needleman-Wunsch) or local (Smith-Waterman) score
+ * of s and t, without a traceback, in two rows of memory. This is the
+ * scalar reference the vector kernels are checked and timed against.
+ *
+ * @param s, t: The sequences to be scored.
+ * @param scoring: Gap, mismatch and match scores.
+ * @param local: Best local score instead of the global one.
+ *
+ * @return: The score.
+ */
+template <class S>
+static int linear_score(const S &s, const S &t,
+    const align_scoring &scoring, bool local)
+{
+    size_t m = s.length(), n = t.length();
+    vector<int> row(n + 1);
+    int gap = scoring.gap_score, best = 0;
+
+    for (size_t j = 0; j <= n; j++)
+    {
+        row[j] = local ? 0 : (int) j * gap;
+    }
+
+    for (size_t i = 0; i < m; i++)
+    {
+        int diag = row[0];
+        row[0] = local ? 0 : (int) (i + 1) * gap;
+
+        for (size_t j = 1; j <= n; j++)
+        {
+            int score = diag +
+                (s[i] == t[j - 1] ? scoring.matching : scoring.mismatch);
+
+            if (row[j] + gap > score)
+            {
+                score = row[j] + gap;
+            }
+            if (row[j - 1] + gap > score)
+            {
+                score = row[j - 1] + gap;
+            }
+            if (local && score < 0)
+            {
+                score = 0;
+            }
+
+            diag = row[j];
+            row[j] = score;
+            if (score > best)
+            {
+                best = score;
+            }
+        }
+    }
+
+    return local ? best : row[n];
+}
+
+/*
+ * @brief: Global alignment score of s and t, scalar, in linear space.
+ */
+int nw_score(const string &s, const string &t, const align_scoring &scoring)
+{
+    return linear_score(s, t, scoring, false);
+}
+
+/*
+ * @brief: Local alignment score of s and t, scalar, in linear space.
+ */
+int sw_score(const string &s, const string &t, const align_scoring &scoring)
+{
+    return linear_score(s, t, scoring, true);
+}
+
+int nw_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring)
+{
+    return linear_score(s, t, scoring, false);
+}
+
+int sw_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring)
+{
+    return linear_score(s, t, scoring, true);
+}
@@ -0,0 +1,200 @@
+//
+//  packed.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include "align.h"
+#include "packed.h"
+
+// the low bit of every 2-bit base
+#define LOW_BITS    0x5555555555555555ULL
+
+/*
+ * @brief: 2-bit code of a base.
+ *
+ * @return: 0 to 3 for A, C, G, T; -1 for any other character, lower
+ * case included, since the engines compare characters exactly.
+ */
+int dna_code(char c)
+{
+    switch (c)
+    {
+    case 'A':
+        return 0;
+    case 'C':
+        return 1;
+    case 'G':
+        return 2;
+    case 'T':
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+/*
+ * @brief: Packs a text sequence.
+ *
+ * @return: False, leaving the sequence empty, if text has a character
+ * other than A, C, G and T.
+ */
+bool packed_dna::assign(const string &text)
+{
+    words.assign((text.length() + PACKED_BASES - 1) / PACKED_BASES, 0);
+    len = text.length();
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int code = dna_code(text[i]);
+
+        if (code < 0)
+        {
+            words.clear();
+            len = 0;
+            return false;
+        }
+        words[i / PACKED_BASES] |= (uint64_t) code << (2 * (i % PACKED_BASES));
+    }
+    return true;
+}
+
+/*
+ * @brief: The sequence as text again.
+ */
+string packed_dna::str() const
+{
+    string text(len, 'A');
+
+    for (size_t i = 0; i < len; i++)
+    {
+        text[i] = "ACGT"[code(i)];
+    }
+    return text;
+}
+
+/*
+ * @brief: The bases as text.
+ */
+string packed_seq::str() const
+{
+    string text(len, 'A');
+
+    for (size_t i = 0; i < len; i++)
+    {
+        text[i] = "ACGT"[(*this)[i]];
+    }
+    return text;
+}
+
+/*
+ * @brief: The 32 bases starting at base i of a packed array of `count`
+ * words, whatever i's alignment; bases past the end read as zero.
+ */
+uint64_t packed_window(const uint64_t *words, size_t count, size_t i)
+{
+    size_t w = i / PACKED_BASES, shift = 2 * (i % PACKED_BASES);
+    uint64_t bits = w < count ? words[w] >> shift : 0;
+
+    if (shift != 0 && w + 1 < count)
+    {
+        bits |= words[w + 1] << (64 - shift);
+    }
+    return bits;
+}
+
+/*
+ * @brief: Counts the bases that differ between two stretches of packed
+ * DNA, a word at a time.
+ *
+ * @param a, b: The sequences.
+ * @param a_start, b_start: Where the stretch starts in each.
+ * @param count: Bases to compare; both stretches must be this long.
+ *
+ * @return: The number of mismatches.
+ */
+size_t count_mismatches(const packed_seq &a, size_t a_start,
+    const packed_seq &b, size_t b_start, size_t count)
+{
+    size_t total = 0;
+
+    for (size_t k = 0; k < count; k += PACKED_BASES)
+    {
+        uint64_t diff = a.window(a_start + k) ^ b.window(b_start + k);
+
+        // fold each base's two bits into its low bit
+        diff = (diff | (diff >> 1)) & LOW_BITS;
+        if (count - k < PACKED_BASES)
+        {
+            diff &= (1ULL << (2 * (count - k))) - 1;
+        }
+        total += __builtin_popcountll(diff);
+    }
+    return total;
+}
+
+/*
+ * @brief: Aligns two DNA sequences of equal length without gaps when
+ * that is provably optimal, skipping the dynamic program. A global
+ * alignment with gaps has at least one in each string, so at most
+ * n - 1 pairs; if the gapless score beats the best that leaves, the
+ * gapless alignment is the only optimal one, and every engine would
+ * have returned it.
+ *
+ * @param s, t: The sequences to be aligned.
+ * @param scoring: Gap, gap opening, mismatch and match scores.
+ * @param answer: Set to the alignment when it is found.
+ *
+ * @return: True if answer was set; false if the dynamic program is
+ * needed after all.
+ */
+bool ungapped_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring, align_result &answer)
+{
+    size_t n = s.length();
+    int pair = scoring.matching > scoring.mismatch ? scoring.matching :
+        scoring.mismatch;
+
+    // The bound needs gaps to cost something and a pair to be worth
+    // more than the two gaps it could be split into.
+    if (n == 0 || t.length() != n || scoring.gap_open > 0 ||
+        pair < 2 * scoring.gap_score)
+    {
+        return false;
+    }
+
+    long mismatches = count_mismatches(s, 0, t, 0, n);
+    long score = ((long) n - mismatches) * scoring.matching +
+        mismatches * scoring.mismatch;
+    long gapped = ((long) n - 1) * pair +
+        2 * (scoring.gap_score + scoring.gap_open);
+
+    if (score <= gapped)
+    {
+        return false;
+    }
+
+    answer.score = (int) score;
+    answer.inst.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        answer.inst[i] = s[i] == t[i] ? '|' : '*';
+    }
+    return true;
+}
+
+/*
+ * @brief: ungapped_align on text, which must be DNA that packs.
+ */
+bool ungapped_align(const string &s, const string &t,
+    const align_scoring &scoring, align_result &answer)
+{
+    packed_dna a, b;
+
+    if (s.empty() || t.length() != s.length() || !a.assign(s) ||
+        !b.assign(t))
+    {
+        return false;
+    }
+    return ungapped_align(packed_seq(a), packed_seq(b), scoring, answer);
+}
@@ -0,0 +1,150 @@
+//
+//  packed.h
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  DNA stored two bits per base, a quarter of the memory of a string,
+//  with whole-word comparison: XOR two words and every differing base
+//  leaves a nonzero bit pair, which popcount then counts 32 at a time.
+//
+//  Every engine also runs on packed DNA directly, scoring each cell
+//  from the bases' 2-bit codes, so sequences that are already packed
+//  (such as a k-mer index's reference) are aligned without a copy.
+//
+#ifndef __PACKED_H__
+#define __PACKED_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "align.h"
+
+using namespace std;
+
+// bases in one 64-bit word
+#define PACKED_BASES    32
+
+// 2-bit code of a base: A 0, C 1, G 2, T 3; -1 for anything else
+int dna_code(char c);
+
+// 32 bases from base i of an array of packed words, zero past its end
+uint64_t packed_window(const uint64_t *words, size_t count, size_t i);
+
+/*
+ * @brief: A DNA sequence packed 32 bases to a 64-bit word, the first
+ * base in the low bits. Only the upper-case bases ACGT can be packed;
+ * anything else has no 2-bit code.
+ */
+class packed_dna
+{
+public:
+    packed_dna() : len(0) {}
+
+    bool assign(const string &text);
+    string str() const;
+
+    size_t length() const { return len; }
+    size_t bytes() const { return words.size() * sizeof(uint64_t); }
+    size_t word_count() const { return words.size(); }
+    const uint64_t *data() const { return words.data(); }
+
+    // code of base i
+    int code(size_t i) const
+    {
+        return (words[i / PACKED_BASES] >> (2 * (i % PACKED_BASES))) & 3;
+    }
+
+    // the 32 bases from base i on
+    uint64_t window(size_t i) const
+    {
+        return packed_window(words.data(), words.size(), i);
+    }
+
+private:
+    vector<uint64_t> words;
+    size_t len;
+};
+
+/*
+ * @brief: `len` bases of packed DNA from base `start` of an array of
+ * words, read in place. The engines take it where they would take a
+ * string: length(), substr() and operator[], which gives the base's
+ * 2-bit code, so comparing two positions compares the bases.
+ */
+class packed_seq
+{
+public:
+    packed_seq(const packed_dna &dna)
+        : words(dna.data()), count(dna.word_count()), start(0),
+        len(dna.length()) {}
+    packed_seq(const uint64_t *words, size_t count, size_t start,
+        size_t len)
+        : words(words), count(count), start(start), len(len) {}
+
+    size_t length() const { return len; }
+    string str() const;
+
+    int operator[](size_t i) const
+    {
+        size_t at = start + i;
+        return (words[at / PACKED_BASES] >> (2 * (at % PACKED_BASES))) & 3;
+    }
+
+    // the 32 bases from base i on (those past the end are not cleared)
+    uint64_t window(size_t i) const
+    {
+        return packed_window(words, count, start + i);
+    }
+
+    packed_seq substr(size_t pos, size_t n) const
+    {
+        return packed_seq(words, count, start + pos, n);
+    }
+
+private:
+    const uint64_t *words;
+    size_t count;       // words in the array
+    size_t start, len;
+};
+
+// bases that differ between a[a_start..] and b[b_start..], over count
+// bases (packed.cpp)
+size_t count_mismatches(const packed_seq &a, size_t a_start,
+    const packed_seq &b, size_t b_start, size_t count);
+
+// The engines of align.h on packed DNA. They give the same results as
+// on the sequences as text.
+bool ungapped_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring, align_result &answer);
+align_result nw_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_scratch *scratch = NULL);
+int score_alignment(const packed_seq &s, const packed_seq &t,
+    const string &inst, const align_scoring &scoring = DEFAULT_SCORING,
+    align_mode mode = ALIGN_GLOBAL);
+int nw_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+int sw_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+align_result gotoh_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_mode mode = ALIGN_GLOBAL, align_scratch *scratch = NULL);
+int gotoh_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING,
+    align_mode mode = ALIGN_GLOBAL);
+align_result hirschberg_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+align_result banded_align(const packed_seq &s, const packed_seq &t,
+    size_t band, const align_scoring &scoring = DEFAULT_SCORING);
+align_result adaptive_banded_align(const packed_seq &s,
+    const packed_seq &t, const align_scoring &scoring = DEFAULT_SCORING,
+    size_t *band_used = NULL);
+int striped_global_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+int striped_local_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+align_result striped_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring = DEFAULT_SCORING);
+
+#endif
@@ -0,0 +1,171 @@
+//
+//  readmap.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Builds a k-mer index of a reference, or maps the reads of a FASTA
+//  file against one and writes a tab-separated line per read.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+#include "fasta.h"
+#include "kmer_index.h"
+
+/*
+ * @brief: Indexes a reference FASTA file, its records joined end to end
+ * with their names and starts kept, and saves the index.
+ *
+ * @return: The exit status.
+ */
+int build_index(const char *fasta, const char *filename, int k)
+{
+    fasta_reader in(fasta);
+    string name, seq, reference;
+    vector<size_t> starts;
+    vector<string> names;
+    kmer_index index;
+    double start = now();
+
+    if (!in.ok())
+    {
+        printf("could not read %s\n", fasta);
+        return 1;
+    }
+    while (in.next(name, seq))
+    {
+        starts.push_back(reference.length());
+        names.push_back(name);
+        reference += seq;
+    }
+
+    if (starts.empty() || !index.build(reference, starts, names, k))
+    {
+        printf("cannot index %zu bases in %zu records with k = %d\n",
+            reference.length(), starts.size(), k);
+        return 1;
+    }
+    if (!index.save(filename))
+    {
+        printf("could not write %s\n", filename);
+        return 1;
+    }
+    printf("%zu bases in %zu records, k = %d, %zu bytes, %.2f s\n",
+        reference.length(), starts.size(), k, index.get_bytes(),
+        now() - start);
+    return 0;
+}
+
+/*
+ * @brief: Maps every read of a FASTA file and writes one line per read:
+ * name, length, strand, reference record, start and end in that record,
+ * score, chain score and the run-length encoded alignment of the read
+ * (s) to the reference (t).
+ * Unmapped reads get '*' for the strand and empty fields after it.
+ *
+ * @return: The exit status.
+ */
+int map_reads(const char *filename, const char *fasta,
+    const align_scoring &scoring)
+{
+    kmer_index index;
+    fasta_reader in(fasta);
+    string name, read;
+    size_t reads = 0, mapped = 0;
+    double start = now();
+
+    if (!index.load(filename))
+    {
+        printf("could not load the index %s\n", filename);
+        return 1;
+    }
+    if (!in.ok())
+    {
+        printf("could not read %s\n", fasta);
+        return 1;
+    }
+    double loaded = now();
+
+    printf("#read\tlength\tstrand\trecord\tstart\tend\tscore\tchain"
+        "\talignment\n");
+    while (in.next(name, read))
+    {
+        kmer_mapping hit = index.map(read, scoring);
+
+        reads++;
+        if (!hit.mapped)
+        {
+            printf("%s\t%zu\t*\t\t\t\t\t\t\n", name.c_str(), read.length());
+            continue;
+        }
+        mapped++;
+        printf("%s\t%zu\t%c\t%s\t%zu\t%zu\t%d\t%d\t%s\n", name.c_str(),
+            read.length(), hit.reverse ? '-' : '+',
+            index.record_name(hit.record), hit.start, hit.end,
+            hit.alignment.score, hit.chain_score,
+            run_length(hit.alignment.inst).c_str());
+    }
+
+    double seconds = now() - loaded;
+    fprintf(stderr, "index loaded in %.3f s; %zu of %zu reads mapped in"
+        " %.2f s (%.0f reads/s)\n", loaded - start, mapped, reads, seconds,
+        reads / (seconds > 0 ? seconds : 1e-9));
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    align_scoring scoring = DEFAULT_SCORING;
+    bool build = false;
+    int k = KMER_DEFAULT_K;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ik:g:o:x:m:")) != -1)
+    {
+        if (opt == 'i')
+        {
+            build = true;
+        }
+        else if (opt == 'k')
+        {
+            k = atoi(optarg);
+        }
+        else if (opt == 'g')
+        {
+            scoring.gap_score = atoi(optarg);
+        }
+        else if (opt == 'o')
+        {
+            scoring.gap_open = atoi(optarg);
+        }
+        else if (opt == 'x')
+        {
+            scoring.mismatch = atoi(optarg);
+        }
+        else if (opt == 'm')
+        {
+            scoring.matching = atoi(optarg);
+        }
+        else
+        {
+            optind = -1;
+            break;
+        }
+    }
+
+    if (optind < 0 || argc - optind != 2)
+    {
+        printf("usage: %s -i [-k k] <reference.fa> <index>\n"
+            "       %s [-g gap] [-o gap open] [-x mismatch] [-m match]"
+            " <index> <reads.fa>\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    if (build)
+    {
+        return build_index(argv[optind], argv[optind + 1], k);
+    }
+    return map_reads(argv[optind], argv[optind + 1], scoring);
+}
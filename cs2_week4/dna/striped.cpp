@@ -0,0 +1,175 @@
+//
+//  striped.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+#include "striped.h"
+
+// first band striped_align traces back in
+#define STRIPED_FIRST_BAND  16
+
+// instruction sets a striped kernel can run on
+enum striped_target {
+    TARGET_SCALAR,
+    TARGET_SSE2,
+    TARGET_AVX2
+};
+
+/*
+ * @brief: The widest kernel that was built and that this CPU runs.
+ */
+static striped_target detect_target()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (striped_avx2_built && __builtin_cpu_supports("avx2"))
+    {
+        return TARGET_AVX2;
+    }
+    if (striped_sse2_built && __builtin_cpu_supports("sse2"))
+    {
+        return TARGET_SSE2;
+    }
+#endif
+    return TARGET_SCALAR;
+}
+
+/*
+ * @brief: The kernel to dispatch to, detected once. The local static is
+ * initialized exactly once even when the first calls race on the
+ * thread pools of alignbatch and readmap.
+ */
+static striped_target get_target()
+{
+    static const striped_target target = detect_target();
+
+    return target;
+}
+
+/*
+ * @brief: Name of the instruction set the striped kernels use here.
+ */
+const char *striped_isa()
+{
+    switch (get_target())
+    {
+        case TARGET_AVX2:
+            return "avx2";
+        case TARGET_SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
+
+/*
+ * @brief: Scores s and t on the best kernel available. The shorter
+ * string goes down the lanes, which keeps the profile small. 16-bit
+ * lanes are used whenever every score in the table provably fits: none
+ * can be below (m + n) times the worst single step, nor above
+ * min(m, n) matches.
+ */
+template <class S>
+static int striped_score(const S &s, const S &t,
+    const align_scoring &scoring, bool local)
+{
+    const S &query = s.length() <= t.length() ? s : t;
+    const S &db = s.length() <= t.length() ? t : s;
+    long m = query.length(), n = db.length();
+    long worst = scoring.gap_score < scoring.mismatch ?
+        scoring.gap_score : scoring.mismatch;
+    long low = local ? 0 : (m + n + 64) * (worst < 0 ? worst : 0) + worst;
+    long high = m * (scoring.matching > 0 ? scoring.matching : 0) +
+        (scoring.matching > 0 ? scoring.matching : 0);
+    bool narrow = low > SHRT_MIN / 2 && high < SHRT_MAX;
+
+    // The kernels rely on gaps costing something.
+    if (scoring.gap_score >= 0)
+    {
+        return local ? sw_score(s, t, scoring) : nw_score(s, t, scoring);
+    }
+
+    switch (get_target())
+    {
+        case TARGET_AVX2:
+            return striped_score_avx2(query, db, scoring, local, narrow);
+        case TARGET_SSE2:
+            return striped_score_sse2(query, db, scoring, local, narrow);
+        default:
+            return local ? sw_score(s, t, scoring) : nw_score(s, t, scoring);
+    }
+}
+
+/*
+ * @brief: Best global alignment score of s and t, by the striped kernel.
+ */
+int striped_global_score(const string &s, const string &t,
+    const align_scoring &scoring)
+{
+    return striped_score(s, t, scoring, false);
+}
+
+/*
+ * @brief: Best local alignment score of s and t, by the striped kernel.
+ */
+int striped_local_score(const string &s, const string &t,
+    const align_scoring &scoring)
+{
+    return striped_score(s, t, scoring, true);
+}
+
+int striped_global_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring)
+{
+    return striped_score(s, t, scoring, false);
+}
+
+int striped_local_score(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring)
+{
+    return striped_score(s, t, scoring, true);
+}
+
+/*
+ * @brief: Aligns s and t by scoring them with the striped kernel, then
+ * tracing back in a band that doubles until the banded alignment
+ * reaches that score. Similar strings finish in a narrow band, in far
+ * less memory than nw_align.
+ *
+ * @param s, t: The sequences to be aligned, as strings or packed DNA.
+ * @param scoring: Gap, mismatch and match scores.
+ *
+ * @return: The highest alignment score and its instruction string.
+ */
+template <class S>
+static align_result striped_run(const S &s, const S &t,
+    const align_scoring &scoring)
+{
+    align_result answer;
+
+    int score = striped_score(s, t, scoring, false);
+    size_t longest = s.length() > t.length() ? s.length() : t.length();
+
+    for (size_t band = STRIPED_FIRST_BAND; ; band *= 2)
+    {
+        answer = banded_align(s, t, band, scoring);
+
+        if (answer.score >= score || band >= longest)
+        {
+            return answer;
+        }
+    }
+}
+
+align_result striped_align(const string &s, const string &t,
+    const align_scoring &scoring)
+{
+    return striped_run(s, t, scoring);
+}
+
+align_result striped_align(const packed_seq &s, const packed_seq &t,
+    const align_scoring &scoring)
+{
+    return striped_run(s, t, scoring);
+}
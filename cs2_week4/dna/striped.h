@@ -0,0 +1,206 @@
+//
+//  striped.h
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Farrar's striped alignment scoring, written once as a template over
+//  the vector type. Each instruction set compiles it in its own file
+//  with its own compiler flags (striped_sse2.cpp, striped_avx2.cpp),
+//  and striped.cpp picks one at run time. Nothing here is called
+//  directly; use the functions declared in align.h.
+//
+#ifndef __STRIPED_H__
+#define __STRIPED_H__
+
+#include <string>
+#include <limits.h>
+#include "align.h"
+#include "packed.h"
+
+using namespace std;
+
+// Score-only kernels, on strings or packed DNA. narrow picks 16-bit
+// lanes; the caller must check that every score fits in them.
+int striped_score_sse2(const string &query, const string &db,
+    const align_scoring &scoring, bool local, bool narrow);
+int striped_score_sse2(const packed_seq &query, const packed_seq &db,
+    const align_scoring &scoring, bool local, bool narrow);
+int striped_score_avx2(const string &query, const string &db,
+    const align_scoring &scoring, bool local, bool narrow);
+int striped_score_avx2(const packed_seq &query, const packed_seq &db,
+    const align_scoring &scoring, bool local, bool narrow);
+
+// Whether the compiler could build each kernel; a kernel that was not
+// built is a stub the dispatcher must not pick.
+extern const bool striped_sse2_built;
+extern const bool striped_avx2_built;
+
+// The template has internal linkage, so the SSE2 and AVX2 copies are
+// never merged by the linker.
+namespace {
+
+/*
+ * @brief: Scores query against db with Farrar's striped algorithm.
+ *
+ * The query runs down the lanes of a vector: with p lanes and
+ * seg = ceil(m / p), lane l of stripe k holds query row k + l * seg,
+ * so neighboring rows sit in neighboring stripes and one column of the
+ * table is seg vectors. A column is filled in one pass that takes the
+ * best of the diagonal, the left and the vertical (F) move, where F is
+ * carried down the stripes; F crossing from one lane to the next is
+ * then fixed up lazily, which rarely takes more than a pass or two.
+ * Gaps are linear, so the left move needs no E vectors of its own.
+ *
+ * @param query, db: The sequences to be scored (query along the lanes),
+ * as strings or packed DNA; the profile is built per distinct symbol of
+ * db, so packed DNA needs at most four.
+ * @param scoring: Gap, mismatch and match scores; gap_score must be
+ * negative.
+ * @param local: Smith-Waterman (best local score) instead of
+ * Needleman-Wunsch.
+ *
+ * @return: The best global or local score.
+ */
+template <class V, class S>
+int striped_score(const S &query, const S &db,
+    const align_scoring &scoring, bool local)
+{
+    typedef typename V::vec vec;
+    typedef typename V::elem elem;
+
+    const int p = V::LANES;
+    size_t m = query.length(), n = db.length();
+    long gap = scoring.gap_score;
+
+    if (m == 0 || n == 0)
+    {
+        return local ? 0 : (int) ((m + n) * gap);
+    }
+
+    size_t seg = (m + p - 1) / p;
+    elem lanes[V::LANES];
+
+    // Profile: per character of db, the score of each query row.
+    int index[256];
+    string alphabet;
+    for (int c = 0; c < 256; c++)
+    {
+        index[c] = -1;
+    }
+    for (size_t j = 0; j < n; j++)
+    {
+        unsigned char c = db[j];
+        if (index[c] < 0)
+        {
+            index[c] = (int) alphabet.length();
+            alphabet += (char) c;
+        }
+    }
+
+    vec *profile = V::alloc(alphabet.length() * seg);
+    vec *hload = V::alloc(seg), *hstore = V::alloc(seg);
+
+    for (size_t a = 0; a < alphabet.length(); a++)
+    {
+        for (size_t k = 0; k < seg; k++)
+        {
+            for (int l = 0; l < p; l++)
+            {
+                size_t i = k + l * seg;
+                lanes[l] = i >= m ? V::PAD : query[i] == alphabet[a] ?
+                    scoring.matching : scoring.mismatch;
+            }
+            profile[a * seg + k] = V::load(lanes);
+        }
+    }
+
+    // Column 0: a gap for every query row above (none if local).
+    for (size_t k = 0; k < seg; k++)
+    {
+        for (int l = 0; l < p; l++)
+        {
+            lanes[l] = local ? 0 : V::clamp((long) (k + l * seg + 1) * gap);
+        }
+        hstore[k] = V::load(lanes);
+    }
+
+    vec vgap = V::set1((elem) gap), vzero = V::set1(0);
+    vec vbest = vzero;
+
+    for (size_t j = 0; j < n; j++)
+    {
+        const vec *prof = profile + index[(unsigned char) db[j]] * seg;
+
+        // Row 0 of this column and the last, which feed lane 0.
+        elem top_diag = local ? 0 : V::clamp((long) j * gap);
+        elem top = local ? 0 : V::clamp((long) (j + 1) * gap);
+
+        vec vh = V::shift_in(hstore[seg - 1], top_diag);
+        vec vf = V::shift_in(V::set1(V::NEG_INF), V::clamp((long) top + gap));
+
+        vec *swap = hload;
+        hload = hstore;
+        hstore = swap;
+
+        for (size_t k = 0; k < seg; k++)
+        {
+            vh = V::add(vh, prof[k]);
+            vh = V::max(vh, V::add(hload[k], vgap));
+            vh = V::max(vh, vf);
+            if (local)
+            {
+                vh = V::max(vh, vzero);
+                vbest = V::max(vbest, vh);
+            }
+            hstore[k] = vh;
+
+            vf = V::add(V::max(vf, vh), vgap);
+            vh = hload[k];
+        }
+
+        // Carry F across lanes until it no longer improves anything.
+        vf = V::shift_in(vf, V::NEG_INF);
+        size_t k = 0;
+        while (V::any_greater(vf, hstore[k]))
+        {
+            hstore[k] = V::max(hstore[k], vf);
+            if (local)
+            {
+                vbest = V::max(vbest, hstore[k]);
+            }
+            vf = V::add(vf, vgap);
+
+            if (++k == seg)
+            {
+                k = 0;
+                vf = V::shift_in(vf, V::NEG_INF);
+            }
+        }
+    }
+
+    int score;
+    if (local)
+    {
+        V::store(lanes, vbest);
+        score = 0;
+        for (int l = 0; l < p; l++)
+        {
+            score = lanes[l] > score ? lanes[l] : score;
+        }
+    }
+    else
+    {
+        V::store(lanes, hstore[(m - 1) % seg]);
+        score = lanes[(m - 1) / seg];
+    }
+
+    V::release(profile);
+    V::release(hload);
+    V::release(hstore);
+    return score;
+}
+
+} // namespace
+
+#endif
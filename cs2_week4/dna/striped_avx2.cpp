@@ -0,0 +1,130 @@
+//
+//  striped_avx2.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  AVX2 instances of the striped kernel: 16 lanes of 16 bits, or 8 of 32
+//  bits when scores do not fit in 16. Built with -mavx2; striped.cpp
+//  only calls in here after checking the CPU.
+//
+#include "striped.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+const bool striped_avx2_built = true;
+
+// Shifts a left by `bytes` across the two 128-bit halves, zero filling.
+#define AVX2_SHIFT_LEFT(a, bytes) _mm256_alignr_epi8((a), \
+    _mm256_permute2x128_si256((a), (a), 0x08), 16 - (bytes))
+
+// 16-bit lanes, saturating so padding and -infinity cannot wrap
+struct avx2_i16 {
+    typedef __m256i vec;
+    typedef short elem;
+    enum { LANES = 16 };
+    static const elem NEG_INF = SHRT_MIN;
+    static const elem PAD = SHRT_MIN / 2;
+
+    static vec set1(elem x) { return _mm256_set1_epi16(x); }
+    static vec load(const elem *p)
+    {
+        return _mm256_loadu_si256((const vec *) p);
+    }
+    static void store(elem *p, vec v) { _mm256_storeu_si256((vec *) p, v); }
+    static vec add(vec a, vec b) { return _mm256_adds_epi16(a, b); }
+    static vec max(vec a, vec b) { return _mm256_max_epi16(a, b); }
+    static bool any_greater(vec a, vec b)
+    {
+        return _mm256_movemask_epi8(_mm256_cmpgt_epi16(a, b)) != 0;
+    }
+    static vec shift_in(vec a, elem x)
+    {
+        return _mm256_or_si256(AVX2_SHIFT_LEFT(a, 2),
+            _mm256_setr_epi16(x, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0));
+    }
+    static elem clamp(long x) { return x < NEG_INF ? NEG_INF : (elem) x; }
+    static vec *alloc(size_t n)
+    {
+        return (vec *) _mm_malloc(n * sizeof(vec), sizeof(vec));
+    }
+    static void release(vec *p) { _mm_free(p); }
+};
+
+// 32-bit lanes
+struct avx2_i32 {
+    typedef __m256i vec;
+    typedef int elem;
+    enum { LANES = 8 };
+    static const elem NEG_INF = INT_MIN / 2;
+    static const elem PAD = INT_MIN / 4;
+
+    static vec set1(elem x) { return _mm256_set1_epi32(x); }
+    static vec load(const elem *p)
+    {
+        return _mm256_loadu_si256((const vec *) p);
+    }
+    static void store(elem *p, vec v) { _mm256_storeu_si256((vec *) p, v); }
+    static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+    static vec max(vec a, vec b) { return _mm256_max_epi32(a, b); }
+    static bool any_greater(vec a, vec b)
+    {
+        return _mm256_movemask_epi8(_mm256_cmpgt_epi32(a, b)) != 0;
+    }
+    static vec shift_in(vec a, elem x)
+    {
+        return _mm256_or_si256(AVX2_SHIFT_LEFT(a, 4),
+            _mm256_setr_epi32(x, 0, 0, 0, 0, 0, 0, 0));
+    }
+    static elem clamp(long x) { return x < NEG_INF ? NEG_INF : (elem) x; }
+    static vec *alloc(size_t n)
+    {
+        return (vec *) _mm_malloc(n * sizeof(vec), sizeof(vec));
+    }
+    static void release(vec *p) { _mm_free(p); }
+};
+
+template <class S>
+static int avx2_kernel(const S &query, const S &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    if (narrow)
+    {
+        return striped_score<avx2_i16>(query, db, scoring, local);
+    }
+    return striped_score<avx2_i32>(query, db, scoring, local);
+}
+
+int striped_score_avx2(const string &query, const string &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return avx2_kernel(query, db, scoring, local, narrow);
+}
+
+int striped_score_avx2(const packed_seq &query, const packed_seq &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return avx2_kernel(query, db, scoring, local, narrow);
+}
+
+#else
+
+const bool striped_avx2_built = false;
+
+// Never called: striped.cpp checks striped_avx2_built before it
+// dispatches here.
+int striped_score_avx2(const string &query, const string &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return 0;
+}
+
+int striped_score_avx2(const packed_seq &query, const packed_seq &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,120 @@
+//
+//  striped_sse2.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  SSE2 instances of the striped kernel: 8 lanes of 16 bits, or 4 of 32
+//  bits when scores do not fit in 16.
+//
+#include "striped.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+const bool striped_sse2_built = true;
+
+// 16-bit lanes, saturating so padding and -infinity cannot wrap
+struct sse2_i16 {
+    typedef __m128i vec;
+    typedef short elem;
+    enum { LANES = 8 };
+    static const elem NEG_INF = SHRT_MIN;
+    static const elem PAD = SHRT_MIN / 2;
+
+    static vec set1(elem x) { return _mm_set1_epi16(x); }
+    static vec load(const elem *p) { return _mm_loadu_si128((const vec *) p); }
+    static void store(elem *p, vec v) { _mm_storeu_si128((vec *) p, v); }
+    static vec add(vec a, vec b) { return _mm_adds_epi16(a, b); }
+    static vec max(vec a, vec b) { return _mm_max_epi16(a, b); }
+    static bool any_greater(vec a, vec b)
+    {
+        return _mm_movemask_epi8(_mm_cmpgt_epi16(a, b)) != 0;
+    }
+    static vec shift_in(vec a, elem x)
+    {
+        return _mm_insert_epi16(_mm_slli_si128(a, 2), x, 0);
+    }
+    static elem clamp(long x) { return x < NEG_INF ? NEG_INF : (elem) x; }
+    static vec *alloc(size_t n)
+    {
+        return (vec *) _mm_malloc(n * sizeof(vec), sizeof(vec));
+    }
+    static void release(vec *p) { _mm_free(p); }
+};
+
+// 32-bit lanes; SSE2 has no 32-bit max, so it is built from a compare
+struct sse2_i32 {
+    typedef __m128i vec;
+    typedef int elem;
+    enum { LANES = 4 };
+    static const elem NEG_INF = INT_MIN / 2;
+    static const elem PAD = INT_MIN / 4;
+
+    static vec set1(elem x) { return _mm_set1_epi32(x); }
+    static vec load(const elem *p) { return _mm_loadu_si128((const vec *) p); }
+    static void store(elem *p, vec v) { _mm_storeu_si128((vec *) p, v); }
+    static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+    static vec max(vec a, vec b)
+    {
+        vec gt = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+    }
+    static bool any_greater(vec a, vec b)
+    {
+        return _mm_movemask_epi8(_mm_cmpgt_epi32(a, b)) != 0;
+    }
+    static vec shift_in(vec a, elem x)
+    {
+        return _mm_or_si128(_mm_slli_si128(a, 4), _mm_cvtsi32_si128(x));
+    }
+    static elem clamp(long x) { return x < NEG_INF ? NEG_INF : (elem) x; }
+    static vec *alloc(size_t n)
+    {
+        return (vec *) _mm_malloc(n * sizeof(vec), sizeof(vec));
+    }
+    static void release(vec *p) { _mm_free(p); }
+};
+
+template <class S>
+static int sse2_kernel(const S &query, const S &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    if (narrow)
+    {
+        return striped_score<sse2_i16>(query, db, scoring, local);
+    }
+    return striped_score<sse2_i32>(query, db, scoring, local);
+}
+
+int striped_score_sse2(const string &query, const string &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return sse2_kernel(query, db, scoring, local, narrow);
+}
+
+int striped_score_sse2(const packed_seq &query, const packed_seq &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return sse2_kernel(query, db, scoring, local, narrow);
+}
+
+#else
+
+const bool striped_sse2_built = false;
+
+// Never called: striped.cpp checks striped_sse2_built before it
+// dispatches here.
+int striped_score_sse2(const string &query, const string &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return 0;
+}
+
+int striped_score_sse2(const packed_seq &query, const packed_seq &db,
+    const align_scoring &scoring, bool local, bool narrow)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,690 @@
+//
+//  testsuite.cpp
+//  dna_alignment
+//
+//  Copyright (c) 2014 California Institute of Technology. All rights reserved.
+//
+//  Checks every alignment engine, in every mode it has, against a small
+//  full-matrix reference on random pairs, and checks that each returned
+//  instruction string scores what the engine says it does.
+//
+#include <ctype.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "align.h"
+#include "bench.h"
+#include "kmer_index.h"
+#include "packed.h"
+
+// random pairs per test, and the longest sequence in them
+#define PAIRS       4000
+#define MAX_LENGTH  60
+
+// low enough that adding a few gaps to it cannot wrap around
+#define NEG_INF     (INT_MIN / 4)
+
+static const char *MODE_NAMES[] = {"global", "local", "semi-global"};
+
+/*
+ * @brief: Best score of s and t by the textbook affine-gap recurrences,
+ * with all three (m + 1) x (n + 1) matrices kept: H is the best score
+ * of each cell, E the best ending in a gap in s (a 't'), F the best
+ * ending in a gap in t (an 's'). A run of k gaps scores gap_open +
+ * k * gap_score. Local alignments may start and end anywhere; semi-
+ * global ones may leave out a prefix and a suffix of either string.
+ */
+static int reference_score(const string &s, const string &t,
+    const align_scoring &scoring, align_mode mode)
+{
+    size_t m = s.length(), n = t.length();
+    int open = scoring.gap_open + scoring.gap_score;
+    int extend = scoring.gap_score;
+    bool global = mode == ALIGN_GLOBAL, local = mode == ALIGN_LOCAL;
+    vector<vector<int> > H(m + 1, vector<int>(n + 1, NEG_INF));
+    vector<vector<int> > E = H, F = H;
+    int best = local ? 0 : NEG_INF;
+
+    H[0][0] = 0;
+    for (size_t j = 1; j <= n; j++)
+    {
+        H[0][j] = E[0][j] = global ? scoring.gap_open + (int) j * extend : 0;
+    }
+    for (size_t i = 1; i <= m; i++)
+    {
+        H[i][0] = F[i][0] = global ? scoring.gap_open + (int) i * extend : 0;
+    }
+
+    for (size_t i = 1; i <= m; i++)
+    {
+        for (size_t j = 1; j <= n; j++)
+        {
+            E[i][j] = max(E[i][j - 1] + extend, H[i][j - 1] + open);
+            F[i][j] = max(F[i - 1][j] + extend, H[i - 1][j] + open);
+            H[i][j] = max(max(E[i][j], F[i][j]), H[i - 1][j - 1] +
+                (s[i - 1] == t[j - 1] ? scoring.matching : scoring.mismatch));
+            if (local)
+            {
+                H[i][j] = max(H[i][j], 0);
+                best = max(best, H[i][j]);
+            }
+        }
+    }
+
+    if (global)
+    {
+        return H[m][n];
+    }
+    if (mode == ALIGN_SEMIGLOBAL)
+    {
+        for (size_t i = 0; i <= m; i++)
+        {
+            best = max(best, H[i][n]);
+        }
+        for (size_t j = 0; j <= n; j++)
+        {
+            best = max(best, H[m][j]);
+        }
+    }
+    return best;
+}
+
+/*
+ * @brief: Random DNA of up to MAX_LENGTH bases; now and then an N, which
+ * no packed path can take.
+ */
+static string random_seq()
+{
+    string seq(rand() % (MAX_LENGTH + 1), 'A');
+
+    for (size_t i = 0; i < seq.length(); i++)
+    {
+        seq[i] = rand() % 200 == 0 ? 'N' : "ACGT"[rand() % 4];
+    }
+    return seq;
+}
+
+/*
+ * @brief: Copy of seq with a few random edits, so that pairs are often
+ * related (and often the same length).
+ */
+static string random_relative(const string &seq)
+{
+    string out = seq;
+    int edits = rand() % 4;
+
+    for (int e = 0; e < edits && !out.empty(); e++)
+    {
+        size_t at = rand() % out.length();
+        int kind = rand() % 3;
+
+        if (kind == 0)
+        {
+            out[at] = "ACGT"[rand() % 4];
+        }
+        else if (kind == 1)
+        {
+            out.erase(at, 1);
+        }
+        else
+        {
+            out.insert(at, 1, "ACGT"[rand() % 4]);
+        }
+    }
+    return out;
+}
+
+/*
+ * @brief: A random pair: unrelated, or one a few edits from the other.
+ */
+static void random_pair(string &s, string &t)
+{
+    s = random_seq();
+    t = rand() % 2 ? random_relative(s) : random_seq();
+}
+
+/*
+ * @brief: Random scores: gaps and mismatches at most 0, matches at least
+ * 0, and (when affine is set) a gap opening cost at most 0.
+ */
+static align_scoring random_scoring(bool affine)
+{
+    align_scoring scoring;
+
+    scoring.gap_score = -(rand() % 6);
+    scoring.mismatch = -(rand() % 5);
+    scoring.matching = rand() % 4;
+    scoring.gap_open = affine ? -(rand() % 8) : 0;
+    return scoring;
+}
+
+/*
+ * @brief: Checks one engine's answer: its score against the reference,
+ * and its instruction string against its score.
+ *
+ * @return: 1 (after printing the pair) if either is wrong, else 0.
+ */
+static int check_answer(const char *engine, const string &s, const string &t,
+    const align_scoring &scoring, align_mode mode, const align_result &got,
+    int want)
+{
+    int rescored = score_alignment(s, t, got.inst, scoring, mode);
+
+    if (got.score == want && rescored == want)
+    {
+        return 0;
+    }
+    printf("FAIL: %s (%s): \"%s\" \"%s\" scoring {%d, %d, %d, %d}: score %d,"
+        " instructions score %d, reference %d\n", engine, MODE_NAMES[mode],
+        s.c_str(), t.c_str(), scoring.gap_score, scoring.mismatch,
+        scoring.matching, scoring.gap_open, got.score, rescored, want);
+    return 1;
+}
+
+/*
+ * @brief: Checks a score-only engine against the reference.
+ *
+ * @return: 1 (after printing the pair) if it is wrong, else 0.
+ */
+static int check_score(const char *engine, const string &s, const string &t,
+    const align_scoring &scoring, long got, long want)
+{
+    if (got == want)
+    {
+        return 0;
+    }
+    printf("FAIL: %s: \"%s\" \"%s\" scoring {%d, %d, %d, %d}: %ld, reference"
+        " %ld\n", engine, s.c_str(), t.c_str(), scoring.gap_score,
+        scoring.mismatch, scoring.matching, scoring.gap_open, got, want);
+    return 1;
+}
+
+/*
+ * @brief: The linear-gap engines: Needleman-Wunsch, its scores, Smith-
+ * Waterman's score, Hirschberg, banded, adaptive banded and striped.
+ *
+ * @return: Number of failures.
+ */
+int test_linear()
+{
+    int failures = 0;
+
+    for (int p = 0; p < PAIRS && failures < 10; p++)
+    {
+        string s, t;
+        align_scoring scoring = random_scoring(false);
+
+        random_pair(s, t);
+
+        int global = reference_score(s, t, scoring, ALIGN_GLOBAL);
+        int local = reference_score(s, t, scoring, ALIGN_LOCAL);
+        size_t longest = max(s.length(), t.length());
+
+        failures += check_answer("nw_align", s, t, scoring, ALIGN_GLOBAL,
+            nw_align(s, t, scoring), global);
+        failures += check_answer("hirschberg_align", s, t, scoring,
+            ALIGN_GLOBAL, hirschberg_align(s, t, scoring), global);
+        failures += check_answer("banded_align", s, t, scoring,
+            ALIGN_GLOBAL, banded_align(s, t, longest, scoring), global);
+        failures += check_answer("adaptive_banded_align", s, t, scoring,
+            ALIGN_GLOBAL, adaptive_banded_align(s, t, scoring), global);
+        failures += check_answer("striped_align", s, t, scoring,
+            ALIGN_GLOBAL, striped_align(s, t, scoring), global);
+        failures += check_score("nw_score", s, t, scoring,
+            nw_score(s, t, scoring), global);
+        failures += check_score("sw_score", s, t, scoring,
+            sw_score(s, t, scoring), local);
+        failures += check_score("striped_global_score", s, t, scoring,
+            striped_global_score(s, t, scoring), global);
+        failures += check_score("striped_local_score", s, t, scoring,
+            striped_local_score(s, t, scoring), local);
+
+        // A narrow band gives a real alignment, never better than the
+        // best, and the best whenever the bound says so.
+        size_t band = rand() % 4;
+        align_result banded = banded_align(s, t, band, scoring);
+        int rescored = score_alignment(s, t, banded.inst, scoring);
+
+        if (banded.score > global || rescored != banded.score ||
+            (banded.score >= band_outside_bound(s.length(), t.length(),
+            band, scoring) && banded.score != global))
+        {
+            printf("FAIL: banded_align band %lu: \"%s\" \"%s\": %d, "
+                "instructions score %d, reference %d\n",
+                (unsigned long) band, s.c_str(), t.c_str(), banded.score,
+                rescored, global);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/*
+ * @brief: Gotoh's engines in all three modes, with affine and linear
+ * gaps, and score_alignment's handling of each mode's free ends.
+ *
+ * @return: Number of failures.
+ */
+int test_gotoh()
+{
+    int failures = 0;
+
+    for (int p = 0; p < PAIRS && failures < 10; p++)
+    {
+        string s, t;
+        align_scoring scoring = random_scoring(rand() % 4 != 0);
+
+        random_pair(s, t);
+
+        for (int m = ALIGN_GLOBAL; m <= ALIGN_SEMIGLOBAL; m++)
+        {
+            align_mode mode = (align_mode) m;
+            int want = reference_score(s, t, scoring, mode);
+
+            failures += check_answer("gotoh_align", s, t, scoring, mode,
+                gotoh_align(s, t, scoring, mode), want);
+            failures += check_score("gotoh_score", s, t, scoring,
+                gotoh_score(s, t, scoring, mode), want);
+        }
+    }
+
+    // Fixed cases for the free ends score_alignment leaves unscored.
+    static const align_scoring AFFINE = {-1, -2, 3, -4};
+    struct {
+        const char *s, *t, *inst;
+        align_mode mode;
+        int score;
+    } cases[] = {
+        {"ACGT", "ACGT", "||||", ALIGN_GLOBAL, 12},
+        {"AC", "ACGT", "||tt", ALIGN_GLOBAL, 6 - 4 - 2},
+        {"AC", "ACGT", "||tt", ALIGN_SEMIGLOBAL, 6},
+        {"GTAC", "ACGT", "ss||tt", ALIGN_SEMIGLOBAL, 6},
+        {"GTAC", "ACGT", "ss||tt", ALIGN_LOCAL, 6},
+        {"AAGT", "CCGT", "sstt||", ALIGN_SEMIGLOBAL, -4 - 2 + 6},
+        {"AAC", "AC", "|s|", ALIGN_LOCAL, 3 - 5 + 3},
+        {"AC", "ACGT", "|||", ALIGN_GLOBAL, INT_MIN}
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        int got = score_alignment(cases[c].s, cases[c].t, cases[c].inst,
+            AFFINE, cases[c].mode);
+
+        if (got != cases[c].score)
+        {
+            printf("FAIL: score_alignment (%s) \"%s\" \"%s\" \"%s\": %d,"
+                " expected %d\n", MODE_NAMES[cases[c].mode], cases[c].s,
+                cases[c].t, cases[c].inst, got, cases[c].score);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/*
+ * @brief: Myers' edit distance against the unit-cost reference, and
+ * the limited test on both sides of the distance.
+ *
+ * @return: Number of failures.
+ */
+int test_edit_distance()
+{
+    static const align_scoring UNIT_COST = {-1, -1, 0, 0};
+    int failures = 0;
+
+    for (int p = 0; p < PAIRS && failures < 10; p++)
+    {
+        string s, t;
+        size_t distance = 0;
+
+        random_pair(s, t);
+
+        long want = -reference_score(s, t, UNIT_COST, ALIGN_GLOBAL);
+
+        failures += check_score("edit_distance", s, t, UNIT_COST,
+            (long) edit_distance(s, t), want);
+        if (!edit_distance_within(s, t, want, &distance) ||
+            distance != (size_t) want ||
+            (want > 0 && edit_distance_within(s, t, want - 1)))
+        {
+            printf("FAIL: edit_distance_within: \"%s\" \"%s\" around %ld\n",
+                s.c_str(), t.c_str(), want);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/*
+ * @brief: The packed-DNA overloads against the same engines on text,
+ * and the gapless shortcut against the reference whenever it answers.
+ *
+ * @return: Number of failures.
+ */
+int test_packed()
+{
+    int failures = 0;
+
+    for (int p = 0; p < PAIRS && failures < 10; p++)
+    {
+        string s, t;
+        packed_dna ps, pt;
+        align_scoring scoring = random_scoring(false);
+        align_result answer;
+
+        random_pair(s, t);
+
+        if (ungapped_align(s, t, scoring, answer))
+        {
+            failures += check_answer("ungapped_align", s, t, scoring,
+                ALIGN_GLOBAL, answer,
+                reference_score(s, t, scoring, ALIGN_GLOBAL));
+        }
+        if (!ps.assign(s) || !pt.assign(t))
+        {
+            continue;
+        }
+
+        packed_seq a(ps), b(pt);
+        align_scoring affine = random_scoring(true);
+        align_mode mode = (align_mode) (rand() % 3);
+        bool same = a.str() == s && b.str() == t &&
+            nw_align(a, b, scoring).inst == nw_align(s, t, scoring).inst &&
+            hirschberg_align(a, b, scoring).inst ==
+                hirschberg_align(s, t, scoring).inst &&
+            adaptive_banded_align(a, b, scoring).inst ==
+                adaptive_banded_align(s, t, scoring).inst &&
+            striped_align(a, b, scoring).inst ==
+                striped_align(s, t, scoring).inst &&
+            gotoh_align(a, b, affine, mode).inst ==
+                gotoh_align(s, t, affine, mode).inst &&
+            gotoh_score(a, b, affine, mode) ==
+                gotoh_score(s, t, affine, mode) &&
+            nw_score(a, b, scoring) == nw_score(s, t, scoring) &&
+            sw_score(a, b, scoring) == sw_score(s, t, scoring);
+
+        if (!same)
+        {
+            printf("FAIL: packed: \"%s\" \"%s\" differ from the text engines\n",
+                s.c_str(), t.c_str());
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/*
+ * @brief: Maps a read and checks where it lands and what it scores.
+ *
+ * @return: 1 (after printing what happened) if it is not as expected.
+ */
+static int check_mapping(const kmer_index &index, const char *name,
+    const string &read, size_t record, size_t start, int score)
+{
+    kmer_mapping hit = index.map(read);
+
+    if (hit.mapped && hit.record == record && hit.start == start &&
+        hit.alignment.score == score)
+    {
+        return 0;
+    }
+    printf("FAIL: kmer_index: %s: mapped %d to record %lu at %lu, score %d;"
+        " expected record %lu at %lu, score %d\n", name, hit.mapped,
+        (unsigned long) hit.record, (unsigned long) hit.start,
+        hit.alignment.score, (unsigned long) record, (unsigned long) start,
+        score);
+    return 1;
+}
+
+/*
+ * @brief: Maps reads against a reference with a soft-masked (lower-case)
+ * stretch and a run of N: case must not matter, and N must mismatch
+ * everything, another N included.
+ *
+ * @return: Number of failures.
+ */
+int test_kmer_bases()
+{
+    int failures = 0;
+    string bases = random_dna(5000), reference = bases;
+    kmer_index index;
+
+    for (size_t i = 2000; i < 3000; i++)
+    {
+        reference[i] = (char) tolower(reference[i]);
+    }
+    reference.replace(4000, 20, 20, 'N');
+
+    if (!index.build(reference, KMER_DEFAULT_K))
+    {
+        printf("FAIL: kmer_index: could not build\n");
+        return 1;
+    }
+    if (index.reference(1998, 4) != bases.substr(1998, 4) ||
+        index.reference(3999, 2) != bases.substr(3999, 1) + "N")
+    {
+        printf("FAIL: kmer_index: reference text is \"%s\", \"%s\"\n",
+            index.reference(1998, 4).c_str(),
+            index.reference(3999, 2).c_str());
+        failures++;
+    }
+
+    string lower = bases.substr(100, 150);
+    for (size_t i = 0; i < lower.length(); i++)
+    {
+        lower[i] = (char) tolower(lower[i]);
+    }
+
+    // 150 matching bases score 300; each N costs a match and gains a
+    // mismatch, 3 points.
+    failures += check_mapping(index, "soft-masked", bases.substr(2400, 150),
+        0, 2400, 300);
+    failures += check_mapping(index, "into soft-masked",
+        bases.substr(2930, 150), 0, 2930, 300);
+    failures += check_mapping(index, "lower-case read", lower, 0, 100, 300);
+    failures += check_mapping(index, "over N", bases.substr(3950, 150), 0,
+        3950, 300 - 20 * 3);
+    failures += check_mapping(index, "N over N",
+        reference.substr(3950, 150), 0, 3950, 300 - 20 * 3);
+
+    return failures;
+}
+
+/*
+ * @brief: Reverse complement of upper-case DNA.
+ */
+static string complement(const string &seq)
+{
+    string out(seq.rbegin(), seq.rend());
+
+    for (size_t i = 0; i < out.length(); i++)
+    {
+        const char *at = strchr("ACGT", out[i]);
+        out[i] = at != NULL ? "TGCA"[at - "ACGT"] : 'N';
+    }
+    return out;
+}
+
+/*
+ * @brief: Writes bytes to a file, replacing it.
+ */
+static bool write_file(const char *filename, const string &bytes)
+{
+    FILE *file = fopen(filename, "wb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+/*
+ * @brief: Reads a whole file into a string.
+ */
+static bool read_file(const char *filename, string &bytes)
+{
+    FILE *file = fopen(filename, "rb");
+    char buffer[65536];
+    size_t got;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+    bytes.clear();
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.append(buffer, got);
+    }
+    fclose(file);
+    return true;
+}
+
+/*
+ * @brief: Checks that load() refuses a damaged copy of an index file.
+ *
+ * @return: 1 (after printing what happened) if the copy loaded.
+ */
+static int check_rejected(const char *filename, const string &bytes,
+    const char *name)
+{
+    kmer_index index;
+
+    if (!write_file(filename, bytes))
+    {
+        printf("FAIL: kmer_index: could not write %s\n", filename);
+        return 1;
+    }
+    if (index.load(filename))
+    {
+        printf("FAIL: kmer_index: loaded an index with %s\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * @brief: Saves an index of two records and loads it back: the loaded
+ * index must map reads exactly as the built one does, and load() must
+ * refuse the file truncated or with an offset or position corrupted. A
+ * read across the records' boundary must map inside one of them.
+ *
+ * @return: Number of failures.
+ */
+int test_kmer_file()
+{
+    const char *filename = "testsuite.kmi";
+    int failures = 0;
+    string first = random_dna(3000), second = random_dna(2000);
+    vector<size_t> starts;
+    vector<string> names;
+    kmer_index built, loaded;
+
+    starts.push_back(0);
+    starts.push_back(first.length());
+    names.push_back("first");
+    names.push_back("second");
+    if (!built.build(first + second, starts, names, KMER_DEFAULT_K) ||
+        !built.save(filename) || !loaded.load(filename))
+    {
+        printf("FAIL: kmer_index: could not build, save and load\n");
+        unlink(filename);
+        return 1;
+    }
+    if (loaded.get_records() != 2 || loaded.record_length(1) != 2000 ||
+        strcmp(loaded.record_name(1), "second") != 0)
+    {
+        printf("FAIL: kmer_index: loaded record table differs\n");
+        failures++;
+    }
+
+    for (int trial = 0; trial < 50; trial++)
+    {
+        string genome = first + second;
+        size_t length = 50 + rand() % 150;
+        string read = random_relative(
+            genome.substr(rand() % (genome.length() - length), length));
+        if (rand() % 2)
+        {
+            read = complement(read);
+        }
+
+        kmer_mapping a = built.map(read), b = loaded.map(read);
+        if (a.mapped != b.mapped || a.reverse != b.reverse ||
+            a.record != b.record || a.start != b.start || a.end != b.end ||
+            a.alignment.score != b.alignment.score ||
+            a.alignment.inst != b.alignment.inst)
+        {
+            printf("FAIL: kmer_index: loaded index maps %s differently\n",
+                read.c_str());
+            failures++;
+            break;
+        }
+    }
+
+    // 60 bases from the end of the first record, 90 from the second: the
+    // longer part wins, and the rest is gaps rather than bases of the
+    // other record.
+    failures += check_mapping(loaded, "across records",
+        first.substr(2940) + second.substr(0, 90), 1, 0, 90 * 2 - 60 * 5);
+
+    string image;
+    if (!read_file(filename, image))
+    {
+        printf("FAIL: kmer_index: could not read %s\n", filename);
+        unlink(filename);
+        return failures + 1;
+    }
+
+    // Where the bucket offsets and positions start, per the file layout.
+    kmer_index_header h;
+    memcpy(&h, image.data(), sizeof(h));
+    size_t offsets_at = sizeof(h) + (h.length + PACKED_BASES - 1) /
+        PACKED_BASES * 8 + (h.length + 63) / 64 * 8;
+    size_t buckets = (size_t) 1 << h.hash_bits;
+    size_t positions_at = offsets_at + ((buckets + 1) * 4 + 7) / 8 * 8;
+
+    string damaged = image.substr(0, image.size() - 1);
+    failures += check_rejected(filename, damaged, "its last byte cut");
+    damaged = image.substr(0, positions_at);
+    failures += check_rejected(filename, damaged, "only its offsets");
+
+    // The top byte of a 32-bit count or position; any value there is
+    // past the k-mers and bases of a small reference.
+    damaged = image;
+    damaged[offsets_at + buckets / 2 * 4 + 3] ^= (char) 0x80;
+    failures += check_rejected(filename, damaged, "an offset flipped");
+    damaged = image;
+    damaged[positions_at + h.count / 2 * 4 + 3] ^= (char) 0x80;
+    failures += check_rejected(filename, damaged, "a position flipped");
+
+    unlink(filename);
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+
+    srand(2014);
+    printf("striped kernels: %s\n", striped_isa());
+    failures += test_linear();
+    failures += test_gotoh();
+    failures += test_edit_distance();
+    failures += test_packed();
+    failures += test_kmer_bases();
+    failures += test_kmer_file();
+
+    printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}